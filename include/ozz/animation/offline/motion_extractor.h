@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_MOTION_EXTRACTOR_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_MOTION_EXTRACTOR_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Forward declare offline types.
+struct RawAnimation;
+struct RawFloat3Track;
+struct RawQuaternionTrack;
+
+// Defines the class responsible for extracting root motion from an offline
+// raw animation. Root motion is extracted from the root joint track to a
+// position and a rotation raw tracks, that can be built with TrackBuilder and
+// used at runtime by ozz::animation::RootMotionJob. This allows to compute
+// root displacement without sampling the whole animation.
+// Extracted motion can optionally be removed (baked) from the root joint of
+// the output animation, so that the animation plays in place.
+class OZZ_ANIMOFFLINE_DLL MotionExtractor {
+ public:
+  // Initializes the extractor with default parameters, which extracts
+  // horizontal position (x and z) and rotation around y (yaw).
+  MotionExtractor();
+
+  // Extracts motion from _input animation root joint track.
+  // Returns true on success and fills _position and _rotation tracks with the
+  // motion extracted. _output animation is filled with _input animation, with
+  // its root joint motion removed if baking is enabled.
+  // Returns false on failure and resets outputs to empty. Failure reasons are
+  // an invalid _input animation (see RawAnimation::Validate() for more
+  // details), root_joint being out of range, or any output being nullptr.
+  bool operator()(const RawAnimation& _input, RawFloat3Track* _position,
+                  RawQuaternionTrack* _rotation, RawAnimation* _output) const;
+
+  // Index of the joint (track) to extract motion from. Default is 0.
+  int root_joint;
+
+  // Position components to extract. Default extracts x and z components.
+  bool position_x;
+  bool position_y;
+  bool position_z;
+
+  // Extracts rotation around y axis (yaw) if true. Default is true.
+  bool rotation_y;
+
+  // Removes extracted motion from output animation root joint if true.
+  // Default is true.
+  bool bake;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_MOTION_EXTRACTOR_H_
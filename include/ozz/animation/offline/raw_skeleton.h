@@ -56,7 +56,10 @@ struct OZZ_ANIMOFFLINE_DLL RawSkeleton {
   ~RawSkeleton();
 
   // Offline skeleton joint type.
-  struct Joint {
+  struct OZZ_ANIMOFFLINE_DLL Joint {
+    // Default constructor, lod is set to 0.
+    Joint();
+
     // Type of the list of children joints.
     typedef ozz::vector<Joint> Children;
 
@@ -68,11 +71,18 @@ struct OZZ_ANIMOFFLINE_DLL RawSkeleton {
 
     // Joint rest pose transformation in local space.
     math::Transform transform;
+
+    // Level of detail (LOD) from which the joint is part of the skeleton. 0
+    // means the joint is always present, higher values are used for details
+    // (fingers, face, twist joints...) that can be dropped at coarser LODs.
+    // A joint LOD can't be lower than its parent's.
+    int lod;
   };
 
   // Tests for *this validity.
   // Returns true on success or false on failure if the number of joints exceeds
-  // ozz::Skeleton::kMaxJoints.
+  // ozz::Skeleton::kMaxJoints, or if a joint LOD is negative or lower than its
+  // parent's.
   bool Validate() const;
 
   // Returns the number of joints of *this animation.
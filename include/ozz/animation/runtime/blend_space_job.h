@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_BLEND_SPACE_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_BLEND_SPACE_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// ozz::animation::BlendSpaceJob computes the blending weights of a 1D or 2D
+// blend space, given the position of each blend space sample (usually an
+// animation clip) in the parameter space, and the current parameter value.
+// Weights are computed using gradient band interpolation (Rune Skovbo
+// Johansen, "Automated Semi-Procedural Animation for Character Locomotion"),
+// which doesn't require any triangulation and supports any number and layout
+// of samples. It provides exact weights at samples positions, and a null weight
+// for samples that don't influence the current parameter.
+// The job outputs only contributing samples (with a weight greater than the
+// threshold), so that only those need to be sampled and blended. 1D blend
+// spaces are supported by setting all y coordinates to the same value.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct OZZ_ANIMATION_DLL BlendSpaceJob {
+  // Default constructor, initializes default values.
+  BlendSpaceJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if positions range is empty.
+  // -if contributors range is smaller than positions range.
+  // -if num_contributors output is nullptr.
+  // -if threshold is negative.
+  bool Validate() const;
+
+  // Runs job's weights computation task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Blend space samples position in the parameter space. The index of each
+  // position is the one reported by the job in the contributors output.
+  span<const math::Float2> positions;
+
+  // Parameter value, the position in the blend space to compute weights for.
+  math::Float2 parameter;
+
+  // Samples whose normalized weight is less than or equal to this threshold
+  // are pruned from the contributors output, and remaining weights are
+  // renormalized. Default value is 0, which only prunes samples that have no
+  // influence at all.
+  float threshold;
+
+  // Defines a sample contributing to the blend space output.
+  struct Contributor {
+    // Index of the sample in positions range.
+    int index;
+    // Normalized weight of the sample, all contributors weights sum to 1.
+    float weight;
+  };
+
+  // Job output.
+  // Buffer of contributors, sorted by sample index. Must be at least as big as
+  // positions range, as all samples could contribute in the worst case. Only
+  // the first num_contributors elements are filled.
+  span<Contributor> contributors;
+
+  // Job output.
+  // Number of contributors written to contributors buffer, always at least 1.
+  int* num_contributors;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_BLEND_SPACE_JOB_H_
@@ -51,9 +51,18 @@ namespace animation {
 // can be specified with layers joint_weights buffer. Unspecified joint weights
 // are considered as a unit weight of 1.f, allowing to mix full and partial
 // blend operations in a single pass.
+// The job needs a per-joint weight accumulation buffer. It uses a stack
+// allocated buffer by default, which limits the number of soa joints to
+// BlendingJob::kMaxStackSoAJoints. An optional scratch buffer can be provided
+// to lift this limit and avoid the stack allocation.
 // The job does not owned any buffers (input/output) and will thus not delete
 // them during job's destruction.
 struct OZZ_ANIMATION_DLL BlendingJob {
+  // Defines the maximum number of soa joints that can be blended without a
+  // scratch buffer, aka 1024 joints. It bounds the size of the stack allocated
+  // weight accumulation buffer, independently of Skeleton::kMaxJoints.
+  enum { kMaxStackSoAJoints = 256 };
+
   // Default constructor, initializes default values.
   BlendingJob();
 
@@ -65,7 +74,12 @@ struct OZZ_ANIMATION_DLL BlendingJob {
   // -if output range is not valid.
   // -if any buffer (including layers' content : transform, joint weights...) is
   // smaller than the rest pose buffer.
+  // -if any layer soa index is out of the rest pose buffer range, or its
+  // joint weights are smaller than its soa indices.
   // -if the threshold value is less than or equal to 0.f.
+  // -if scratch buffer is specified but smaller than the rest pose buffer.
+  // -if scratch buffer isn't specified and rest pose buffer is bigger than
+  // kMaxStackSoAJoints.
   bool Validate() const;
 
   // Runs job's blending task.
@@ -105,6 +119,21 @@ struct OZZ_ANIMATION_DLL BlendingJob {
     // aren't clamped because they could exceed 1.f if all layers contains valid
     // joint weights.
     span<const math::SimdFloat4> joint_weights;
+
+    // Optional range [begin,end[ of the soa joint indices covered by this
+    // layer, aka a sparse joint mask.
+    // If empty (default case), the layer covers all joints. Otherwise only the
+    // soa joints listed in this range are blended, others being considered
+    // with a weight of 0. This allows the cost of partial blending to be
+    // proportional to the number of joints covered by the layer. Indices must
+    // be strictly increasing (so that no soa joint is blended twice), and
+    // smaller than the rest pose buffer size. In this case joint_weights
+    // range is compact: it's either empty (unit weight for all covered
+    // joints), or at least as big as soa_indices range, joint_weights[i]
+    // being the weight of soa joint soa_indices[i].
+    // See ozz::animation::ComputeSubtreeMask() to build the mask of a
+    // skeleton subtree.
+    span<const uint16_t> soa_indices;
   };
 
   // The job blends the rest pose to the output when the accumulated weight of
@@ -125,6 +154,8 @@ struct OZZ_ANIMATION_DLL BlendingJob {
   // by the skeleton that all the animations belongs to.
   // It is used when the accumulated weight for a bone on all layers is
   // less than the threshold value, in order to fall back on valid transforms.
+  // Blending a skeleton LOD is achieved by restricting this range to the LOD
+  // soa joints (see Skeleton::lod_num_joints()).
   span<const ozz::math::SoaTransform> rest_pose;
 
   // Job output.
@@ -133,6 +164,68 @@ struct OZZ_ANIMATION_DLL BlendingJob {
   // Must be at least as big as the rest pose buffer, but only the number of
   // transforms defined by the rest pose buffer size will be processed.
   span<ozz::math::SoaTransform> output;
+
+  // Optional scratch buffer used by the job to accumulate per-joint weights.
+  // If empty (default case), the job uses a stack allocated buffer, limiting
+  // the number of soa joints to kMaxStackSoAJoints. Otherwise it must be at
+  // least as big as the rest pose buffer, without any limitation on the number
+  // of joints. Its content is undefined after the job has run, so it can be
+  // reused across jobs.
+  span<math::SimdFloat4> scratch;
+};
+
+// ozz::animation::BatchBlendingJob is a convenience wrapper that blends the
+// layers of multiple instances (usually characters of a crowd) sharing the
+// same rest pose and layers structure, in a single call. It's equivalent to
+// running a BlendingJob per instance: instances are blended one after the
+// other, and computations aren't vectorized across instances. Only validation
+// and setup are done once for the whole batch, which saves a few nanoseconds
+// per instance for the smallest skeletons.
+// Each instance has the same number of layers and additive layers, stored
+// contiguously in instance order in layers and additive_layers ranges.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct OZZ_ANIMATION_DLL BatchBlendingJob {
+  // Default constructor, initializes default values.
+  BatchBlendingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if outputs range is empty.
+  // -if layers or additive_layers size isn't a multiple of the number of
+  // instances.
+  // -if any layer, output, or scratch buffer is invalid, see
+  // BlendingJob::Validate() for more details.
+  bool Validate() const;
+
+  // Runs job's blending task for all instances.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // See BlendingJob::threshold.
+  float threshold;
+
+  // Layers of all instances, instance after instance. The number of layers per
+  // instance is layers.size() / outputs.size().
+  span<const BlendingJob::Layer> layers;
+
+  // Additive layers of all instances, instance after instance. The number of
+  // additive layers per instance is additive_layers.size() / outputs.size().
+  span<const BlendingJob::Layer> additive_layers;
+
+  // The skeleton rest pose, shared by all instances. See
+  // BlendingJob::rest_pose.
+  span<const ozz::math::SoaTransform> rest_pose;
+
+  // Job output, one output range per instance. Its size defines the number of
+  // instances.
+  span<const span<ozz::math::SoaTransform>> outputs;
+
+  // Optional scratch buffer, reused for all instances. See
+  // BlendingJob::scratch.
+  span<math::SimdFloat4> scratch;
 };
 }  // namespace animation
 }  // namespace ozz
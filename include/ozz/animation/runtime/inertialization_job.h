@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares inertialization internal data.
+namespace internal {
+struct InertializationSoaOffset;
+}  // namespace internal
+
+// ozz::animation::InertializationJob implements inertialization, an alternative
+// to crossfade blending for animation transitions (see David Bollo,
+// "Inertialization: High-Performance Animation Transitions in Gears of War").
+// Instead of sampling and blending source and destination animations during
+// the whole transition, the offset between source and destination poses is
+// captured at transition time (with InertializationCaptureJob), and decayed to
+// zero over time on top of the destination pose. Only the destination
+// animation needs to be sampled during the transition.
+// Offsets decay using a quintic polynomial that preserves source pose velocity
+// at transition time, and reaches zero with null velocity and acceleration.
+// Translation, rotation and scale offsets are decayed independently, for each
+// joint, along the direction of the offset.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct OZZ_ANIMATION_DLL InertializationJob {
+  // Default constructor, initializes default values.
+  InertializationJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if context is nullptr.
+  // -if input range is empty or bigger than the number of soa joints captured
+  // by the context.
+  // -if output range is smaller than input range.
+  bool Validate() const;
+
+  // Runs job's offset decay task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed since the transition was captured, in seconds.
+  float time;
+
+  // Inertialization context, filled by InertializationCaptureJob at transition
+  // time.
+  class Context;
+  const Context* context;
+
+  // Destination pose, local space transforms usually outputted from a sampling
+  // job. Its size defines the number of soa joints to process.
+  span<const math::SoaTransform> input;
+
+  // Job output, input pose with the decayed offset applied. Must be at least as
+  // big as the input range. Output can be the same buffer as input.
+  span<math::SoaTransform> output;
+};
+
+// ozz::animation::InertializationCaptureJob captures the offset between source
+// and destination poses at transition time, along with source pose velocity.
+// Result is stored in the context, used by InertializationJob for the whole
+// transition duration.
+struct OZZ_ANIMATION_DLL InertializationCaptureJob {
+  // Default constructor, initializes default values.
+  InertializationCaptureJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if context is nullptr or can't handle current pose size.
+  // -if current range is empty.
+  // -if previous or target range is smaller than current range.
+  // -if delta_time or duration is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's capture task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Source pose on the update preceding the transition, used to compute source
+  // pose velocity.
+  span<const math::SoaTransform> previous;
+
+  // Source pose at transition time. Its size defines the number of soa joints
+  // to capture.
+  span<const math::SoaTransform> current;
+
+  // Destination pose at transition time.
+  span<const math::SoaTransform> target;
+
+  // Time elapsed between previous and current poses, in seconds.
+  float delta_time;
+
+  // Maximum transition duration, in seconds. Offset can reach zero sooner
+  // depending on source pose velocity.
+  float duration;
+
+  // Job output.
+  InertializationJob::Context* context;
+};
+
+// Declares the context object used to store inertialization offsets, captured
+// by InertializationCaptureJob and decayed by InertializationJob.
+class OZZ_ANIMATION_DLL InertializationJob::Context {
+ public:
+  // Constructs an empty context. The context needs to be resized with the
+  // appropriate number of joints before it can be used.
+  Context();
+
+  // Constructs a context that can be used for skeletons with at most
+  // _max_joints joints.
+  explicit Context(int _max_joints);
+
+  // Disables copy and assignation.
+  Context(Context const&) = delete;
+  Context& operator=(Context const&) = delete;
+
+  // Deallocates context.
+  ~Context();
+
+  // Resize the number of joints that the context can support.
+  // This also implicitly invalidate the context.
+  void Resize(int _max_joints);
+
+  // Invalidate the context, which then needs to be captured again.
+  void Invalidate();
+
+  // The maximum number of joints that the context can handle.
+  int max_joints() const { return max_soa_joints_ * 4; }
+  int max_soa_joints() const { return max_soa_joints_; }
+
+  // Number of soa joints captured, 0 if context is invalid.
+  int num_soa_joints() const { return num_soa_joints_; }
+
+ private:
+  friend struct InertializationJob;
+  friend struct InertializationCaptureJob;
+
+  // The number of soa joints that can store this context.
+  int max_soa_joints_;
+
+  // The number of soa joints captured.
+  int num_soa_joints_;
+
+  // Soa offsets and decay coefficients.
+  internal::InertializationSoaOffset* offsets_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
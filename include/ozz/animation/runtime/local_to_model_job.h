@@ -39,8 +39,11 @@ namespace math {
 struct SoaTransform;
 }
 namespace math {
+struct Float3x4;
 struct Float4x4;
-}
+struct SimdDualQuaternion;
+struct SoaFloat4x4;
+}  // namespace math
 
 namespace animation {
 
@@ -56,7 +59,23 @@ class Skeleton;
 // ordered like skeleton's joints. Output are matrices, because the combination
 // of affine transformations can contain shearing or complex transformation
 // that cannot be represented as Transform object.
+// Model-space matrices can alternatively be outputted in SoA format (see
+// soa_output), which avoids converting to and from AoS format when consumers
+// process SoA data, as compact 3x4 affine matrices (see affine_output), or as
+// dual quaternions (see dual_quaternion_output).
+// When the skeleton has multiple LODs, updating part of the hierarchy (see
+// "from" and subtrees) requires a per-joint bitset to filter out joints that
+// don't belong to the updated hierarchy. It uses a stack allocated buffer by
+// default, which limits the number of joints of such skeletons to
+// LocalToModelJob::kMaxStackJoints. An optional scratch buffer can be provided
+// to lift this limit.
 struct OZZ_ANIMATION_DLL LocalToModelJob {
+  // Defines the maximum number of joints of a multiple LODs skeleton whose
+  // hierarchy can be partially updated without a scratch buffer. It bounds the
+  // size of the stack allocated bitset to 128 bytes, independently of
+  // Skeleton::kMaxJoints.
+  enum { kMaxStackJoints = 1024 };
+
   // Default constructor, initializes default values.
   LocalToModelJob();
 
@@ -66,6 +85,27 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
   // Note that this input has a SoA format.
   // -if the size of of the output is smaller than the skeleton's number of
   // joints.
+  // -if the size of the soa output is smaller than the skeleton's number of
+  // soa joints.
+  // -if the size of the affine output is smaller than the skeleton's number of
+  // joints.
+  // -if the size of the dual quaternion output is smaller than the skeleton's
+  // number of joints.
+  // -if more than one output range (output, soa_output, affine_output or
+  // dual_quaternion_output) is specified.
+  // -if dirty mask isn't empty but smaller than the skeleton's number of
+  // joints (in bits).
+  // -if subtrees aren't sorted in strictly increasing order, or contain an
+  // invalid joint index, or are used with "from" or "from_excluded".
+  // -if joint_remaps isn't sorted, or references invalid joints.
+  // -if inverse_bind_poses or skinning_matrices are smaller than joint_remaps.
+  // -if joint_remaps is used without output or dual_quaternion_output.
+  // -if inverse_bind_dual_quaternions or skinning_dual_quaternions are smaller
+  // than joint_remaps, when used with dual_quaternion_output.
+  // -if scratch buffer is specified but smaller than the skeleton's number of
+  // joints (in bits).
+  // -if scratch buffer isn't specified, while a part of the hierarchy of a
+  // multiple LODs skeleton bigger than kMaxStackJoints is updated.
   bool Validate() const;
 
   // Runs job's local-to-model task.
@@ -90,14 +130,16 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
   // updated. This parameter can be used to optimize update by limiting
   // conversion to part of the joint hierarchy. Note that "from" parent should
   // be a valid matrix, as it is going to be used as part of "from" joint
-  // hierarchy update.
+  // hierarchy update. Only "from" descendants are updated, even if the skeleton
+  // has multiple LODs and "from" hierarchy isn't a contiguous range of joints.
   int from;
 
   // Defines "to" which joint the local-to-model conversion should go, "to"
   // included. Update will end before "to" joint is reached if "to" is not part
   // of the hierarchy starting from "from". Default value is
   // ozz::animation::Skeleton::kMaxJoints, meaning the hierarchy (starting from
-  // "from") is updated to the last joint.
+  // "from") is updated to the last joint. A skeleton LOD is updated by setting
+  // "to" to the LOD last joint (see Skeleton::lod_num_joints()).
   int to;
 
   // If true, "from" joint is not updated during job execution. Update starts
@@ -108,6 +150,58 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
   // Default value is false.
   bool from_excluded;
 
+  // Optional list of subtree roots, used instead of "from" to update multiple
+  // parts of the hierarchy in a single call, for example after legs and arms
+  // IK. The union of the subtrees (up to "to") is updated in a single ordered
+  // pass, where subtrees included in a previous one are skipped. Like "from",
+  // the parent of every subtree root should be a valid matrix, and only
+  // subtrees descendants are updated.
+  // Subtree roots must be sorted in strictly increasing order. "from" and
+  // "from_excluded" must keep their default values.
+  // If empty (default), "from" hierarchy is updated.
+  span<const int> subtrees;
+
+  // Optional dirty joints mask, allowing to update an arbitrary set of joints.
+  // It's a bitset, where bit (i & 7) of byte (i / 8) flags joint i as dirty.
+  // Only dirty joints and their descendants are updated (in the range
+  // specified by "from" and "to"), other joints output matrices are preserved.
+  // Dirty flags are propagated to descendants during job execution, so that
+  // the mask flags all updated joints after execution.
+  // If empty (default), all joints are updated.
+  span<uint8_t> dirty;
+
+  // Optional skinning matrices palette output. If joint_remaps isn't empty,
+  // skinning_matrices[i] is set to the model-space matrix of joint
+  // joint_remaps[i], multiplied by inverse_bind_poses[i], as soon as this
+  // model-space matrix is computed. This avoids a separate pass over
+  // model-space matrices. Only remapped joints that are updated by the job
+  // (see "from", "to" and "dirty") are written.
+  // joint_remaps must be sorted in strictly increasing order, which is the
+  // case of remapping tables built by mesh importers.
+  // This is the preferred remapping API when a skinning palette is needed
+  // anyway, like for GPU skinning. For CPU skinning, prefer
+  // ozz::geometry::SkinningJob::joint_remaps, which computes skinning matrices
+  // from model-space matrices without storing a separate palette.
+  // This is only supported with (Float4x4) output or dual_quaternion_output.
+  span<const uint16_t> joint_remaps;
+  span<const ozz::math::Float4x4> inverse_bind_poses;
+  span<ozz::math::Float4x4> skinning_matrices;
+
+  // Dual quaternion skinning palette, used instead of inverse_bind_poses and
+  // skinning_matrices with dual_quaternion_output. Inverse bind poses must be
+  // rigid.
+  span<const ozz::math::SimdDualQuaternion> inverse_bind_dual_quaternions;
+  span<ozz::math::SimdDualQuaternion> skinning_dual_quaternions;
+
+  // Optional scratch buffer, used by the job as a bitset of updated joints
+  // when a part of the hierarchy of a multiple LODs skeleton is updated. If
+  // empty (default case), the job uses a stack allocated buffer, limiting the
+  // number of joints of such skeletons to kMaxStackJoints. Otherwise it must be
+  // at least (num_joints + 7) / 8 bytes, without any limitation on the number
+  // of joints. Its content is undefined after the job has run, so it can be
+  // reused across jobs.
+  span<uint8_t> scratch;
+
   // The input range that store local transforms.
   span<const ozz::math::SoaTransform> input;
 
@@ -115,6 +209,26 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
 
   // The output range to be filled with model-space matrices.
   span<ozz::math::Float4x4> output;
+
+  // The output range to be filled with model-space matrices in SoA format,
+  // 4 joints per SoaFloat4x4. It can be used instead of output range. Matrices
+  // of joints that aren't updated (see "from" and "to") are preserved, even
+  // when they share the same soa entry with updated joints.
+  span<ozz::math::SoaFloat4x4> soa_output;
+
+  // The output range to be filled with model-space 3x4 affine matrices. It can
+  // be used instead of output range. As the last row of model-space matrices
+  // is always (0, 0, 0, 1), it isn't stored, saving 25% of the memory (and
+  // bandwidth) used by Float4x4 matrices.
+  span<ozz::math::Float3x4> affine_output;
+
+  // The output range to be filled with model-space dual quaternions. It can be
+  // used instead of output range, for dual quaternion skinning. Local
+  // rotations and translations are concatenated as dual quaternions, so no
+  // matrix decomposition is needed. Dual quaternions can only represent rigid
+  // transformations: joints scale is ignored, and the root matrix must be
+  // rigid.
+  span<ozz::math::SimdDualQuaternion> dual_quaternion_output;
 };
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,163 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_GRAPH_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_GRAPH_H_
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+struct Float4x4;
+}  // namespace math
+
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+
+// ozz::animation::PoseGraph evaluates a graph of sampling and blending nodes,
+// wiring SamplingJob, BlendingJob and LocalToModelJob together.
+// The graph is built once by adding nodes, then compiled. Compilation computes
+// nodes execution order (depth-first from the output node, so that a node
+// executes right after its inputs), and pose buffers liveness. Pose buffers
+// are reused as soon as the node that produced them has been consumed by all
+// its dependents, minimizing the number of live pose buffers. All memory is
+// allocated during compilation, evaluation doesn't allocate.
+// Nodes inputs must be added before the node itself, which guarantees the graph
+// is acyclic.
+class OZZ_ANIMATION_DLL PoseGraph {
+ public:
+  // Constructs an empty graph.
+  PoseGraph();
+
+  // Disables copy and assignation.
+  PoseGraph(PoseGraph const&) = delete;
+  PoseGraph& operator=(PoseGraph const&) = delete;
+
+  // Deallocates graph nodes and buffers.
+  ~PoseGraph();
+
+  // Adds a node that samples _animation. Sampling ratio is set with
+  // SetRatio().
+  // Returns the new node index, or -1 if graph is already compiled.
+  int AddSamplingNode(const Animation& _animation);
+
+  // Adds a node that blends _inputs nodes, then applies _additive_inputs nodes
+  // (see BlendingJob layers and additive_layers). Weights are set with
+  // SetWeight(). _inputs and _additive_inputs can't be both empty.
+  // Returns the new node index, or -1 if graph is already compiled or if any
+  // input isn't a previously added node.
+  int AddBlendingNode(const span<const int>& _inputs,
+                      const span<const int>& _additive_inputs);
+
+  // Compiles the graph for _skeleton, to evaluate _output node.
+  // Nodes that _output doesn't depend on are not evaluated.
+  // Returns false if _output isn't a valid node, or if any sampled animation
+  // doesn't match skeleton number of joints.
+  bool Compile(const Skeleton& _skeleton, int _output);
+
+  // Sets sampling node _node ratio.
+  // Returns false if _node isn't a sampling node.
+  bool SetRatio(int _node, float _ratio);
+
+  // Sets the weight of blending node _node _input. _input indexes node inputs,
+  // then additive inputs.
+  // Returns false if _node isn't a blending node or _input is out of range.
+  bool SetWeight(int _node, int _input, float _weight);
+
+  // Sets optional per-joint weights of blending node _node _input, see
+  // BlendingJob::Layer::joint_weights.
+  // Returns false if _node isn't a blending node or _input is out of range.
+  bool SetJointWeights(int _node, int _input,
+                       const span<const math::SimdFloat4>& _joint_weights);
+
+  // Evaluates the compiled graph. Output node local space pose is written to
+  // _locals if not empty, and model space matrices to _models if not empty.
+  // Returns false if graph isn't compiled, if output buffers are too small, or
+  // if any job fails.
+  bool Evaluate(const span<math::SoaTransform>& _locals,
+                const span<math::Float4x4>& _models);
+
+  // Returns true if graph is compiled.
+  bool compiled() const { return skeleton_ != nullptr; }
+
+  // Returns the number of nodes.
+  int num_nodes() const { return static_cast<int>(nodes_.size()); }
+
+  // Returns the number of pose buffers allocated by compilation.
+  int num_buffers() const { return num_buffers_; }
+
+ private:
+  // Node internal description.
+  struct Node {
+    // Sampling node parameters, animation is nullptr for blending nodes.
+    const Animation* animation;
+    SamplingJob::Context* context;
+    float ratio;
+
+    // Blending node parameters. Inputs are followed by additive inputs.
+    ozz::vector<int> inputs;
+    int num_blend_inputs;
+    ozz::vector<BlendingJob::Layer> layers;
+
+    // Pose buffer assigned by compilation, -1 if node isn't evaluated.
+    int buffer;
+  };
+
+  // Returns the node at index _node if it's a blending node, nullptr
+  // otherwise.
+  Node* GetBlendingNode(int _node);
+
+  // Compiled skeleton, nullptr if graph isn't compiled.
+  const Skeleton* skeleton_;
+
+  // All graph nodes.
+  ozz::vector<Node> nodes_;
+
+  // Compiled execution order.
+  ozz::vector<int> order_;
+
+  // Compiled output node.
+  int output_;
+
+  // Pose buffers pool, num_buffers_ buffers of num_soa_joints each.
+  int num_buffers_;
+  ozz::vector<math::SoaTransform> buffers_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_GRAPH_H_
@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct Transform;
+}
+
+namespace animation {
+
+// Forward declares the root motion tracks.
+class Float3Track;
+class QuaternionTrack;
+
+// Computes root motion displacement between two time ratios of an animation,
+// from its dedicated root motion tracks (see
+// ozz::animation::offline::MotionExtractor to extract them from a
+// RawAnimation).
+// As opposed to sampling the full animation pose twice and comparing root
+// joint transforms, this job only reads root motion tracks. It also handles
+// loops: ratios aren't clamped to the unit interval [0,1] but their integer
+// part is interpreted as a number of animation cycles. The per-cycle
+// displacement (aka from the beginning to the end of the animation) is
+// accumulated for every loop crossed between "from" and "to" ratios.
+// The output delta is expressed in "from" root space, meaning it can be
+// directly concatenated to the character's transform: world * delta.
+// The job does not owned the tracks and will thus not delete them during
+// job's destruction.
+struct OZZ_ANIMATION_DLL RootMotionJob {
+  // Default constructor, initializes default values.
+  RootMotionJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if both position and rotation tracks are nullptr.
+  // -if output pointer is nullptr.
+  bool Validate() const;
+
+  // Runs job's root motion extraction task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Time ratios of the previous and the current update. 0 is the beginning of
+  // the animation, 1 is the end. Integer part of the ratio is the number of
+  // animation cycles, so 1.2 is 20% of the second loop. "to" can be lower than
+  // "from" when animation is played backward.
+  float from;
+  float to;
+
+  // If false, ratios are clamped to the unit interval [0,1] before job
+  // execution, meaning no loop is accumulated.
+  // Default is true.
+  bool loop;
+
+  // Optional root motion position track. Position is considered constant if
+  // nullptr.
+  const Float3Track* position;
+
+  // Optional root motion rotation track. Rotation is considered constant if
+  // nullptr.
+  const QuaternionTrack* rotation;
+
+  // Job output.
+
+  // Root motion delta transform from "from" to "to" ratios, expressed in "from"
+  // root space. Scale component is always set to one.
+  math::Transform* delta;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
@@ -89,7 +89,8 @@ struct OZZ_ANIMATION_DLL SamplingJob {
   // If there are less joints in the animation compared to the output range,
   // then remaining SoaTransform are left unchanged.
   // If there are more joints in the animation, then the last joints are not
-  // sampled.
+  // sampled, nor decompressed. This allows to sample a skeleton LOD, by
+  // restricting output to the LOD soa joints (see Skeleton::lod_num_joints()).
   span<ozz::math::SoaTransform> output;
 };
 
@@ -48,6 +48,11 @@ namespace offline {
 class SkeletonBuilder;
 }
 
+// Computes the hash of a joint name, as stored in Skeleton::joint_name_hashes().
+// This is a 32 bits FNV-1a hash. Tools can use it to precompute joint name
+// hashes, see FindJoint().
+OZZ_ANIMATION_DLL uint32_t HashJointName(const char* _name);
+
 // This runtime skeleton data structure provides a const-only access to joint
 // hierarchy, joint names and rest-pose. This structure is filled by the
 // SkeletonBuilder and can be serialize/deserialized.
@@ -58,6 +63,10 @@ class SkeletonBuilder;
 // order. This is enough to traverse the whole joint hierarchy. See
 // IterateJointsDF() from skeleton_utils.h that implements a depth-first
 // traversal utility.
+// Skeletons can define levels of detail (LOD), see RawSkeleton::Joint::lod.
+// Joints are then sorted by LOD first, and depth-first within a LOD, so that
+// every LOD is a prefix of the joint arrays. Parents are always stored before
+// their children.
 class OZZ_ANIMATION_DLL Skeleton {
  public:
   // Defines Skeleton constant values.
@@ -65,10 +74,14 @@ class OZZ_ANIMATION_DLL Skeleton {
 
     // Defines the maximum number of joints.
     // This is limited in order to control the number of bits required to store
-    // a joint index. Limiting the number of joints also helps handling worst
-    // size cases, like when it is required to allocate an array of joints on
-    // the stack.
-    kMaxJoints = 1024,
+    // a joint index. 8192 is the number of tracks that can be addressed by the
+    // 13 bits track index of animation rotation keys, so that raising the
+    // limit doesn't increase keys size. Runtime jobs stack buffers don't
+    // depend on this limit: per-joint buffers are bounded (see
+    // BlendingJob::kMaxStackSoAJoints, LocalToModelJob::kMaxStackJoints and
+    // SkinningJob::kMaxStackRemappedJoints), above which caller scratch
+    // buffers must be provided.
+    kMaxJoints = 8192,
 
     // Defines the maximum number of SoA elements required to store the maximum
     // number of joints.
@@ -113,6 +126,48 @@ class OZZ_ANIMATION_DLL Skeleton {
     return span<const char* const>(joint_names_.begin(), joint_names_.end());
   }
 
+  // Returns joint's depth in the hierarchy, 0 being the depth of root joints.
+  span<const int16_t> joint_depths() const { return joint_depths_; }
+
+  // Returns the end of every joint subtree, aka the index following its last
+  // descendant. As joints are stored in depth-first order, the subtree of
+  // joint i (i included) is the contiguous range [i, joint_subtree_ends()[i]).
+  // If the skeleton has more than one LOD, this range can also contain joints
+  // that aren't descendants of i, from other subtrees of higher LODs.
+  span<const int16_t> joint_subtree_ends() const { return joint_subtree_ends_; }
+
+  // Returns the first child of every joint, or kNoParent if joint is a leaf.
+  span<const int16_t> joint_first_children() const {
+    return joint_first_children_;
+  }
+
+  // Returns the next sibling of every joint, or kNoParent if joint is its
+  // parent last child. Roots are siblings of each other.
+  span<const int16_t> joint_next_siblings() const {
+    return joint_next_siblings_;
+  }
+
+  // Returns the hash of every joint name, see HashJointName().
+  span<const uint32_t> joint_name_hashes() const { return joint_name_hashes_; }
+
+  // Returns the number of levels of detail (LOD) of the skeleton. It's 1 for
+  // skeletons that don't define LODs, and 0 for empty skeletons.
+  int num_lods() const { return static_cast<int>(lod_num_joints_.size()); }
+
+  // Returns the number of joints of every LOD. LOD i is made of the joints in
+  // range [0, lod_num_joints()[i]), with the last LOD containing all joints.
+  // Runtime jobs can process a LOD by restricting their ranges to its joints
+  // (and soa joints), see SamplingJob::output, BlendingJob::rest_pose and
+  // LocalToModelJob::to.
+  span<const int16_t> lod_num_joints() const { return lod_num_joints_; }
+
+  // Returns joint names hash table, used to find joints by name in constant
+  // time (see FindJoint()). It's an open addressing (linear probing) table of
+  // joint indices, indexed by joint name hash modulo the table size. Table
+  // size is a power of 2, at least twice the number of joints. Empty slots are
+  // set to kNoParent.
+  span<const int16_t> joint_name_table() const { return joint_name_table_; }
+
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
   void Save(ozz::io::OArchive& _archive) const;
@@ -121,9 +176,19 @@ class OZZ_ANIMATION_DLL Skeleton {
  private:
   // Internal allocation/deallocation function.
   // Allocate returns the beginning of the contiguous buffer of names.
-  char* Allocate(size_t _char_count, size_t _num_joints);
+  char* Allocate(size_t _char_count, size_t _num_joints, size_t _num_lods);
   void Deallocate();
 
+  // Computes hierarchy metadata (joint depths, subtree ends, first children and
+  // next siblings) from joint parents. This is used by the SkeletonBuilder,
+  // and when loading archives that don't store it.
+  void BuildHierarchy();
+
+  // Computes joint name hashes and the joint names hash table from joint
+  // names. This is used by the SkeletonBuilder, and when loading archives
+  // that don't store them.
+  void BuildNameTable();
+
   // SkeletonBuilder class is allowed to instantiate an Skeleton.
   friend class offline::SkeletonBuilder;
 
@@ -138,11 +203,30 @@ class OZZ_ANIMATION_DLL Skeleton {
 
   // Stores the name of every joint in an array of c-strings.
   span<char*> joint_names_;
+
+  // Array of joint name hashes.
+  span<uint32_t> joint_name_hashes_;
+
+  // Joint names hash table, which size isn't the number of joints.
+  span<int16_t> joint_name_table_;
+
+  // Array of joint depths.
+  span<int16_t> joint_depths_;
+
+  // Array of joint subtree ends.
+  span<int16_t> joint_subtree_ends_;
+
+  // Arrays of joint first child and next sibling indices.
+  span<int16_t> joint_first_children_;
+  span<int16_t> joint_next_siblings_;
+
+  // Number of joints of every LOD, which size isn't the number of joints.
+  span<int16_t> lod_num_joints_;
 };
 }  // namespace animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(2, animation::Skeleton)
+OZZ_IO_TYPE_VERSION(3, animation::Skeleton)
 OZZ_IO_TYPE_TAG("ozz-skeleton", animation::Skeleton)
 }  // namespace io
 }  // namespace ozz
@@ -32,7 +32,9 @@
 
 #include "ozz/animation/runtime/export.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/transform.h"
+#include "ozz/base/span.h"
 
 namespace ozz {
 namespace animation {
@@ -42,45 +44,123 @@ OZZ_ANIMATION_DLL ozz::math::Transform GetJointLocalRestPose(
     const Skeleton& _skeleton, int _joint);
 
 // Test if a joint is a leaf. _joint number must be in range [0, num joints].
-// "_joint" is a leaf if it's the last joint, or next joint's parent isn't
-// "_joint".
+// "_joint" is a leaf if its subtree only contains itself.
 inline bool IsLeaf(const Skeleton& _skeleton, int _joint) {
-  const int num_joints = _skeleton.num_joints();
-  assert(_joint >= 0 && _joint < num_joints && "_joint index out of range");
+  assert(_joint >= 0 && _joint < _skeleton.num_joints() &&
+         "_joint index out of range");
+  return _skeleton.joint_subtree_ends()[_joint] == _joint + 1;
+}
+
+// Tests if _joint is part of _root subtree (_root included). Both indices must
+// be in range [0, num joints]. As parents are stored before their children,
+// this walks _joint ancestors until reaching _root or a lower index, so its
+// cost is O(depth) rather than constant.
+inline bool IsInSubtree(const Skeleton& _skeleton, int _root, int _joint) {
+  assert(_root >= 0 && _root < _skeleton.num_joints() &&
+         "_root index out of range");
+  assert(_joint >= 0 && _joint < _skeleton.num_joints() &&
+         "_joint index out of range");
   const span<const int16_t>& parents = _skeleton.joint_parents();
-  const int next = _joint + 1;
-  return next == num_joints || parents[next] != _joint;
+  for (; _joint > _root; _joint = parents[_joint]) {
+  }
+  return _joint == _root;
 }
 
 // Finds joint index by name. Uses a case sensitive comparison.
+// Lookup is done in constant time, using skeleton joint names hash table.
+// Returns the first joint with this name, or -1 if none is found.
 OZZ_ANIMATION_DLL int FindJoint(const Skeleton& _skeleton, const char* _name);
 
-// Applies a specified functor to each joint in a depth-first order.
+// Finds joint index by name, where _hash is _name precomputed hash (see
+// HashJointName()). This avoids hashing _name when looking up the same names
+// repeatedly.
+OZZ_ANIMATION_DLL int FindJoint(const Skeleton& _skeleton, const char* _name,
+                                uint32_t _hash);
+
+// Applies a specified functor to each joint in depth-first order, where
+// parents are always visited before their children, and siblings in increasing
+// index order.
 // _Fct is of type void(int _current, int _parent) where the first argument
 // is the child of the second argument. _parent is kNoParent if the _current
 // joint is a root. _from indicates the joint from which the joint hierarchy
 // traversal begins. Use Skeleton::kNoParent to traverse the whole
 // hierarchy, in case there are multiple roots.
+// If the skeleton has a single LOD, depth-first order is skeleton order, so
+// _from subtree is the contiguous range [_from, subtree end). Otherwise the
+// hierarchy is walked through joint_first_children() and joint_next_siblings()
+// links. In both cases, traversal cost is proportional to the number of
+// joints visited.
 template <typename _Fct>
 inline _Fct IterateJointsDF(const Skeleton& _skeleton, _Fct _fct,
                             int _from = Skeleton::kNoParent) {
   const span<const int16_t>& parents = _skeleton.joint_parents();
   const int num_joints = _skeleton.num_joints();
-  //
-  // parents[i] >= _from is true as long as "i" is a child of "_from".
+  if (num_joints == 0 || _from >= num_joints) {
+    return _fct;
+  }
+
   static_assert(Skeleton::kNoParent < 0,
                 "Algorithm relies on kNoParent being negative");
-  for (int i = _from < 0 ? 0 : _from, process = i < num_joints; process;
-       ++i, process = i < num_joints && parents[i] >= _from) {
-    _fct(i, parents[i]);
+  if (_skeleton.num_lods() <= 1) {
+    const int begin = _from < 0 ? 0 : _from;
+    const int end =
+        _from < 0 ? num_joints : _skeleton.joint_subtree_ends()[_from];
+    for (int i = begin; i < end; ++i) {
+      _fct(i, parents[i]);
+    }
+    return _fct;
+  }
+
+  // Joint 0 is always the first root.
+  const span<const int16_t>& first_children = _skeleton.joint_first_children();
+  const span<const int16_t>& next_siblings = _skeleton.joint_next_siblings();
+  for (int joint = _from < 0 ? 0 : _from;;) {
+    _fct(joint, parents[joint]);
+    if (first_children[joint] != Skeleton::kNoParent) {
+      joint = first_children[joint];
+      continue;
+    }
+    // Climbs up to the first ancestor (joint included) that has a next
+    // sibling, without leaving _from subtree.
+    for (;;) {
+      if (joint == _from) {
+        return _fct;
+      }
+      if (next_siblings[joint] != Skeleton::kNoParent) {
+        joint = next_siblings[joint];
+        break;
+      }
+      joint = parents[joint];
+      if (joint == Skeleton::kNoParent) {
+        return _fct;  // Last root is done.
+      }
+    }
   }
-  return _fct;
 }
 
-// Applies a specified functor to each joint in a reverse (from leaves to root)
-// depth-first order. _Fct is of type void(int _current, int _parent) where the
-// first argument is the child of the second argument. _parent is kNoParent if
-// the _current joint is a root.
+// Computes the sparse joint mask of the subtree starting at _root joint
+// (included), to be used as BlendingJob::Layer soa_indices and joint_weights.
+// Subtree joints are assigned _weight, while other joints sharing the same soa
+// entries are assigned 0. As joints are stored in depth-first order, the
+// subtree covers a contiguous range of soa entries (which can also contain
+// joints of other subtrees if the skeleton has multiple LODs).
+// _soa_indices and _joint_weights must be big enough to store all soa entries
+// covered by the subtree, which is at most num_soa_joints(). Cost is
+// proportional to the number of soa entries written, subtree joints being
+// visited with IterateJointsDF().
+// Returns the number of soa entries written, or 0 if _root is out of range or
+// output buffers are too small.
+OZZ_ANIMATION_DLL size_t ComputeSubtreeMask(
+    const Skeleton& _skeleton, int _root, float _weight,
+    const span<uint16_t>& _soa_indices,
+    const span<math::SimdFloat4>& _joint_weights);
+
+// Applies a specified functor to each joint in reverse skeleton order, where
+// children are always visited before their parents. This is a reverse
+// depth-first order if the skeleton has a single LOD, otherwise joints are
+// depth-first within each LOD. _Fct is of type void(int _current, int _parent)
+// where the first argument is the child of the second argument. _parent is
+// kNoParent if the _current joint is a root.
 template <typename _Fct>
 inline _Fct IterateJointsDFReverse(const Skeleton& _skeleton, _Fct _fct) {
   const span<const int16_t>& parents = _skeleton.joint_parents();
@@ -0,0 +1,125 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#ifndef OZZ_OZZ_BASE_MATHS_FLOAT3X4_H_
+#define OZZ_OZZ_BASE_MATHS_FLOAT3X4_H_
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+
+// Declare the 3x4 affine matrix type. It stores the 3 first rows of an affine
+// Float4x4, the last row being implicitly (0, 0, 0, 1). Rows are stored
+// contiguously, which makes this 48 bytes type suitable for skinning palettes
+// and gpu buffers:
+// [ m.rows[0].x m.rows[0].y m.rows[0].z m.rows[0].w ]   {v.x}
+// | m.rows[1].x m.rows[1].y m.rows[1].z m.rows[1].w | * {v.y}
+// | m.rows[2].x m.rows[2].y m.rows[2].z m.rows[2].w |   {v.z}
+// [ 0           0           0           1           ]   {v.1}
+struct Float3x4 {
+  // Matrix rows.
+  SimdFloat4 rows[3];
+
+  // Returns the identity matrix.
+  static OZZ_INLINE Float3x4 identity() {
+    const Float3x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                           simd_float4::z_axis()}};
+    return ret;
+  }
+
+  // Returns the 3x4 matrix built from the 3 first rows of the affine matrix
+  // _m. The last row of _m is ignored.
+  static OZZ_INLINE Float3x4 FromFloat4x4(const Float4x4& _m) {
+    SimdFloat4 rows[4];
+    Transpose4x4(_m.cols, rows);
+    const Float3x4 ret = {{rows[0], rows[1], rows[2]}};
+    return ret;
+  }
+};
+
+// Returns the 4x4 matrix equivalent to the affine matrix _m.
+OZZ_INLINE Float4x4 ToFloat4x4(const Float3x4& _m) {
+  Float4x4 ret;
+  Transpose3x4(_m.rows, ret.cols);
+  ret.cols[3] = SetW(ret.cols[3], simd_float4::one());
+  return ret;
+}
+
+// Multiply each row of matrix _m with vector _v. When _v is a splatted value,
+// this scales every matrix element, like ColumnMultiply for Float4x4.
+OZZ_INLINE Float3x4 ColumnMultiply(const Float3x4& _m, _SimdFloat4 _v) {
+  const Float3x4 ret = {
+      {_m.rows[0] * _v, _m.rows[1] * _v, _m.rows[2] * _v}};
+  return ret;
+}
+
+// Computes the transformation of a Float3x4 matrix and a point _p.
+// _p.w is ignored, considered as 1.
+OZZ_INLINE SimdFloat4 TransformPoint(const Float3x4& _m, _SimdFloat4 _p) {
+  const SimdFloat4 p = SetW(_p, simd_float4::one());
+  const SimdFloat4 products[4] = {_m.rows[0] * p, _m.rows[1] * p,
+                                  _m.rows[2] * p, simd_float4::zero()};
+  SimdFloat4 sums[4];
+  Transpose4x4(products, sums);
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+// Computes the transformation of a Float3x4 matrix and a vector _v.
+// _v.w is ignored, considered as 0.
+OZZ_INLINE SimdFloat4 TransformVector(const Float3x4& _m, _SimdFloat4 _v) {
+  const SimdFloat4 v = And(_v, simd_int4::mask_fff0());
+  const SimdFloat4 products[4] = {_m.rows[0] * v, _m.rows[1] * v,
+                                  _m.rows[2] * v, simd_float4::zero()};
+  SimdFloat4 sums[4];
+  Transpose4x4(products, sums);
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+// Computes the multiplication of two affine matrices _a and _b.
+OZZ_INLINE Float3x4 operator*(const Float3x4& _a, const Float3x4& _b) {
+  const SimdInt4 mask_w = simd_int4::mask_000f();
+  Float3x4 ret;
+  for (int i = 0; i < 3; ++i) {
+    const SimdFloat4 a = _a.rows[i];
+    const SimdFloat4 xw = MAdd(SplatX(a), _b.rows[0], And(a, mask_w));
+    const SimdFloat4 yz =
+        MAdd(SplatZ(a), _b.rows[2], SplatY(a) * _b.rows[1]);
+    ret.rows[i] = xw + yz;
+  }
+  return ret;
+}
+
+// Computes the per element addition of two matrices _a and _b.
+OZZ_INLINE Float3x4 operator+(const Float3x4& _a, const Float3x4& _b) {
+  const Float3x4 ret = {{_a.rows[0] + _b.rows[0], _a.rows[1] + _b.rows[1],
+                         _a.rows[2] + _b.rows[2]}};
+  return ret;
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_FLOAT3X4_H_
@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_DUAL_QUATERNION_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_DUAL_QUATERNION_H_
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_quaternion.h"
+
+// Implement simd dual quaternion.
+namespace ozz {
+namespace math {
+// Declare the dual quaternion type. A unit dual quaternion represents a rigid
+// transformation (rotation and translation, no scale), using 8 floats instead
+// of the 12 of a 3x4 matrix. Real part is the rotation quaternion, dual part
+// is half the translation (as a pure quaternion) multiplied by the rotation.
+struct SimdDualQuaternion {
+  SimdQuaternion real;
+  SimdQuaternion dual;
+
+  // Returns the identity dual quaternion.
+  static OZZ_INLINE SimdDualQuaternion identity() {
+    const SimdDualQuaternion dq = {SimdQuaternion::identity(),
+                                   {simd_float4::zero()}};
+    return dq;
+  }
+
+  // Returns the dual quaternion that rotates by _rotation, and then translates
+  // by _translation. _rotation must be normalized. _translation.w is ignored.
+  static OZZ_INLINE SimdDualQuaternion
+  FromRotationTranslation(const SimdQuaternion& _rotation,
+                          _SimdFloat4 _translation) {
+    const SimdQuaternion t = {
+        And(_translation * simd_float4::Load1(.5f), simd_int4::mask_fff0())};
+    const SimdDualQuaternion dq = {_rotation, t * _rotation};
+    return dq;
+  }
+};
+
+// Returns the concatenation of _a and _b, which transforms by _b and then by
+// _a, like matrices multiplication.
+OZZ_INLINE SimdDualQuaternion operator*(const SimdDualQuaternion& _a,
+                                        const SimdDualQuaternion& _b) {
+  const SimdQuaternion ad_br = _a.dual * _b.real;
+  const SimdQuaternion ar_bd = _a.real * _b.dual;
+  const SimdDualQuaternion dq = {_a.real * _b.real,
+                                 {ar_bd.xyzw + ad_br.xyzw}};
+  return dq;
+}
+
+// Returns the per element addition of _a and _b. This is used to blend dual
+// quaternions, the result must be normalized.
+OZZ_INLINE SimdDualQuaternion operator+(const SimdDualQuaternion& _a,
+                                        const SimdDualQuaternion& _b) {
+  const SimdDualQuaternion dq = {{_a.real.xyzw + _b.real.xyzw},
+                                 {_a.dual.xyzw + _b.dual.xyzw}};
+  return dq;
+}
+
+// Returns _dq with every element multiplied by _f.
+OZZ_INLINE SimdDualQuaternion operator*(const SimdDualQuaternion& _dq,
+                                        _SimdFloat4 _f) {
+  const SimdDualQuaternion dq = {{_dq.real.xyzw * _f}, {_dq.dual.xyzw * _f}};
+  return dq;
+}
+
+// Returns the normalized dual quaternion _dq. Real part length must not be 0.
+// Note that the dual part isn't made orthogonal to the real part, which is
+// negligible for blended unit dual quaternions.
+OZZ_INLINE SimdDualQuaternion Normalize(const SimdDualQuaternion& _dq) {
+  const SimdFloat4 inv_len = simd_float4::one() / Length4(_dq.real.xyzw);
+  return _dq * SplatX(inv_len);
+}
+
+// Returns the translation of the unit dual quaternion _dq. w is undefined.
+OZZ_INLINE SimdFloat4 GetTranslation(const SimdDualQuaternion& _dq) {
+  const SimdQuaternion t = _dq.dual * Conjugate(_dq.real);
+  return t.xyzw + t.xyzw;
+}
+
+// Computes the transformation of a unit dual quaternion and a point _p.
+// w component of the returned point is undefined.
+OZZ_INLINE SimdFloat4 TransformPoint(const SimdDualQuaternion& _dq,
+                                     _SimdFloat4 _p) {
+  return TransformVector(_dq.real, _p) + GetTranslation(_dq);
+}
+
+// Computes the transformation of a unit dual quaternion and a vector _v.
+// Only the rotation applies. w component of the returned vector is undefined.
+OZZ_INLINE SimdFloat4 TransformVector(const SimdDualQuaternion& _dq,
+                                      _SimdFloat4 _v) {
+  return TransformVector(_dq.real, _v);
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_DUAL_QUATERNION_H_
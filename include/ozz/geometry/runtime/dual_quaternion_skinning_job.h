@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+#include "ozz/geometry/runtime/export.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+struct SimdDualQuaternion;
+}  // namespace math
+namespace geometry {
+
+// Provides per-vertex dual quaternion skinning job implementation.
+// Dual quaternion skinning blends joints rigid transformations as dual
+// quaternions instead of matrices. Unlike matrix palette skinning (see
+// SkinningJob), blending dual quaternions doesn't collapse volume around
+// twisting or bending joints (aka "candy wrapper" effect).
+// The job has the same strided inputs and outputs as SkinningJob: it can
+// transform one point (vertex position) and two vectors (vertex normal and
+// tangent) per vertex, and has specialized code paths depending on the number
+// of joints influences per vertex and on the transformed vectors.
+// Joint dual quaternions are accessed using the per-vertex joints indices
+// provided as input. They must be pre-multiplied with the inverse of the
+// skeleton bind-pose, which is what LocalToModelJob outputs to
+// skinning_dual_quaternions.
+// Dual quaternions only represent rigid transformations. Scale (or shear) is
+// supported through an optional set of per joint matrices, that are blended
+// linearly and applied to vertices in bind pose space, before the blended
+// dual quaternion transformation.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_GEOMETRY_DLL DualQuaternionSkinningJob {
+  // Default constructor, initializes default values.
+  DualQuaternionSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if joint_dual_quaternions isn't provided.
+  // - if joint_scale_matrices is provided but smaller than
+  // joint_dual_quaternions.
+  // - if normals are provided but positions aren't.
+  // - if tangents are provided but normals aren't.
+  // - if no output is provided while an input is. For example, if input normals
+  // are provided, then output normals must also.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Maximum number of joints influencing each vertex. Must be greater than 0.
+  // Same as SkinningJob, influences_count joint indices and
+  // influences_count - 1 joint weights are read for each vertex.
+  int influences_count;
+
+  // Array of unit dual quaternions for each joint. Joint are indexed through
+  // indices array.
+  span<const math::SimdDualQuaternion> joint_dual_quaternions;
+
+  // Optional array of scale matrices for each joint, applied to vertices
+  // before joint dual quaternions. Vectors (normals and tangents) are
+  // transformed by the same matrices, which is only correct for uniform scale.
+  // If provided, this array must be at least as big as joint_dual_quaternions.
+  span<const math::Float4x4> joint_scale_matrices;
+
+  // Array of joints indices, see SkinningJob::joint_indices.
+  span<const uint16_t> joint_indices;
+  size_t joint_indices_stride;
+
+  // Array of joints weights, see SkinningJob::joint_weights.
+  span<const float> joint_weights;
+  size_t joint_weights_stride;
+
+  // Input vertex positions array (3 float values per vertex) and stride (number
+  // of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  span<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Input vertex normals (3 float values per vertex) array and stride (number
+  // of bytes between each normal).
+  // Array length must be at least vertex_count * in_normals_stride.
+  span<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Input vertex tangents (3 float values per vertex) array and stride (number
+  // of bytes between each tangent).
+  // Array length must be at least vertex_count * in_tangents_stride.
+  span<const float> in_tangents;
+  size_t in_tangents_stride;
+
+  // Output vertex positions (3 float values per vertex) array and stride
+  // (number of bytes between each position).
+  // Array length must be at least vertex_count * out_positions_stride.
+  span<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals (3 float values per vertex) array and stride (number
+  // of bytes between each normal). Output normals are normalized as long as
+  // input ones are and no scale matrix is used.
+  // Array length must be at least vertex_count * out_normals_stride.
+  span<float> out_normals;
+  size_t out_normals_stride;
+
+  // Output vertex tangents (3 float values per vertex) array and stride
+  // (number of bytes between each tangent).
+  // Array length must be at least vertex_count * out_tangents_stride.
+  span<float> out_tangents;
+  size_t out_tangents_stride;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
@@ -0,0 +1,148 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+#include "ozz/geometry/runtime/export.h"
+
+namespace ozz {
+namespace geometry {
+
+// Provides per-vertex morph target (aka blend shape) job implementation.
+// Morph targets deform a mesh by adding weighted per-vertex offsets (deltas)
+// to its positions and normals. Each target usually only moves a small part of
+// the mesh (a facial expression for example), so deltas are sparse: each
+// target stores the indices of the vertices it moves and one quantized delta
+// per index.
+// The job copies input vertices to the output buffers, and then accumulates
+// the deltas of every target whose weight isn't negligible. Targets weights
+// are usually animated using ozz::animation::FloatTrack, sampled with
+// FloatTrackSamplingJob.
+// Outputs have the same strided layout as SkinningJob inputs, so they can be
+// directly used as skinning job input. Morphing can also be done in place by
+// using the same buffer (and stride) as input and output. Note that in place
+// morphing overwrites the base mesh, so it can only be run once: running it
+// again would accumulate deltas on top of already morphed vertices.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_GEOMETRY_DLL MorphJob {
+  // Default constructor, initializes default values.
+  MorphJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if any target is invalid. See Target description.
+  // - if normals are provided but positions aren't.
+  // - if an input and output buffer are the same (in place morphing), but
+  // their strides differ.
+  // - if min_weight is negative.
+  // - if no output is provided while an input is. For example, if input normals
+  // are provided, then output normals must also.
+  bool Validate() const;
+
+  // Runs job's morphing task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a morph target, aka a sparse set of vertex deltas, and its weight.
+  struct OZZ_GEOMETRY_DLL Target {
+    // Default constructor, initializes default values.
+    Target();
+
+    // Weight of the target, usually in range [0,1]. Targets whose absolute
+    // weight is less or equal to MorphJob::min_weight are skipped.
+    float weight;
+
+    // Indices of the vertices moved by this target, sorted in ascending order.
+    // They must all be less than MorphJob::vertex_count. Both are checked by
+    // MorphJob::Validate().
+    span<const uint16_t> indices;
+
+    // Position deltas, 3 signed 16 bits integers per index. Deltas are decoded
+    // as quantized * position_scale, where position_scale is usually the
+    // biggest absolute delta component of the target divided by 32767.
+    // Array length must be at least indices size * 3.
+    span<const int16_t> position_deltas;
+    float position_scale;
+
+    // Optional normal deltas, 3 signed 8 bits integers per index, decoded as
+    // quantized * normal_scale. Normal deltas are only applied if job normals
+    // are provided, in which case array length must be at least indices size *
+    // 3.
+    span<const int8_t> normal_deltas;
+    float normal_scale;
+  };
+
+  // Number of vertices to morph. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Morph targets to apply. The range can be empty, in which case input
+  // vertices are only copied to the output.
+  span<const Target> targets;
+
+  // Targets whose absolute weight is less or equal to min_weight are skipped.
+  // Default is 0, so that only zero-weight targets are skipped.
+  float min_weight;
+
+  // Input vertex positions array (3 float values per vertex) and stride (number
+  // of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  span<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Optional input vertex normals (3 float values per vertex) array and stride
+  // (number of bytes between each normal).
+  // Array length must be at least vertex_count * in_normals_stride.
+  span<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Output vertex positions (3 float values per vertex) array and stride
+  // (number of bytes between each position). It can be the same buffer as
+  // in_positions, with the same stride.
+  // Array length must be at least vertex_count * out_positions_stride.
+  span<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals (3 float values per vertex) array and stride
+  // (number of bytes between each normal). It can be the same buffer as
+  // in_normals, with the same stride.
+  // Note that output normals are not normalized by the morph job, like
+  // SkinningJob outputs.
+  // Array length must be at least vertex_count * out_normals_stride.
+  span<float> out_normals;
+  size_t out_normals_stride;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+
+#include "ozz/geometry/runtime/export.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+namespace ozz {
+namespace geometry {
+
+// Size of the cache lines that vertex ranges outputs are aligned to.
+enum { kSkinningCacheLineSize = 64 };
+
+// Computes the number of vertices that every range of a partitioned _job must
+// be a multiple of, so that ranges outputs never share a cache line. Ranges
+// boundaries are relative to output buffers beginning, which should thus be
+// aligned to kSkinningCacheLineSize.
+OZZ_GEOMETRY_DLL int GetSkinningRangeAlignment(const SkinningJob& _job);
+
+// Partitions _job vertices into at most _ranges.size() consecutive ranges of
+// similar size, aligned according to GetSkinningRangeAlignment(). Ranges are
+// never smaller than _min_range_vertices, except the last one.
+// Returns the number of ranges written to _ranges, which is 0 if _job has no
+// vertex or if _ranges is empty.
+// If _job has joint remaps, every range computes the same skinning matrices
+// and writes them to the same remap_scratch. Such a job should thus first be
+// converted with GetRemappedSkinningJob() before being partitioned.
+// Ranges don't use _job vertex_scratch, as they're meant to be run
+// concurrently.
+OZZ_GEOMETRY_DLL int PartitionSkinningJob(const SkinningJob& _job,
+                                          int _min_range_vertices,
+                                          span<SkinningJob> _ranges);
+
+// Interface of the task executor used by ParallelSkinningJob to dispatch
+// skinning tasks, usually implemented on top of the application job system.
+class OZZ_GEOMETRY_DLL SkinningTaskExecutor {
+ public:
+  virtual ~SkinningTaskExecutor();
+
+  // Task function, to call with the _context provided to ParallelFor.
+  typedef void (*Task)(void* _context, int _index);
+
+  // Calls _task for every index in [0, _count[, in any order and potentially
+  // concurrently. Must return once all tasks have completed.
+  virtual void ParallelFor(int _count, Task _task, void* _context) = 0;
+};
+
+// Provides a SkinningJob that can be split into tasks processing vertex
+// ranges, dispatched to a user-supplied executor. Every range is skinned by
+// the same code as the single threaded job, so outputs are identical.
+// Ranges are aligned according to GetSkinningRangeAlignment(), so that tasks
+// don't write to the same cache lines. If the skinning job has joint remaps,
+// skinning matrices are computed once before dispatching tasks, which then
+// share them. Without remap_scratch, this palette is stack allocated by the
+// calling thread, while tasks only use SkinningJob batching buffers. Job
+// vertex_scratch is only used if tasks are run sequentially by the calling
+// thread.
+struct OZZ_GEOMETRY_DLL ParallelSkinningJob {
+  // Default constructor, initializes default values.
+  ParallelSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if skinning job is invalid. See SkinningJob::Validate().
+  // - if max_tasks or min_task_vertices is less than 1.
+  bool Validate() const;
+
+  // Runs job's skinning tasks. The calling thread waits for all tasks to
+  // complete.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Skinning job to partition.
+  SkinningJob job;
+
+  // Optional task executor. If nullptr, all tasks are run sequentially by the
+  // calling thread.
+  SkinningTaskExecutor* executor;
+
+  // Maximum number of tasks, usually the number of worker threads. Default
+  // is 8.
+  int max_tasks;
+
+  // Minimum number of vertices per task, below which the dispatch overhead
+  // isn't worth it. Default is 4096.
+  int min_task_vertices;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
@@ -28,14 +28,17 @@
 #ifndef OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_JOB_H_
 #define OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_JOB_H_
 
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/vec_float.h"
 #include "ozz/base/platform.h"
 #include "ozz/base/span.h"
 #include "ozz/geometry/runtime/export.h"
 
 namespace ozz {
 namespace math {
+struct Float3x4;
 struct Float4x4;
-}
+}  // namespace math
 namespace geometry {
 
 // Provides per-vertex matrix palette skinning job implementation.
@@ -72,19 +75,69 @@ namespace geometry {
 // joints matrices (see http://www.glprogramming.com/red/appendixf.html). This
 // code path is less efficient than the one without this matrices set, and
 // should only be used when input matrices have non uniform scaling or shearing.
+// Instead of a per-mesh palette of skinning matrices, the job can alternatively
+// be provided with the model-space matrices of the whole skeleton, the mesh
+// inverse bind-pose matrices and its joint remapping table. Skinning matrices
+// are then computed by the job in a pre-pass, avoiding a separate palette
+// build and copy.
+// Positions, normals, tangents and weights can alternatively be provided in
+// quantized formats, to reduce mesh memory and skinning bandwidth. Quantized
+// inputs are decoded by small batches of vertices to a stack buffer, which is
+// then skinned by the same code path as float inputs.
+// Outputs can be written as half precision floats, which halves gpu vertex
+// buffer memory and upload bandwidth. Such outputs are skinned by small batches
+// to a stack buffer, which is then converted and written. This additional pass
+// makes half outputs slower to skin than float outputs.
+// Those stack buffers nest: a job with joint remaps (without remap_scratch),
+// half outputs and quantized inputs (without vertex_scratch) uses about 28KB of
+// stack (12KB remapped palette, 8KB output buffer and 8KB decoding buffer).
+// This can exceed the stack size of job system fibers or small threads, in
+// which case remap_scratch and vertex_scratch should be provided instead.
 // The job does not owned the buffers (in/output) and will thus not delete them
 // during job's destruction.
 struct OZZ_GEOMETRY_DLL SkinningJob {
   // Default constructor, initializes default values.
   SkinningJob();
 
+  // Encodings supported for quantized normals and tangents.
+  enum VectorEncoding {
+    // 3 signed normalized 8 bits components (x, y, z), decoded as
+    // max(quantized / 127, -1).
+    kSnorm8,
+    // 2 signed normalized 8 bits components, storing the unit vector using
+    // octahedral mapping. Decoded vectors are normalized.
+    kOctahedral8,
+  };
+
+  // Maximum number of influences supported with quantized weights.
+  enum { kMaxQuantizedInfluences = 256 };
+
+  // Maximum number of remapped joints whose skinning matrices can be computed
+  // without a remap scratch buffer. It bounds the size of the stack allocated
+  // buffer, aka 12KB.
+  enum { kMaxStackRemappedJoints = 256 };
+
+  // Size of vertex_scratch buffer, in number of SimdFloat4, aka 16KB. It holds
+  // the output and decoding buffers.
+  enum { kVertexScratchSize = 1024 };
+
   // Validates job parameters.
   // Returns true for a valid job, false otherwise:
   // - if any range is invalid. See each range description.
+  // - if both or none of joint_matrices and joint_affine_matrices are
+  // provided.
   // - if normals are provided but positions aren't.
   // - if tangents are provided but normals aren't.
+  // - if both float and quantized inputs are provided for the same stream.
+  // - if quantized weights are used with more than kMaxQuantizedInfluences.
+  // - if joint_remaps references joints out of joint matrices range, or if
+  // joint_inverse_bind_matrices is smaller than joint_remaps.
+  // - if remap_scratch is specified but smaller than joint_remaps, or if it
+  // isn't and joint_remaps is bigger than kMaxStackRemappedJoints.
+  // - if vertex_scratch is specified but smaller than kVertexScratchSize.
   // - if no output is provided while an input is. For example, if input normals
   // are provided, then output normals must also.
+  // - if both float and half outputs are provided for the same stream.
   bool Validate() const;
 
   // Runs job's skinning task.
@@ -109,9 +162,51 @@ struct OZZ_GEOMETRY_DLL SkinningJob {
   // Array of matrices for each joint. Joint are indexed through indices array.
   span<const math::Float4x4> joint_matrices;
 
+  // Array of 3x4 affine matrices for each joint, to use instead of
+  // joint_matrices. Compact affine matrices reduce palette memory and
+  // bandwidth, and are cheaper to blend. Only one of joint_matrices and
+  // joint_affine_matrices must be provided.
+  span<const math::Float3x4> joint_affine_matrices;
+
+  // Optional joint remapping table. If provided, joint_matrices (or
+  // joint_affine_matrices) are the model-space matrices of the skeleton, and
+  // joint_indices index joint_remaps instead of joint matrices. The skinning
+  // matrix of index i is computed as joint_matrices[joint_remaps[i]] *
+  // joint_inverse_bind_matrices[i], which is what Mesh::joint_remaps and
+  // Mesh::inverse_bind_poses describe.
+  // Skinning matrices are computed as 3x4 affine matrices for every remapped
+  // joint, each time the job runs. Joints remapping should thus only be used
+  // with mesh parts that reference most of the remapped joints. When a mesh
+  // is skinned by multiple jobs (parts or vertex ranges), matrices should
+  // rather be computed once with GetRemappedSkinningJob().
+  // This is the preferred remapping API for CPU skinning, as no palette
+  // needs to be stored between animation and skinning stages. When a palette
+  // is needed anyway (GPU skinning, or joint matrices uploaded separately),
+  // prefer LocalToModelJob::joint_remaps, which outputs skinning matrices
+  // while model-space matrices are computed.
+  span<const uint16_t> joint_remaps;
+
+  // Inverse bind-pose matrices, required if joint_remaps is provided. Array
+  // length must be at least joint_remaps size.
+  span<const math::Float4x4> joint_inverse_bind_matrices;
+
+  // Optional buffer used to store remapped skinning matrices. It's only needed
+  // if joint_remaps is bigger than kMaxStackRemappedJoints, in which case its
+  // length must be at least joint_remaps size. The buffer is written by every
+  // Run, so it can't be shared by jobs running concurrently. Those should
+  // rather share a job returned by GetRemappedSkinningJob().
+  span<math::Float3x4> remap_scratch;
+
+  // Optional buffer used to decode quantized inputs and to buffer half
+  // outputs, instead of stack allocated buffers. If specified, its length must
+  // be at least kVertexScratchSize. Like remap_scratch, it's written by every
+  // Run, so it can't be shared by jobs running concurrently.
+  span<math::SimdFloat4> vertex_scratch;
+
   // Optional array of inverse transposed matrices for each joint. If provided,
   // this array is used to transform vectors (normals and tangents), otherwise
-  // joint_matrices array is used.
+  // joint_matrices array is used. Inverse transposed matrices aren't remapped,
+  // they are indexed like the skinning matrices palette.
   // As explained here (http://www.glprogramming.com/red/appendixf.html) in the,
   // red book, transforming normals requires a special attention when the
   // transformation matrix has scaling or shearing. In this case the right
@@ -138,24 +233,53 @@ struct OZZ_GEOMETRY_DLL SkinningJob {
   span<const float> joint_weights;
   size_t joint_weights_stride;
 
+  // Optional unsigned normalized 8 bits joint weights, to use instead of
+  // joint_weights. Weights are decoded as quantized / 255, and the last weight
+  // is restored the same way. joint_weights_stride is used as the stride
+  // between each vertex weights.
+  span<const uint8_t> joint_quantized_weights;
+
   // Input vertex positions array (3 float values per vertex) and stride (number
   // of bytes between each position).
   // Array length must be at least vertex_count * in_positions_stride.
   span<const float> in_positions;
   size_t in_positions_stride;
 
+  // Optional input vertex positions quantized as 3 signed 16 bits integers per
+  // vertex, to use instead of in_positions. in_positions_stride is used as
+  // the stride between each position.
+  // Positions are decoded as quantized * positions_scale + positions_offset,
+  // where scale and offset are usually computed from the bounds of the
+  // vertices set (aka mesh part).
+  span<const int16_t> in_quantized_positions;
+  math::Float3 positions_scale;
+  math::Float3 positions_offset;
+
   // Input vertex normals (3 float values per vertex) array and stride (number
   // of bytes between each normal).
   // Array length must be at least vertex_count * in_normals_stride.
   span<const float> in_normals;
   size_t in_normals_stride;
 
+  // Optional input vertex normals quantized according to
+  // quantized_vectors_encoding, to use instead of in_normals.
+  // in_normals_stride is used as the stride between each normal.
+  span<const int8_t> in_quantized_normals;
+
   // Input vertex tangents (3 float values per vertex) array and stride (number
   // of bytes between each tangent).
   // Array length must be at least vertex_count * in_tangents_stride.
   span<const float> in_tangents;
   size_t in_tangents_stride;
 
+  // Optional input vertex tangents quantized according to
+  // quantized_vectors_encoding, to use instead of in_tangents.
+  // in_tangents_stride is used as the stride between each tangent.
+  span<const int8_t> in_quantized_tangents;
+
+  // Encoding of quantized normals and tangents. Default is kSnorm8.
+  VectorEncoding quantized_vectors_encoding;
+
   // Output vertex positions (3 float values per vertex) array and stride
   // (number of bytes between each position).
   // Array length must be at least vertex_count * out_positions_stride.
@@ -179,7 +303,35 @@ struct OZZ_GEOMETRY_DLL SkinningJob {
   // Array length must be at least vertex_count * out_tangents_stride.
   span<float> out_tangents;
   size_t out_tangents_stride;
+
+  // Optional half precision outputs (3 IEEE 754 16 bits floats per vertex),
+  // to use instead of out_positions, out_normals and out_tangents. Strides
+  // are out_positions_stride, out_normals_stride and out_tangents_stride.
+  // Streams can be mixed, for example to write float positions and half
+  // normals to the same interleaved vertex buffer.
+  span<uint16_t> out_half_positions;
+  span<uint16_t> out_half_normals;
+  span<uint16_t> out_half_tangents;
 };
+
+// Returns a copy of _job restricted to _count vertices starting from vertex
+// _begin. Every input and output buffer (float or quantized) is offset
+// according to its stride, so the returned job can be run independently of
+// the other ranges. _job is expected to be valid, and [_begin, _begin +
+// _count[ must be included in [0, _job.vertex_count[.
+OZZ_GEOMETRY_DLL SkinningJob GetSkinningJobRange(const SkinningJob& _job,
+                                                 int _begin, int _count);
+
+// Computes the remapped skinning matrices of _job to _palette, and returns a
+// copy of _job that uses _palette as joint_affine_matrices, without joint
+// remaps. This allows to compute skinning matrices once, and share them with
+// multiple jobs skinning ranges of the same mesh part.
+// Only _job joint remapping inputs (joint_matrices or joint_affine_matrices,
+// joint_remaps and joint_inverse_bind_matrices) are expected to be valid, other
+// members are copied as is. _palette length must be at least _job.joint_remaps
+// size.
+OZZ_GEOMETRY_DLL SkinningJob GetRemappedSkinningJob(
+    const SkinningJob& _job, const span<math::Float3x4>& _palette);
 }  // namespace geometry
 }  // namespace ozz
 #endif  // OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_JOB_H_
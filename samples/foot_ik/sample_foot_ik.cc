@@ -25,6 +25,7 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <algorithm>
 #include <limits>
 
 #include "framework/application.h"
@@ -318,6 +319,10 @@ class FootIKSampleApplication : public ozz::sample::Application {
     ltm_job.input = make_span(locals_);
     ltm_job.output = make_span(models_);
 
+    // Hips of the legs that are updated by IK.
+    int hips[kLegsCount];
+    int num_hips = 0;
+
     // Perform IK
     for (size_t l = 0; l < kLegsCount; ++l) {
       const LegRayInfo& ray = rays_info_[l];
@@ -325,6 +330,7 @@ class FootIKSampleApplication : public ozz::sample::Application {
         continue;
       }
       const LegSetup& leg = legs_setup_[l];
+      hips[num_hips++] = leg.hip;
 
       // Updates leg joint chain so ankle reaches its targetted position.
       if (two_bone_ik_ &&
@@ -347,16 +353,28 @@ class FootIKSampleApplication : public ozz::sample::Application {
       if (aim_ik_ && !ApplyAnkleAimIK(leg, aim_ik_target, inv_root)) {
         return false;
       }
+    }
 
-      // Updates model-space transformation now ankle local changes is done.
-      // Ankle rotation has already been updated, but its siblings (or it's
-      // parent siblings) might are not. So we local-to-model update must
-      // be complete starting from hip.
-      ltm_job.from = leg.hip;
-      ltm_job.to = ozz::animation::Skeleton::kMaxJoints;
-      if (!ltm_job.Run()) {
-        return false;
-      }
+    // Updates model-space transformation now ankles local changes are done.
+    // Ankles rotation has already been updated, but their siblings (or their
+    // parent siblings) might not. So local-to-model update must be complete
+    // starting from hips. All legs are updated at once, subtrees must be
+    // sorted.
+#if defined(__GNUC__) && !defined(__clang__)
+// Gcc reports a false positive array-bounds error from std::sort insertion
+// sort unrolling, which can't know that num_hips <= kLegsCount.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif  // __GNUC__
+    std::sort(hips, hips + num_hips);
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif  // __GNUC__
+    ltm_job.from = ozz::animation::Skeleton::kNoParent;
+    ltm_job.to = ozz::animation::Skeleton::kMaxJoints;
+    ltm_job.subtrees = ozz::span<const int>(hips, num_hips);
+    if (num_hips != 0 && !ltm_job.Run()) {
+      return false;
     }
     return true;
   }
@@ -459,19 +477,11 @@ class FootIKSampleApplication : public ozz::sample::Application {
 
     // Renders character.
     if (show_skin_) {
-      // Builds skinning matrices.
-      // The mesh might not use (aka be skinned by) all skeleton joints. We
-      // use the joint remapping table (available from the mesh object) to
-      // reorder model-space matrices and build skinning ones.
-      for (size_t m = 0; m < meshes_.size(); ++m) {
-        const ozz::sample::Mesh& mesh = meshes_[m];
-        for (size_t i = 0; i < mesh.joint_remaps.size(); ++i) {
-          skinning_matrices_[i] =
-              models_[mesh.joint_remaps[i]] * mesh.inverse_bind_poses[i];
-        }
-
-        success &= _renderer->DrawSkinnedMesh(
-            mesh, make_span(skinning_matrices_), offsetted_root);
+      // Renders skin. The renderer builds skinning matrices from model-space
+      // matrices, using the mesh joint remapping table.
+      for (const ozz::sample::Mesh& mesh : meshes_) {
+        success &=
+            _renderer->DrawSkinnedMesh(mesh, make_span(models_), offsetted_root);
       }
     } else {
       // Renders skeleton only.
@@ -578,7 +588,6 @@ class FootIKSampleApplication : public ozz::sample::Application {
         return false;
       }
     }
-    skinning_matrices_.resize(num_joints);
 
     // Reading collision/rendering floor mesh.
     if (!ozz::sample::LoadMeshes(OPTIONS_floor, &floors_)) {
@@ -747,7 +756,6 @@ class FootIKSampleApplication : public ozz::sample::Application {
 
   // Buffer of skinning matrices, result of the joint multiplication of the
   // inverse rest pose with the model space matrix.
-  ozz::vector<ozz::math::Float4x4> skinning_matrices_;
 
   // The mesh used by the sample.
   ozz::vector<ozz::sample::Mesh> meshes_;
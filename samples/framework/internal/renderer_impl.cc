@@ -29,6 +29,8 @@
 
 #include "renderer_impl.h"
 
+#include <algorithm>
+
 #include "camera.h"
 #include "framework/mesh.h"
 #include "icosphere.h"
@@ -38,6 +40,7 @@
 #include "ozz/animation/runtime/skeleton_utils.h"
 #include "ozz/base/log.h"
 #include "ozz/base/maths/box.h"
+#include "ozz/base/maths/float3x4.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/vec_float.h"
@@ -601,7 +604,7 @@ bool RendererImpl::DrawPosture(const ozz::animation::Skeleton& _skeleton,
   }
 
   // Convert matrices to uniforms.
-  const int max_skeleton_pieces = animation::Skeleton::kMaxJoints * 2;
+  const int max_skeleton_pieces = _skeleton.num_joints() * 2;
   const size_t max_uniforms_size = max_skeleton_pieces * 2 * 16 * sizeof(float);
   float* uniforms =
       static_cast<float*>(scratch_buffer_.Resize(max_uniforms_size));
@@ -1408,13 +1411,42 @@ bool RendererImpl::DrawMesh(const Mesh& _mesh,
 }
 
 bool RendererImpl::DrawSkinnedMesh(
-    const Mesh& _mesh, const span<math::Float4x4> _skinning_matrices,
+    const Mesh& _mesh, const span<const math::Float4x4> _models,
     const ozz::math::Float4x4& _transform, const Options& _options) {
   // Forward to DrawMesh function is skinning is disabled.
-  if (_options.skip_skinning || !_mesh.skinned()) {
+  if (!_mesh.skinned()) {
+    return DrawMesh(_mesh, _transform, _options);
+  }
+  if (_options.skip_skinning && !_mesh.quantized()) {
     return DrawMesh(_mesh, _transform, _options);
   }
 
+  // Computes skinning matrices palette once for all mesh parts. The mesh
+  // might not use (aka be skinned by) all skeleton joints, so the joint
+  // remapping table is used to reorder model-space matrices, which are
+  // multiplied by inverse bind-poses.
+  const size_t num_skinning_joints = _mesh.joint_remaps.size();
+  const span<math::Float3x4> palette(
+      static_cast<math::Float3x4*>(skinning_palette_buffer_.Resize(
+          num_skinning_joints * sizeof(math::Float3x4))),
+      num_skinning_joints);
+  ozz::geometry::SkinningJob palette_job;
+  if (_options.skip_skinning) {
+    // Quantized meshes are decoded by the skinning job, so bind pose is
+    // rendered by skinning with identity matrices.
+    std::fill(palette.begin(), palette.end(), math::Float3x4::identity());
+    palette_job.joint_affine_matrices = palette;
+  } else {
+    if (_mesh.highest_joint_index() >= static_cast<int>(_models.size())) {
+      return false;
+    }
+    palette_job.joint_matrices = _models;
+    palette_job.joint_remaps = make_span(_mesh.joint_remaps);
+    palette_job.joint_inverse_bind_matrices =
+        make_span(_mesh.inverse_bind_poses);
+    palette_job = ozz::geometry::GetRemappedSkinningJob(palette_job, palette);
+  }
+
   if (_options.wireframe) {
 #ifndef EMSCRIPTEN
     GL(PolygonMode(GL_FRONT_AND_BACK, GL_LINE));
@@ -1460,23 +1492,20 @@ bool RendererImpl::DrawSkinnedMesh(
     const ozz::sample::Mesh::Part& part = _mesh.parts[i];
 
     // Skip this iteration if no vertex.
-    const size_t part_vertex_count = part.positions.size() / 3;
+    const size_t part_vertex_count = part.vertex_count();
     if (part_vertex_count == 0) {
       continue;
     }
 
-    // Fills the job.
-    ozz::geometry::SkinningJob skinning_job;
+    // Fills the job, starting from the one that references the skinning
+    // matrices palette.
+    ozz::geometry::SkinningJob skinning_job = palette_job;
     skinning_job.vertex_count = static_cast<int>(part_vertex_count);
     const int part_influences_count = part.influences_count();
 
     // Clamps joints influence count according to the option.
     skinning_job.influences_count = part_influences_count;
 
-    // Setup skinning matrices, that came from the animation stage before being
-    // multiplied by inverse model-space bind-pose.
-    skinning_job.joint_matrices = _skinning_matrices;
-
     // Setup joint's indices.
     skinning_job.joint_indices = make_span(part.joint_indices);
     skinning_job.joint_indices_stride =
@@ -1484,15 +1513,34 @@ bool RendererImpl::DrawSkinnedMesh(
 
     // Setup joint's weights.
     if (part_influences_count > 1) {
-      skinning_job.joint_weights = make_span(part.joint_weights);
-      skinning_job.joint_weights_stride =
-          sizeof(float) * (part_influences_count - 1);
+      if (part.quantized_joint_weights.empty()) {
+        skinning_job.joint_weights = make_span(part.joint_weights);
+        skinning_job.joint_weights_stride =
+            sizeof(float) * (part_influences_count - 1);
+      } else {
+        skinning_job.joint_quantized_weights =
+            make_span(part.quantized_joint_weights);
+        skinning_job.joint_weights_stride =
+            sizeof(uint8_t) * (part_influences_count - 1);
+      }
     }
 
     // Setup input positions, coming from the loaded mesh.
-    skinning_job.in_positions = make_span(part.positions);
-    skinning_job.in_positions_stride =
-        sizeof(float) * ozz::sample::Mesh::Part::kPositionsCpnts;
+    if (part.quantized()) {
+      skinning_job.in_quantized_positions = make_span(part.quantized_positions);
+      skinning_job.in_positions_stride =
+          sizeof(int16_t) * ozz::sample::Mesh::Part::kQuantizedPositionsCpnts;
+      skinning_job.positions_scale = part.positions_scale;
+      skinning_job.positions_offset = part.positions_offset;
+    } else {
+      skinning_job.in_positions = make_span(part.positions);
+      skinning_job.in_positions_stride =
+          sizeof(float) * ozz::sample::Mesh::Part::kPositionsCpnts;
+    }
+
+    // Quantized normals and tangents use octahedral encoding.
+    skinning_job.quantized_vectors_encoding =
+        ozz::geometry::SkinningJob::kOctahedral8;
 
     // Setup output positions, coming from the rendering output mesh buffers.
     // We need to offset the buffer every loop.
@@ -1520,6 +1568,14 @@ bool RendererImpl::DrawSkinnedMesh(
       // We need to offset the buffer every loop.
       skinning_job.out_normals = {out_normal_begin, out_normal_end};
       skinning_job.out_normals_stride = normals_stride;
+    } else if (part.quantized_normals.size() /
+                   ozz::sample::Mesh::Part::kQuantizedNormalsCpnts ==
+               part_vertex_count) {
+      skinning_job.in_quantized_normals = make_span(part.quantized_normals);
+      skinning_job.in_normals_stride =
+          sizeof(int8_t) * ozz::sample::Mesh::Part::kQuantizedNormalsCpnts;
+      skinning_job.out_normals = {out_normal_begin, out_normal_end};
+      skinning_job.out_normals_stride = normals_stride;
     } else {
       // Fills output with default normals.
       for (float* normal = out_normal_begin; normal < out_normal_end;
@@ -1547,6 +1603,14 @@ bool RendererImpl::DrawSkinnedMesh(
       // We need to offset the buffer every loop.
       skinning_job.out_tangents = {out_tangent_begin, out_tangent_end};
       skinning_job.out_tangents_stride = tangents_stride;
+    } else if (part.quantized_tangents.size() /
+                   ozz::sample::Mesh::Part::kQuantizedTangentsCpnts ==
+               part_vertex_count) {
+      skinning_job.in_quantized_tangents = make_span(part.quantized_tangents);
+      skinning_job.in_tangents_stride =
+          sizeof(int8_t) * ozz::sample::Mesh::Part::kQuantizedTangentsCpnts;
+      skinning_job.out_tangents = {out_tangent_begin, out_tangent_end};
+      skinning_job.out_tangents_stride = tangents_stride;
     } else {
       // Fills output with default tangents.
       for (float* tangent = out_tangent_begin; tangent < out_tangent_end;
@@ -1578,9 +1642,10 @@ bool RendererImpl::DrawSkinnedMesh(
                   _transform);
     }
 
-    // Renders debug binormals.
+    // Renders debug binormals. Handedness is only available from float
+    // tangents.
     if (_options.binormals && skinning_job.out_normals.size() > 0 &&
-        skinning_job.out_tangents.size() > 0) {
+        skinning_job.in_tangents.size() > 0) {
       DrawBinormals(skinning_job.out_positions,
                     skinning_job.out_positions_stride, skinning_job.out_normals,
                     skinning_job.out_normals_stride, skinning_job.out_tangents,
@@ -142,7 +142,7 @@ class RendererImpl : public Renderer {
       Color _color);
 
   virtual bool DrawSkinnedMesh(const Mesh& _mesh,
-                               const span<math::Float4x4> _skinning_matrices,
+                               const span<const math::Float4x4> _models,
                                const ozz::math::Float4x4& _transform,
                                const Options& _options = Options());
 
@@ -240,6 +240,10 @@ class RendererImpl : public Renderer {
   };
   ScratchBuffer scratch_buffer_;
 
+  // Skinning matrices palette buffer, computed once per skinned mesh and
+  // shared by all its parts.
+  ScratchBuffer skinning_palette_buffer_;
+
   // Immediate renderer implementation.
   ozz::unique_ptr<GlImmediateRenderer> immediate_;
 
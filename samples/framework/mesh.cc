@@ -50,13 +50,18 @@ void Extern<sample::Mesh::Part>::Save(OArchive& _archive,
     _archive << part.colors;
     _archive << part.joint_indices;
     _archive << part.joint_weights;
+    _archive << part.quantized_positions;
+    _archive << part.positions_scale;
+    _archive << part.positions_offset;
+    _archive << part.quantized_normals;
+    _archive << part.quantized_tangents;
+    _archive << part.quantized_joint_weights;
   }
 }
 
 void Extern<sample::Mesh::Part>::Load(IArchive& _archive,
                                       sample::Mesh::Part* _parts, size_t _count,
                                       uint32_t _version) {
-  (void)_version;
   for (size_t i = 0; i < _count; ++i) {
     sample::Mesh::Part& part = _parts[i];
     _archive >> part.positions;
@@ -66,6 +71,14 @@ void Extern<sample::Mesh::Part>::Load(IArchive& _archive,
     _archive >> part.colors;
     _archive >> part.joint_indices;
     _archive >> part.joint_weights;
+    if (_version >= 2) {
+      _archive >> part.quantized_positions;
+      _archive >> part.positions_scale;
+      _archive >> part.positions_offset;
+      _archive >> part.quantized_normals;
+      _archive >> part.quantized_tangents;
+      _archive >> part.quantized_joint_weights;
+    }
   }
 }
 
@@ -72,6 +72,16 @@ struct Mesh {
     return !inverse_bind_poses.empty();
   }
 
+  // Test if any mesh part is quantized.
+  bool quantized() const {
+    for (size_t i = 0; i < parts.size(); ++i) {
+      if (parts[i].quantized()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   // Returns the number of joints used to skin the mesh.
   int num_joints() const { return static_cast<int>(inverse_bind_poses.size()); }
 
@@ -83,8 +93,19 @@ struct Mesh {
 
   // Defines a portion of the mesh. A mesh is subdivided in sets of vertices
   // with the same number of joint influences.
+  // Skinned parts can alternatively store their positions, normals, tangents
+  // and weights quantized, in which case the float version of these
+  // components is empty.
   struct Part {
-    int vertex_count() const { return static_cast<int>(positions.size()) / 3; }
+    Part() : positions_scale(1.f), positions_offset(0.f) {}
+
+    int vertex_count() const {
+      return static_cast<int>(positions.size() + quantized_positions.size()) /
+             3;
+    }
+
+    // Test if part components are quantized.
+    bool quantized() const { return !quantized_positions.empty(); }
 
     int influences_count() const {
       const int _vertex_count = vertex_count();
@@ -119,6 +140,29 @@ struct Mesh {
 
     typedef ozz::vector<float> JointWeights;
     JointWeights joint_weights;  // Stride equals influences_count - 1
+
+    // Positions quantized as signed 16 bits integers, decoded as
+    // quantized * positions_scale + positions_offset.
+    typedef ozz::vector<int16_t> QuantizedPositions;
+    QuantizedPositions quantized_positions;
+    enum { kQuantizedPositionsCpnts = 3 };  // x, y, z components
+    ozz::math::Float3 positions_scale;
+    ozz::math::Float3 positions_offset;
+
+    // Normals quantized using 8 bits octahedral encoding.
+    typedef ozz::vector<int8_t> QuantizedNormals;
+    QuantizedNormals quantized_normals;
+    enum { kQuantizedNormalsCpnts = 2 };  // Octahedral x, y components
+
+    // Tangents quantized using 8 bits octahedral encoding, followed by
+    // handedness.
+    typedef ozz::vector<int8_t> QuantizedTangents;
+    QuantizedTangents quantized_tangents;
+    enum { kQuantizedTangentsCpnts = 3 };  // Octahedral x, y, handedness.
+
+    // Weights quantized as unsigned normalized 8 bits integers.
+    typedef ozz::vector<uint8_t> QuantizedJointWeights;
+    QuantizedJointWeights quantized_joint_weights;  // Same stride as weights
   };
   typedef ozz::vector<Part> Parts;
   Parts parts;
@@ -142,7 +186,7 @@ struct Mesh {
 namespace io {
 
 OZZ_IO_TYPE_TAG("ozz-sample-Mesh-Part", sample::Mesh::Part)
-OZZ_IO_TYPE_VERSION(1, sample::Mesh::Part)
+OZZ_IO_TYPE_VERSION(2, sample::Mesh::Part)
 
 template <>
 struct Extern<sample::Mesh::Part> {
@@ -162,9 +162,11 @@ class Renderer {
           skip_skinning(_skip_skinning) {}
   };
 
-  // Renders a skinned mesh at a specified location.
+  // Renders a skinned mesh at a specified location. _models are skeleton
+  // model-space matrices, which are remapped to the mesh skinning palette
+  // using mesh joint remapping table and inverse bind-poses.
   virtual bool DrawSkinnedMesh(const Mesh& _mesh,
-                               const span<math::Float4x4> _skinning_matrices,
+                               const span<const math::Float4x4> _models,
                                const ozz::math::Float4x4& _transform,
                                const Options& _options = Options()) = 0;
 
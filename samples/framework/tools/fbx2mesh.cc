@@ -26,6 +26,7 @@
 //----------------------------------------------------------------------------//
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include "framework/mesh.h"
@@ -55,6 +56,11 @@ OZZ_OPTIONS_DECLARE_INT(
     max_influences,
     "Maximum number of joint influences per vertex (0 means no limitation).", 0,
     false)
+OZZ_OPTIONS_DECLARE_BOOL(quantize,
+                         "Quantizes skinned mesh positions (16 bits), normals "
+                         "and tangents (8 bits octahedral) and weights (8 "
+                         "bits), instead of storing floats.",
+                         false, false)
 
 namespace {
 
@@ -889,6 +895,127 @@ bool StripWeights(ozz::sample::Mesh* _mesh) {
   return true;
 }
 
+// Quantizes _value in range [-1,1] to a signed normalized 8 bits integer.
+int8_t QuantizeSnorm8(float _value) {
+  const float clamped = ozz::math::Clamp(-1.f, _value, 1.f);
+  return static_cast<int8_t>(std::floor(clamped * 127.f + .5f));
+}
+
+// Quantizes unit vector _v using 8 bits octahedral encoding. Vector is
+// projected on the octahedron, whose lower hemisphere is folded over the upper
+// one.
+void QuantizeOctahedral(const float* _v, int8_t* _out) {
+  const float l1 = std::abs(_v[0]) + std::abs(_v[1]) + std::abs(_v[2]);
+  if (l1 == 0.f) {  // Degenerated vector.
+    _out[0] = _out[1] = 0;
+    return;
+  }
+  float x = _v[0] / l1;
+  float y = _v[1] / l1;
+  if (_v[2] < 0.f) {
+    const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+    y = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+    x = fx;
+  }
+  _out[0] = QuantizeSnorm8(x);
+  _out[1] = QuantizeSnorm8(y);
+}
+
+// Quantizes positions, normals, tangents and weights of skinned mesh parts, to
+// the formats supported by SkinningJob. Float components are released.
+bool Quantize(ozz::sample::Mesh* _mesh) {
+  typedef ozz::sample::Mesh::Part Part;
+  for (size_t i = 0; i < _mesh->parts.size(); ++i) {
+    Part& part = _mesh->parts[i];
+    const int vertex_count = part.vertex_count();
+    if (vertex_count == 0) {
+      continue;
+    }
+
+    // Positions are quantized relatively to the part bounds.
+    ozz::math::Float3 min(std::numeric_limits<float>::max());
+    ozz::math::Float3 max(-std::numeric_limits<float>::max());
+    for (int j = 0; j < vertex_count; ++j) {
+      const float* position = &part.positions[j * Part::kPositionsCpnts];
+      const ozz::math::Float3 p(position[0], position[1], position[2]);
+      min = Min(min, p);
+      max = Max(max, p);
+    }
+    const float kRange = 32767.f;
+    const ozz::math::Float3 extent = (max - min) * .5f;
+    part.positions_offset = (max + min) * .5f;
+    part.positions_scale =
+        ozz::math::Float3(extent.x > 0.f ? extent.x / kRange : 1.f,
+                          extent.y > 0.f ? extent.y / kRange : 1.f,
+                          extent.z > 0.f ? extent.z / kRange : 1.f);
+    const float* scale = &part.positions_scale.x;
+    const float* offset = &part.positions_offset.x;
+    part.quantized_positions.resize(vertex_count *
+                                    Part::kQuantizedPositionsCpnts);
+    for (int j = 0; j < vertex_count; ++j) {
+      for (int k = 0; k < 3; ++k) {
+        const float p = part.positions[j * Part::kPositionsCpnts + k];
+        const float q = std::floor((p - offset[k]) / scale[k] + .5f);
+        part.quantized_positions[j * Part::kQuantizedPositionsCpnts + k] =
+            static_cast<int16_t>(ozz::math::Clamp(-kRange, q, kRange));
+      }
+    }
+    part.positions.clear();
+
+    // Normals.
+    if (part.normals.size() / Part::kNormalsCpnts ==
+        static_cast<size_t>(vertex_count)) {
+      part.quantized_normals.resize(vertex_count *
+                                    Part::kQuantizedNormalsCpnts);
+      for (int j = 0; j < vertex_count; ++j) {
+        QuantizeOctahedral(
+            &part.normals[j * Part::kNormalsCpnts],
+            &part.quantized_normals[j * Part::kQuantizedNormalsCpnts]);
+      }
+      part.normals.clear();
+    }
+
+    // Tangents, handedness is stored after the octahedral components.
+    if (part.tangents.size() / Part::kTangentsCpnts ==
+        static_cast<size_t>(vertex_count)) {
+      part.quantized_tangents.resize(vertex_count *
+                                     Part::kQuantizedTangentsCpnts);
+      for (int j = 0; j < vertex_count; ++j) {
+        const float* tangent = &part.tangents[j * Part::kTangentsCpnts];
+        int8_t* quantized =
+            &part.quantized_tangents[j * Part::kQuantizedTangentsCpnts];
+        QuantizeOctahedral(tangent, quantized);
+        quantized[2] = QuantizeSnorm8(tangent[3] < 0.f ? -1.f : 1.f);
+      }
+      part.tangents.clear();
+    }
+
+    // Weights. Cumulated weights are quantized, so that the sum of quantized
+    // weights never exceeds 1 and the restored last weight remains positive.
+    const int influences_count = part.influences_count();
+    if (influences_count > 1) {
+      const int weights_count = influences_count - 1;
+      part.quantized_joint_weights.resize(vertex_count * weights_count);
+      for (int j = 0; j < vertex_count; ++j) {
+        float cumulated = 0.f;
+        int quantized_cumulated = 0;
+        for (int k = 0; k < weights_count; ++k) {
+          const int index = j * weights_count + k;
+          cumulated =
+              ozz::math::Min(cumulated + part.joint_weights[index], 1.f);
+          const int quantized =
+              static_cast<int>(std::floor(cumulated * 255.f + .5f));
+          part.quantized_joint_weights[index] =
+              static_cast<uint8_t>(quantized - quantized_cumulated);
+          quantized_cumulated = quantized;
+        }
+      }
+      part.joint_weights.clear();
+    }
+  }
+  return true;
+}
+
 int main(int _argc, const char** _argv) {
   // Parses arguments.
   ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
@@ -1014,6 +1141,12 @@ int main(int _argc, const char** _argv) {
         return EXIT_FAILURE;
       }
 
+      // Quantizes skinned components if requested.
+      if (OPTIONS_quantize && !Quantize(&output_mesh)) {
+        ozz::log::Err() << "Failed to quantize mesh." << std::endl;
+        return EXIT_FAILURE;
+      }
+
       assert(OPTIONS_max_influences <= 0 ||
              output_mesh.max_influences_count() <= OPTIONS_max_influences);
     }
@@ -228,19 +228,11 @@ class LookAtSampleApplication : public ozz::sample::Application {
 
     // Renders character.
     if (show_skin_) {
-      // Builds skinning matrices.
-      // The mesh might not use (aka be skinned by) all skeleton joints. We
-      // use the joint remapping table (available from the mesh object) to
-      // reorder model-space matrices and build skinning ones.
-      for (size_t m = 0; m < meshes_.size(); ++m) {
-        const ozz::sample::Mesh& mesh = meshes_[m];
-        for (size_t i = 0; i < mesh.joint_remaps.size(); ++i) {
-          skinning_matrices_[i] =
-              models_[mesh.joint_remaps[i]] * mesh.inverse_bind_poses[i];
-        }
-
-        success &= _renderer->DrawSkinnedMesh(
-            mesh, make_span(skinning_matrices_), identity);
+      // Renders skin. The renderer builds skinning matrices from model-space
+      // matrices, using the mesh joint remapping table.
+      for (const ozz::sample::Mesh& mesh : meshes_) {
+        success &=
+            _renderer->DrawSkinnedMesh(mesh, make_span(models_), identity);
       }
     } else {
       // Renders skeleton only.
@@ -358,7 +350,6 @@ class LookAtSampleApplication : public ozz::sample::Application {
         return false;
       }
     }
-    skinning_matrices_.resize(num_joints);
 
     return true;
   }
@@ -479,7 +470,6 @@ class LookAtSampleApplication : public ozz::sample::Application {
 
   // Buffer of skinning matrices, result of the joint multiplication of the
   // inverse rest pose with the model-space matrix.
-  ozz::vector<ozz::math::Float4x4> skinning_matrices_;
 
   // The mesh used by the sample.
   ozz::vector<ozz::sample::Mesh> meshes_;
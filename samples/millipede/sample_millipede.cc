@@ -67,6 +67,11 @@ using ozz::math::SoaTransform;
 //     |               |
 // left_foot        right_foot
 
+// Maximum number of joints exposed by the gui slider. This is lower than
+// Skeleton::kMaxJoints, as building and rendering that many joints would make
+// the sample unresponsive and the slider too coarse.
+const int kMaxJoints = 1024;
+
 // The following constants are used to define the millipede skeleton and
 // animation.
 // Skeleton constants.
@@ -156,8 +161,7 @@ class MillipedeSampleApplication : public ozz::sample::Application {
 
     // Uses an exponential scale in the slider to maintain enough precision in
     // the lowest values.
-    if (_im_gui->DoSlider(label, 8, ozz::animation::Skeleton::kMaxJoints,
-                          &joints, .3f, true)) {
+    if (_im_gui->DoSlider(label, 8, kMaxJoints, &joints, .3f, true)) {
       const int new_slice_count = (joints - 1) / 7;
       // Slider use floats, we need to check if it has really changed.
       if (new_slice_count != slice_count_) {
@@ -150,14 +150,14 @@ class OptimizeSampleApplication : public ozz::sample::Application {
     // Computes the absolute error, aka the difference between the raw and
     // runtime model space transformation.
     const size_t num_joints = models_rt_.size();
-    float errors_sq[ozz::animation::Skeleton::kMaxJoints];
+    float* errors_sq = errors_sq_.data();
     for (size_t i = 0; i < num_joints; ++i) {
       // Computes error based on the translation difference.
       errors_sq[i] = ozz::math::GetX(ozz::math::Length3Sqr(
           models_rt_[i].cols[3] - models_raw_[i].cols[3]));
     }
 
-    std::sort(errors_sq, errors_sq + models_rt_.size());
+    std::sort(errors_sq, errors_sq + num_joints);
     error_record_med_.Push(std::sqrt(errors_sq[num_joints / 2]) * 1000.f);
     error_record_max_.Push(std::sqrt(errors_sq[num_joints - 1]) * 1000.f);
     joint_error_record_.Push(std::sqrt(errors_sq[joint_]) * 1000.f);
@@ -284,6 +284,7 @@ class OptimizeSampleApplication : public ozz::sample::Application {
     models_raw_.resize(num_joints);
     locals_diff_.resize(num_soa_joints);
     models_diff_.resize(num_joints);
+    errors_sq_.resize(num_joints);
 
     // Allocates a context that matches animation requirements.
     context_.Resize(num_joints);
@@ -532,6 +533,9 @@ class OptimizeSampleApplication : public ozz::sample::Application {
   ozz::vector<ozz::math::SoaTransform> locals_diff_;
   ozz::vector<ozz::math::Float4x4> models_diff_;
 
+  // Per joint squared errors, sorted to find median and maximum errors.
+  ozz::vector<float> errors_sq_;
+
   // Record of accuracy errors produced by animation compression and
   // optimization.
   ozz::sample::Record error_record_med_;
@@ -98,19 +98,12 @@ class SkinningSampleApplication : public ozz::sample::Application {
     }
 
     if (draw_mesh_) {
-      // Builds skinning matrices, based on the output of the animation stage.
-      // The mesh might not use (aka be skinned by) all skeleton joints. We
-      // use the joint remapping table (available from the mesh object) to
-      // reorder model-space matrices and build skinning ones.
+      // Renders skin. The renderer builds skinning matrices from the
+      // model-space matrices output by the animation stage, using the mesh
+      // joint remapping table and inverse bind-poses.
       for (const ozz::sample::Mesh& mesh : meshes_) {
-        for (size_t i = 0; i < mesh.joint_remaps.size(); ++i) {
-          skinning_matrices_[i] =
-              models_[mesh.joint_remaps[i]] * mesh.inverse_bind_poses[i];
-        }
-
-        // Renders skin.
-        success &= _renderer->DrawSkinnedMesh(
-            mesh, make_span(skinning_matrices_), transform, render_options_);
+        success &= _renderer->DrawSkinnedMesh(mesh, make_span(models_),
+                                              transform, render_options_);
       }
     }
     return success;
@@ -149,20 +142,6 @@ class SkinningSampleApplication : public ozz::sample::Application {
       return false;
     }
 
-    // Computes the number of skinning matrices required to skin all meshes.
-    // A mesh is skinned by only a subset of joints, so the number of skinning
-    // matrices might be less that the number of skeleton joints.
-    // Mesh::joint_remaps is used to know how to order skinning matrices. So
-    // the number of matrices required is the size of joint_remaps.
-    size_t num_skinning_matrices = 0;
-    for (const ozz::sample::Mesh& mesh : meshes_) {
-      num_skinning_matrices =
-          ozz::math::Max(num_skinning_matrices, mesh.joint_remaps.size());
-    }
-
-    // Allocates skinning matrices.
-    skinning_matrices_.resize(num_skinning_matrices);
-
     // Check the skeleton matches with the mesh, especially that the mesh
     // doesn't expect more joints than the skeleton has.
     for (const ozz::sample::Mesh& mesh : meshes_) {
@@ -275,7 +254,6 @@ class SkinningSampleApplication : public ozz::sample::Application {
 
   // Buffer of skinning matrices, result of the joint multiplication of the
   // inverse bind pose with the model space matrix.
-  ozz::vector<ozz::math::Float4x4> skinning_matrices_;
 
   // The mesh used by the sample.
   ozz::vector<ozz::sample::Mesh> meshes_;
@@ -0,0 +1,151 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/motion_extractor.h"
+
+#include <cmath>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/offline/raw_track.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+
+// Extracts rotation around y axis (yaw) from _q, using swing-twist
+// decomposition. Returns identity if twist is undefined (rotation of exactly
+// 180 degrees around an horizontal axis).
+math::Quaternion ExtractYaw(const math::Quaternion& _q) {
+  const math::Quaternion twist(0.f, _q.y, 0.f, _q.w);
+  return NormalizeSafe(twist, math::Quaternion::identity());
+}
+
+// Samples raw rotation track keyframes at _ratio, using the same interpolation
+// as the runtime track sampling.
+math::Quaternion SampleRotation(const RawQuaternionTrack::Keyframes& _keys,
+                                float _ratio) {
+  if (_keys.empty()) {
+    return math::Quaternion::identity();
+  }
+  if (_ratio <= _keys.front().ratio) {
+    return _keys.front().value;
+  }
+  if (_ratio >= _keys.back().ratio) {
+    return _keys.back().value;
+  }
+  size_t i = 1;
+  for (; _keys[i].ratio < _ratio; ++i) {
+  }
+  const RawQuaternionTrack::Keyframe& left = _keys[i - 1];
+  const RawQuaternionTrack::Keyframe& right = _keys[i];
+  if (left.interpolation == RawTrackInterpolation::kStep) {
+    return _ratio < right.ratio ? left.value : right.value;
+  }
+  const float alpha = (_ratio - left.ratio) / (right.ratio - left.ratio);
+  return LerpRotation(left.value, right.value, alpha);
+}
+}  // namespace
+
+MotionExtractor::MotionExtractor()
+    : root_joint(0),
+      position_x(true),
+      position_y(false),
+      position_z(true),
+      rotation_y(true),
+      bake(true) {}
+
+bool MotionExtractor::operator()(const RawAnimation& _input,
+                                 RawFloat3Track* _position,
+                                 RawQuaternionTrack* _rotation,
+                                 RawAnimation* _output) const {
+  if (!_position || !_rotation || !_output) {
+    return false;
+  }
+  // Reset outputs.
+  *_position = RawFloat3Track();
+  *_rotation = RawQuaternionTrack();
+  *_output = RawAnimation();
+
+  // Validate inputs.
+  if (!_input.Validate() || root_joint < 0 ||
+      root_joint >= _input.num_tracks()) {
+    return false;
+  }
+
+  const RawAnimation::JointTrack& root = _input.tracks[root_joint];
+  const float inv_duration = 1.f / _input.duration;
+
+  // Extracts position.
+  _position->keyframes.reserve(root.translations.size());
+  for (size_t i = 0; i < root.translations.size(); ++i) {
+    const RawAnimation::TranslationKey& src = root.translations[i];
+    const math::Float3 value(position_x ? src.value.x : 0.f,
+                             position_y ? src.value.y : 0.f,
+                             position_z ? src.value.z : 0.f);
+    const RawFloat3Track::Keyframe key = {RawTrackInterpolation::kLinear,
+                                          src.time * inv_duration, value};
+    _position->keyframes.push_back(key);
+  }
+
+  // Extracts rotation.
+  if (rotation_y) {
+    _rotation->keyframes.reserve(root.rotations.size());
+    for (size_t i = 0; i < root.rotations.size(); ++i) {
+      const RawAnimation::RotationKey& src = root.rotations[i];
+      const RawQuaternionTrack::Keyframe key = {RawTrackInterpolation::kLinear,
+                                                src.time * inv_duration,
+                                                ExtractYaw(src.value)};
+      _rotation->keyframes.push_back(key);
+    }
+  }
+
+  // Copies animation and removes extracted motion from root joint, so that
+  // root transform is now expressed relatively to the motion.
+  *_output = _input;
+  if (bake) {
+    RawAnimation::JointTrack& dest = _output->tracks[root_joint];
+    for (size_t i = 0; i < dest.translations.size(); ++i) {
+      RawAnimation::TranslationKey& key = dest.translations[i];
+      const math::Quaternion rotation =
+          SampleRotation(_rotation->keyframes, key.time * inv_duration);
+      key.value = TransformVector(Conjugate(rotation),
+                                  key.value - _position->keyframes[i].value);
+    }
+    for (size_t i = 0; i < dest.rotations.size() && rotation_y; ++i) {
+      RawAnimation::RotationKey& key = dest.rotations[i];
+      key.value = Conjugate(_rotation->keyframes[i].value) * key.value;
+    }
+  }
+
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -37,10 +37,26 @@ RawSkeleton::RawSkeleton() {}
 
 RawSkeleton::~RawSkeleton() {}
 
+RawSkeleton::Joint::Joint() : lod(0) {}
+
+namespace {
+struct LodValidator {
+  LodValidator() : valid(true) {}
+  void operator()(const RawSkeleton::Joint& _current,
+                  const RawSkeleton::Joint* _parent) {
+    valid &= _current.lod >= 0 && (!_parent || _current.lod >= _parent->lod);
+  }
+  bool valid;
+};
+}  // namespace
+
 bool RawSkeleton::Validate() const {
   if (num_joints() > Skeleton::kMaxJoints) {
     return false;
   }
+  if (!IterateJointsDF(*this, LodValidator()).valid) {
+    return false;
+  }
   return true;
 }
 
@@ -56,7 +56,7 @@ void Extern<animation::offline::RawSkeleton>::Load(
 
 // RawSkeleton::Joint' version can be declared locally as it will be saved from
 // this cpp file only.
-OZZ_IO_TYPE_VERSION(1, animation::offline::RawSkeleton::Joint)
+OZZ_IO_TYPE_VERSION(2, animation::offline::RawSkeleton::Joint)
 
 template <>
 struct Extern<animation::offline::RawSkeleton::Joint> {
@@ -68,17 +68,23 @@ struct Extern<animation::offline::RawSkeleton::Joint> {
       _archive << joint.name;
       _archive << joint.transform;
       _archive << joint.children;
+      _archive << static_cast<int32_t>(joint.lod);
     }
   }
   static void Load(IArchive& _archive,
                    animation::offline::RawSkeleton::Joint* _joints,
                    size_t _count, uint32_t _version) {
-    (void)_version;
     for (size_t i = 0; i < _count; ++i) {
       animation::offline::RawSkeleton::Joint& joint = _joints[i];
       _archive >> joint.name;
       _archive >> joint.transform;
       _archive >> joint.children;
+      // LOD is serialized since version 2.
+      int32_t lod = 0;
+      if (_version >= 2) {
+        _archive >> lod;
+      }
+      joint.lod = lod;
     }
   }
 };
@@ -27,6 +27,7 @@
 
 #include "ozz/animation/offline/skeleton_builder.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "ozz/animation/offline/raw_skeleton.h"
@@ -68,12 +69,24 @@ struct JointLister {
   // Array of joints in the traversed DAG order.
   ozz::vector<Joint> linear_joints;
 };
+
+// Compares JointLister joints LOD, from their index.
+struct LodComparator {
+  explicit LodComparator(const JointLister& _lister) : lister(_lister) {}
+  bool operator()(int _a, int _b) const {
+    return lister.linear_joints[_a].joint->lod <
+           lister.linear_joints[_b].joint->lod;
+  }
+  const JointLister& lister;
+};
 }  // namespace
 
 // Validates the RawSkeleton and fills a Skeleton.
 // Uses RawSkeleton::IterateJointsDF to traverse in DAG depth-first order.
 // Building skeleton hierarchy in depth first order make it easier to iterate a
-// skeleton sub-hierarchy.
+// skeleton sub-hierarchy. Joints are then stably sorted by LOD, so that every
+// LOD is a prefix of the skeleton, while keeping depth-first order within a
+// LOD.
 unique_ptr<ozz::animation::Skeleton> SkeletonBuilder::operator()(
     const RawSkeleton& _raw_skeleton) const {
   // Tests _raw_skeleton validity.
@@ -93,20 +106,35 @@ unique_ptr<ozz::animation::Skeleton> SkeletonBuilder::operator()(
   IterateJointsDF<JointLister&>(_raw_skeleton, lister);
   assert(static_cast<int>(lister.linear_joints.size()) == num_joints);
 
+  // Sorts joints by LOD. As a joint LOD can't be lower than its parent's,
+  // parents are still stored before their children. order[i] is the lister
+  // index of the ith skeleton joint, and remap the inverse table.
+  ozz::vector<int> order(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), LodComparator(lister));
+  ozz::vector<int16_t> remap(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    remap[order[i]] = static_cast<int16_t>(i);
+  }
+  const int num_lods =
+      num_joints ? lister.linear_joints[order.back()].joint->lod + 1 : 0;
+
   // Computes name's buffer size.
   size_t chars_size = 0;
   for (int i = 0; i < num_joints; ++i) {
-    const RawSkeleton::Joint& current = *lister.linear_joints[i].joint;
+    const RawSkeleton::Joint& current = *lister.linear_joints[order[i]].joint;
     chars_size += (current.name.size() + 1) * sizeof(char);
   }
 
   // Allocates all skeleton members.
-  char* cursor = skeleton->Allocate(chars_size, num_joints);
+  char* cursor = skeleton->Allocate(chars_size, num_joints, num_lods);
 
   // Copy names. All names are allocated in a single buffer. Only the first name
   // is set, all other names array entries must be initialized.
   for (int i = 0; i < num_joints; ++i) {
-    const RawSkeleton::Joint& current = *lister.linear_joints[i].joint;
+    const RawSkeleton::Joint& current = *lister.linear_joints[order[i]].joint;
     skeleton->joint_names_[i] = cursor;
     strcpy(cursor, current.name.c_str());
     cursor += (current.name.size() + 1) * sizeof(char);
@@ -114,8 +142,22 @@ unique_ptr<ozz::animation::Skeleton> SkeletonBuilder::operator()(
 
   // Transfers sorted joints hierarchy to the new skeleton.
   for (int i = 0; i < num_joints; ++i) {
-    skeleton->joint_parents_[i] = lister.linear_joints[i].parent;
+    const int16_t parent = lister.linear_joints[order[i]].parent;
+    skeleton->joint_parents_[i] =
+        parent == Skeleton::kNoParent ? parent : remap[parent];
+  }
+
+  // Counts joints of every LOD, including previous LODs joints.
+  std::fill(skeleton->lod_num_joints_.begin(),
+            skeleton->lod_num_joints_.end(), int16_t(0));
+  for (int i = 0; i < num_joints; ++i) {
+    ++skeleton->lod_num_joints_[lister.linear_joints[i].joint->lod];
+  }
+  for (int i = 1; i < num_lods; ++i) {
+    skeleton->lod_num_joints_[i] += skeleton->lod_num_joints_[i - 1];
   }
+  skeleton->BuildHierarchy();
+  skeleton->BuildNameTable();
 
   // Transfers t-poses.
   const math::SimdFloat4 w_axis = math::simd_float4::w_axis();
@@ -129,7 +171,7 @@ unique_ptr<ozz::animation::Skeleton> SkeletonBuilder::operator()(
     for (int j = 0; j < 4; ++j) {
       if (i * 4 + j < num_joints) {
         const RawSkeleton::Joint& src_joint =
-            *lister.linear_joints[i * 4 + j].joint;
+            *lister.linear_joints[order[i * 4 + j]].joint;
         translations[j] =
             math::simd_float4::Load3PtrU(&src_joint.transform.translation.x);
         rotations[j] = math::NormalizeSafe4(
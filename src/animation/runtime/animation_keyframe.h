@@ -29,6 +29,7 @@
 #define OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
 
 #include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/skeleton.h"
 #include "ozz/base/platform.h"
 
 #ifndef OZZ_INCLUDE_PRIVATE_HEADER
@@ -70,13 +71,22 @@ struct OZZ_ANIMATION_DLL Float3Key {
 // key frames, but in this case RotationKey structure would induce 16 bits of
 // padding.
 struct OZZ_ANIMATION_DLL QuaternionKey {
+  // Number of bits of the track index.
+  enum { kTrackBits = 13 };
+
   float ratio;
-  uint16_t track : 13;   // The track this key frame belongs to.
-  uint16_t largest : 2;  // The largest component of the quaternion.
-  uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
-  int16_t value[3];      // The quantized value of the 3 smallest components.
+  uint16_t track : kTrackBits;  // The track this key frame belongs to.
+  uint16_t largest : 2;         // The largest component of the quaternion.
+  uint16_t sign : 1;            // The sign of the largest component. 1 for
+                                // negative.
+  int16_t value[3];             // The quantized value of the 3 smallest
+                                // components.
 };
 
+// Every skeleton joint must be addressable by rotation keys track index.
+static_assert(Skeleton::kMaxJoints <= (1 << QuaternionKey::kTrackBits),
+              "Skeleton::kMaxJoints exceeds QuaternionKey track index range");
+
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/blend_space_job.h"
+
+#include <cassert>
+#include <limits>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+
+BlendSpaceJob::BlendSpaceJob()
+    : parameter(math::Float2::zero()),
+      threshold(0.f),
+      num_contributors(nullptr) {}
+
+bool BlendSpaceJob::Validate() const {
+  bool valid = true;
+  valid &= !positions.empty();
+  valid &= contributors.size() >= positions.size();
+  valid &= num_contributors != nullptr;
+  valid &= threshold >= 0.f;
+  return valid;
+}
+
+namespace {
+
+// Computes the gradient band influence of sample _i for _parameter. Influence
+// is the minimum, over all other samples j, of the projection of the parameter
+// on the band [i,j], such that it's 1 at sample i position and 0 at sample j
+// position.
+float Influence(const span<const math::Float2>& _positions, size_t _i,
+                const math::Float2& _parameter) {
+  const math::Float2& pi = _positions[_i];
+  const math::Float2 to_parameter = _parameter - pi;
+  float influence = std::numeric_limits<float>::max();
+  for (size_t j = 0; j < _positions.size(); ++j) {
+    const math::Float2 band = _positions[j] - pi;
+    const float len2 = Dot(band, band);
+    if (j == _i || len2 == 0.f) {
+      continue;  // Coincident samples don't affect each other.
+    }
+    influence = math::Min(influence, 1.f - Dot(to_parameter, band) / len2);
+  }
+  return math::Max(influence, 0.f);
+}
+}  // namespace
+
+bool BlendSpaceJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const size_t num_samples = positions.size();
+
+  // Computes raw influences. Contributors buffer is used as temporary storage.
+  float total = 0.f;
+  for (size_t i = 0; i < num_samples; ++i) {
+    const float influence = Influence(positions, i, parameter);
+    contributors[i].index = static_cast<int>(i);
+    contributors[i].weight = influence;
+    total += influence;
+  }
+
+  // Parameter is exactly between two opposite bands, falls back to the
+  // nearest sample.
+  if (total <= 0.f) {
+    size_t nearest = 0;
+    float nearest_len2 = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < num_samples; ++i) {
+      const math::Float2 diff = parameter - positions[i];
+      const float len2 = Dot(diff, diff);
+      if (len2 < nearest_len2) {
+        nearest = i;
+        nearest_len2 = len2;
+      }
+    }
+    contributors[0].index = static_cast<int>(nearest);
+    contributors[0].weight = 1.f;
+    *num_contributors = 1;
+    return true;
+  }
+
+  // Prunes non-contributing samples, compacting contributors in place. Samples
+  // order is preserved. The highest weight is always kept, whatever the
+  // threshold.
+  const float inv_total = 1.f / total;
+  float max_weight = 0.f;
+  int max_index = 0;
+  for (size_t i = 0; i < num_samples; ++i) {
+    if (contributors[i].weight > max_weight) {
+      max_weight = contributors[i].weight;
+      max_index = static_cast<int>(i);
+    }
+  }
+  int count = 0;
+  float kept = 0.f;
+  for (size_t i = 0; i < num_samples; ++i) {
+    const Contributor contributor = contributors[i];
+    if (contributor.weight * inv_total > threshold ||
+        contributor.index == max_index) {
+      contributors[count++] = contributor;
+      kept += contributor.weight;
+    }
+  }
+  assert(count > 0 && kept > 0.f);
+
+  // Renormalizes remaining weights.
+  const float inv_kept = 1.f / kept;
+  for (int i = 0; i < count; ++i) {
+    contributors[i].weight *= inv_kept;
+  }
+  *num_contributors = count;
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
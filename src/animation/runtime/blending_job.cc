@@ -28,9 +28,9 @@
 #include "ozz/animation/runtime/blending_job.h"
 
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 
-#include "ozz/animation/runtime/skeleton.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
 
@@ -48,8 +48,20 @@ bool ValidateLayer(const BlendingJob::Layer& _layer, size_t _min_range) {
   // Tests transforms validity.
   valid &= _layer.transform.size() >= _min_range;
 
-  // Joint weights are optional.
-  if (!_layer.joint_weights.empty()) {
+  if (!_layer.soa_indices.empty()) {
+    // Sparse layer, joint weights are optional and compact.
+    if (!_layer.joint_weights.empty()) {
+      valid &= _layer.joint_weights.size() >= _layer.soa_indices.size();
+    }
+    // Indices must be strictly increasing, so that no joint is blended twice.
+    int previous = -1;
+    for (const uint16_t index : _layer.soa_indices) {
+      valid &= index > previous;
+      previous = index;
+    }
+    valid &= static_cast<size_t>(previous) < _min_range;
+  } else if (!_layer.joint_weights.empty()) {
+    // Joint weights are optional.
     valid &= _layer.joint_weights.size() >= _min_range;
   } else {
     valid &= _layer.joint_weights.empty();
@@ -77,6 +89,14 @@ bool BlendingJob::Validate() const {
   const size_t min_range = rest_pose.size();
   valid &= output.size() >= min_range;
 
+  // Scratch buffer is optional, otherwise the number of joints is limited by
+  // the stack allocated buffer size.
+  if (!scratch.empty()) {
+    valid &= scratch.size() >= min_range;
+  } else {
+    valid &= min_range <= BlendingJob::kMaxStackSoAJoints;
+  }
+
   // Validates layers.
   for (const Layer& layer : layers) {
     valid &= ValidateLayer(layer, min_range);
@@ -158,26 +178,24 @@ namespace {
 
 // Defines parameters that are passed through blending stages.
 struct ProcessArgs {
-  ProcessArgs(const BlendingJob& _job)
-      : job(_job),
+  ProcessArgs(const BlendingJob& _job,
+              math::SimdFloat4* _accumulated_weights)
+      : accumulated_weights(_accumulated_weights),
+        job(_job),
         num_soa_joints(_job.rest_pose.size()),
         num_passes(0),
         num_partial_passes(0),
         accumulated_weight(0.f) {
     // The range of all buffers has already been validated.
     assert(job.output.size() >= num_soa_joints);
-    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
+    assert(accumulated_weights);
   }
 
-  // Allocates enough space to store a accumulated weights per-joint.
+  // Accumulated weights per-joint, at least as big as the number of soa
+  // joints. It's either the job scratch buffer or a stack allocated buffer.
   // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (4 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
   // Note that this array is used with SoA data.
-  // This is the first argument in order to avoid wasting too much space with
-  // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+  math::SimdFloat4* accumulated_weights;
 
   // The job to process.
   const BlendingJob& job;
@@ -210,7 +228,7 @@ void BlendLayers(ProcessArgs* _args) {
   for (const BlendingJob::Layer& layer : _args->job.layers) {
     // Asserts buffer sizes, which must never fail as it has been validated.
     assert(layer.transform.size() >= _args->num_soa_joints);
-    assert(layer.joint_weights.empty() ||
+    assert(layer.joint_weights.empty() || !layer.soa_indices.empty() ||
            (layer.joint_weights.size() >= _args->num_soa_joints));
 
     // Skip irrelevant layers.
@@ -223,7 +241,34 @@ void BlendLayers(ProcessArgs* _args) {
     const math::SimdFloat4 layer_weight =
         math::simd_float4::Load1(layer.weight);
 
-    if (!layer.joint_weights.empty()) {
+    if (!layer.soa_indices.empty()) {
+      // This layer is sparse, only covered joints are blended. This is a
+      // partial pass as uncovered joints have a 0 weight.
+      ++_args->num_partial_passes;
+
+      if (_args->num_passes == 0) {
+        // Uncovered joints need to be initialized as no other pass did it.
+        const math::SimdFloat4 zero = math::simd_float4::zero();
+        const math::SoaTransform zero_transform = {
+            {zero, zero, zero}, {zero, zero, zero, zero}, {zero, zero, zero}};
+        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+          _args->accumulated_weights[i] = zero;
+          _args->job.output[i] = zero_transform;
+        }
+      }
+      for (size_t j = 0; j < layer.soa_indices.size(); ++j) {
+        const size_t i = layer.soa_indices[j];
+        assert(i < _args->num_soa_joints);
+        const math::SoaTransform& src = layer.transform[i];
+        math::SoaTransform* dest = _args->job.output.begin() + i;
+        const math::SimdFloat4 weight =
+            layer.joint_weights.empty()
+                ? layer_weight
+                : layer_weight * math::Max0(layer.joint_weights[j]);
+        _args->accumulated_weights[i] = _args->accumulated_weights[i] + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    } else if (!layer.joint_weights.empty()) {
       // This layer has per-joint weights.
       ++_args->num_partial_passes;
 
@@ -357,6 +402,34 @@ void Normalize(ProcessArgs* _args) {
   }
 }
 
+// Process additive blending pass of a sparse layer.
+void AddSparseLayer(const BlendingJob::Layer& _layer, ProcessArgs* _args) {
+  assert(_layer.weight != 0.f);
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 layer_weight =
+      math::simd_float4::Load1(std::abs(_layer.weight));
+  const bool subtract = _layer.weight < 0.f;
+
+  for (size_t j = 0; j < _layer.soa_indices.size(); ++j) {
+    const size_t i = _layer.soa_indices[j];
+    assert(i < _args->num_soa_joints);
+    const math::SoaTransform& src = _layer.transform[i];
+    math::SoaTransform& dest = _args->job.output[i];
+    const math::SimdFloat4 weight =
+        _layer.joint_weights.empty()
+            ? layer_weight
+            : layer_weight * math::Max0(_layer.joint_weights[j]);
+    const math::SimdFloat4 one_minus_weight = one - weight;
+    if (subtract) {
+      OZZ_SUB_PASS(src, weight, dest);
+    } else {
+      const math::SoaFloat3 one_minus_weight_f3 = {
+          one_minus_weight, one_minus_weight, one_minus_weight};
+      OZZ_ADD_PASS(src, weight, dest);
+    }
+  }
+}
+
 // Process additive blending pass.
 void AddLayers(ProcessArgs* _args) {
   assert(_args);
@@ -365,13 +438,18 @@ void AddLayers(ProcessArgs* _args) {
   for (const BlendingJob::Layer& layer : _args->job.additive_layers) {
     // Asserts buffer sizes, which must never fail as it has been validated.
     assert(layer.transform.size() >= _args->num_soa_joints);
-    assert(layer.joint_weights.empty() ||
+    assert(layer.joint_weights.empty() || !layer.soa_indices.empty() ||
            (layer.joint_weights.size() >= _args->num_soa_joints));
 
     // Prepares constants.
     const math::SimdFloat4 one = math::simd_float4::one();
 
-    if (layer.weight > 0.f) {
+    if (!layer.soa_indices.empty()) {
+      // This layer is sparse, only covered joints are processed.
+      if (layer.weight != 0.f) {
+        AddSparseLayer(layer, _args);
+      }
+    } else if (layer.weight > 0.f) {
       // Weight is positive, need to perform additive blending.
       const math::SimdFloat4 layer_weight =
           math::simd_float4::Load1(layer.weight);
@@ -429,15 +507,12 @@ void AddLayers(ProcessArgs* _args) {
     }
   }
 }
-}  // namespace
-
-bool BlendingJob::Run() const {
-  if (!Validate()) {
-    return false;
-  }
 
+// Runs all blending stages, using _accumulated_weights buffer to store
+// per-joint weights.
+void Process(const BlendingJob& _job, math::SimdFloat4* _accumulated_weights) {
   // Initializes blended parameters that are exchanged across blend stages.
-  ProcessArgs process_args(*this);
+  ProcessArgs process_args(_job, _accumulated_weights);
 
   // Blends all layers to the job output buffers.
   BlendLayers(&process_args);
@@ -450,6 +525,116 @@ bool BlendingJob::Run() const {
 
   // Process additive blending.
   AddLayers(&process_args);
+}
+
+// Runs all blending stages, using a stack allocated buffer to store per-joint
+// weights. This is quite big for a stack allocation (16 byte *
+// kMaxStackSoAJoints), which is why it's isolated in this function, only used
+// when no scratch buffer is provided.
+void ProcessStack(const BlendingJob& _job) {
+  math::SimdFloat4 accumulated_weights[BlendingJob::kMaxStackSoAJoints];
+  assert(OZZ_ARRAY_SIZE(accumulated_weights) >= _job.rest_pose.size());
+  Process(_job, accumulated_weights);
+}
+
+// Runs blending stages for all instances of a batch, one after the other,
+// using _accumulated_weights buffer for all of them.
+void ProcessBatch(const BatchBlendingJob& _batch,
+                  math::SimdFloat4* _accumulated_weights) {
+  const size_t num_instances = _batch.outputs.size();
+  const size_t num_layers = _batch.layers.size() / num_instances;
+  const size_t num_additive_layers =
+      _batch.additive_layers.size() / num_instances;
+
+  // Shared parameters are setup once.
+  BlendingJob job;
+  job.threshold = _batch.threshold;
+  job.rest_pose = _batch.rest_pose;
+
+  for (size_t i = 0; i < num_instances; ++i) {
+    job.layers = _batch.layers.subspan(i * num_layers, num_layers);
+    job.additive_layers = _batch.additive_layers.subspan(
+        i * num_additive_layers, num_additive_layers);
+    job.output = _batch.outputs[i];
+    Process(job, _accumulated_weights);
+  }
+}
+
+// Stack allocated buffer version of ProcessBatch, see ProcessStack.
+void ProcessBatchStack(const BatchBlendingJob& _batch) {
+  math::SimdFloat4 accumulated_weights[BlendingJob::kMaxStackSoAJoints];
+  assert(OZZ_ARRAY_SIZE(accumulated_weights) >= _batch.rest_pose.size());
+  ProcessBatch(_batch, accumulated_weights);
+}
+}  // namespace
+
+bool BlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  if (scratch.empty()) {
+    ProcessStack(*this);
+  } else {
+    Process(*this, scratch.begin());
+  }
+
+  return true;
+}
+
+BatchBlendingJob::BatchBlendingJob() : threshold(.1f) {}
+
+bool BatchBlendingJob::Validate() const {
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  valid &= !rest_pose.empty();
+  valid &= !outputs.empty();
+  if (!valid) {
+    return false;  // Following tests require at least one instance.
+  }
+
+  // Layers are evenly distributed across instances.
+  const size_t num_instances = outputs.size();
+  valid &= layers.size() % num_instances == 0;
+  valid &= additive_layers.size() % num_instances == 0;
+
+  // The rest pose size defines the ranges of transforms to blend.
+  const size_t min_range = rest_pose.size();
+  for (const span<math::SoaTransform>& output : outputs) {
+    valid &= output.size() >= min_range;
+  }
+
+  // Scratch buffer is optional, see BlendingJob::Validate().
+  if (!scratch.empty()) {
+    valid &= scratch.size() >= min_range;
+  } else {
+    valid &= min_range <= BlendingJob::kMaxStackSoAJoints;
+  }
+
+  // Validates all instances layers.
+  for (const BlendingJob::Layer& layer : layers) {
+    valid &= ValidateLayer(layer, min_range);
+  }
+  for (const BlendingJob::Layer& layer : additive_layers) {
+    valid &= ValidateLayer(layer, min_range);
+  }
+
+  return valid;
+}
+
+bool BatchBlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  if (scratch.empty()) {
+    ProcessBatchStack(*this);
+  } else {
+    ProcessBatch(*this, scratch.begin());
+  }
 
   return true;
 }
@@ -0,0 +1,303 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Quintic decay polynomial coefficients, for 4 joints.
+// x(t) = a.t^5 + b.t^4 + c.t^3 + half_a0.t^2 + v0.t + x0, for t < t1.
+struct SoaDecay {
+  math::SimdFloat4 x0;
+  math::SimdFloat4 v0;
+  math::SimdFloat4 half_a0;
+  math::SimdFloat4 a;
+  math::SimdFloat4 b;
+  math::SimdFloat4 c;
+  math::SimdFloat4 t1;
+};
+
+// Offsets directions and decays of 4 joints.
+struct InertializationSoaOffset {
+  math::SoaFloat3 translation_direction;
+  math::SoaFloat3 rotation_axis;
+  math::SoaFloat3 scale_direction;
+  SoaDecay translation;
+  SoaDecay rotation;
+  SoaDecay scale;
+};
+}  // namespace internal
+
+namespace {
+
+// Computes decay polynomial coefficients for an offset of magnitude _x0 and
+// velocity _v0, such that it reaches 0 with null velocity and acceleration at
+// t1 <= _duration.
+internal::SoaDecay ComputeDecay(math::_SimdFloat4 _x0, math::_SimdFloat4 _v0,
+                                math::_SimdFloat4 _duration) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+
+  // Velocity is clamped so that offset doesn't move away from zero.
+  const math::SimdFloat4 v0 = math::Min(_v0, zero);
+
+  // Shortens duration to avoid overshooting when velocity is high. Division
+  // result is discarded where v0 is null.
+  const math::SimdFloat4 five = math::simd_float4::Load1(5.f);
+  const math::SimdFloat4 t1_max =
+      math::Select(math::CmpLt(v0, zero), -five * _x0 / v0, _duration);
+  const math::SimdFloat4 t1 = math::Max(math::Min(_duration, t1_max),
+                                        math::simd_float4::Load1(1e-4f));
+
+  const math::SimdFloat4 t1_2 = t1 * t1;
+  const math::SimdFloat4 t1_3 = t1_2 * t1;
+  const math::SimdFloat4 t1_4 = t1_3 * t1;
+  const math::SimdFloat4 t1_5 = t1_4 * t1;
+  const math::SimdFloat4 v0_t1 = v0 * t1;
+
+  const math::SimdFloat4 a0 = math::Max0(
+      (math::simd_float4::Load1(-8.f) * v0_t1 -
+       math::simd_float4::Load1(20.f) * _x0) /
+      t1_2);
+  const math::SimdFloat4 a0_t1_2 = a0 * t1_2;
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+
+  internal::SoaDecay decay;
+  decay.x0 = _x0;
+  decay.v0 = v0;
+  decay.half_a0 = a0 * half;
+  decay.a = -(a0_t1_2 + math::simd_float4::Load1(6.f) * v0_t1 +
+              math::simd_float4::Load1(12.f) * _x0) *
+            half / t1_5;
+  decay.b = (math::simd_float4::Load1(3.f) * a0_t1_2 +
+             math::simd_float4::Load1(16.f) * v0_t1 +
+             math::simd_float4::Load1(30.f) * _x0) *
+            half / t1_4;
+  decay.c = -(math::simd_float4::Load1(3.f) * a0_t1_2 +
+              math::simd_float4::Load1(12.f) * v0_t1 +
+              math::simd_float4::Load1(20.f) * _x0) *
+            half / t1_3;
+  decay.t1 = t1;
+  return decay;
+}
+
+// Evaluates decayed offset magnitude at time _t.
+math::SimdFloat4 EvaluateDecay(const internal::SoaDecay& _decay,
+                               math::_SimdFloat4 _t) {
+  const math::SimdFloat4 t = math::Min(_t, _decay.t1);
+  const math::SimdFloat4 x =
+      math::MAdd(
+          math::MAdd(
+              math::MAdd(math::MAdd(math::MAdd(_decay.a, t, _decay.b), t,
+                                    _decay.c),
+                         t, _decay.half_a0),
+              t, _decay.v0),
+          t, _decay.x0);
+  return math::Select(math::CmpLt(_t, _decay.t1), x,
+                      math::simd_float4::zero());
+}
+
+// Splits _offset into a magnitude and a direction. Direction is null if
+// magnitude is null.
+math::SimdFloat4 Decompose(const math::SoaFloat3& _offset,
+                           math::SoaFloat3* _direction) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 length = Length(_offset);
+  const math::SimdInt4 valid =
+      math::CmpGt(length, math::simd_float4::Load1(1e-9f));
+  const math::SimdFloat4 divider = math::Select(valid, length, zero);
+  *_direction =
+      math::SoaFloat3::Load(math::Select(valid, _offset.x / divider, zero),
+                            math::Select(valid, _offset.y / divider, zero),
+                            math::Select(valid, _offset.z / divider, zero));
+  return length;
+}
+
+// Computes the rotation offset from _to to _from, with a positive w so that
+// the offset takes the shortest path. Returns its vector (x,y,z) part.
+math::SoaFloat3 RotationOffset(const math::SoaQuaternion& _from,
+                               const math::SoaQuaternion& _to) {
+  const math::SoaQuaternion offset = _from * Conjugate(_to);
+  const math::SimdInt4 sign = math::Sign(offset.w);
+  return math::SoaFloat3::Load(math::Xor(offset.x, sign),
+                               math::Xor(offset.y, sign),
+                               math::Xor(offset.z, sign));
+}
+}  // namespace
+
+InertializationJob::InertializationJob() : time(0.f), context(nullptr) {}
+
+bool InertializationJob::Validate() const {
+  bool valid = true;
+  valid &= context != nullptr;
+  valid &= !input.empty();
+  valid &= output.size() >= input.size();
+  if (context) {
+    valid &= input.size() <= static_cast<size_t>(context->num_soa_joints_);
+  }
+  return valid;
+}
+
+bool InertializationJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 t = math::simd_float4::Load1(time);
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  for (size_t i = 0; i < input.size(); ++i) {
+    const internal::InertializationSoaOffset& offset = context->offsets_[i];
+    const math::SoaTransform& src = input[i];
+    math::SoaTransform& dest = output[i];
+
+    // Translation.
+    const math::SimdFloat4 translation = EvaluateDecay(offset.translation, t);
+    dest.translation =
+        src.translation + offset.translation_direction * translation;
+
+    // Rotation, magnitude is the sine of the half angle, hence clamped to
+    // [0,1].
+    const math::SimdFloat4 sin_half =
+        math::Min(math::Max0(EvaluateDecay(offset.rotation, t)), one);
+    const math::SoaQuaternion rotation = {
+        offset.rotation_axis.x * sin_half, offset.rotation_axis.y * sin_half,
+        offset.rotation_axis.z * sin_half,
+        math::Sqrt(math::Max(one - sin_half * sin_half, zero))};
+    dest.rotation = rotation * src.rotation;
+
+    // Scale.
+    const math::SimdFloat4 scale = EvaluateDecay(offset.scale, t);
+    dest.scale = src.scale + offset.scale_direction * scale;
+  }
+
+  return true;
+}
+
+InertializationCaptureJob::InertializationCaptureJob()
+    : delta_time(0.f), duration(0.f), context(nullptr) {}
+
+bool InertializationCaptureJob::Validate() const {
+  bool valid = true;
+  valid &= context != nullptr;
+  valid &= !current.empty();
+  valid &= previous.size() >= current.size();
+  valid &= target.size() >= current.size();
+  valid &= delta_time > 0.f;
+  valid &= duration > 0.f;
+  if (context) {
+    valid &= current.size() <= static_cast<size_t>(context->max_soa_joints_);
+  }
+  return valid;
+}
+
+bool InertializationCaptureJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 rcp_dt = math::simd_float4::Load1(1.f / delta_time);
+  const math::SimdFloat4 simd_duration = math::simd_float4::Load1(duration);
+
+  for (size_t i = 0; i < current.size(); ++i) {
+    internal::InertializationSoaOffset& offset = context->offsets_[i];
+    const math::SoaTransform& cur = current[i];
+    const math::SoaTransform& prev = previous[i];
+    const math::SoaTransform& tgt = target[i];
+
+    // Translation offset and velocity along offset direction.
+    {
+      const math::SimdFloat4 x0 = Decompose(cur.translation - tgt.translation,
+                                            &offset.translation_direction);
+      const math::SimdFloat4 x_1 = Dot(prev.translation - tgt.translation,
+                                       offset.translation_direction);
+      offset.translation =
+          ComputeDecay(x0, (x0 - x_1) * rcp_dt, simd_duration);
+    }
+
+    // Rotation offset and velocity around offset axis.
+    {
+      const math::SimdFloat4 x0 = Decompose(
+          RotationOffset(cur.rotation, tgt.rotation), &offset.rotation_axis);
+      const math::SimdFloat4 x_1 = Dot(
+          RotationOffset(prev.rotation, tgt.rotation), offset.rotation_axis);
+      offset.rotation = ComputeDecay(x0, (x0 - x_1) * rcp_dt, simd_duration);
+    }
+
+    // Scale offset and velocity along offset direction.
+    {
+      const math::SimdFloat4 x0 =
+          Decompose(cur.scale - tgt.scale, &offset.scale_direction);
+      const math::SimdFloat4 x_1 =
+          Dot(prev.scale - tgt.scale, offset.scale_direction);
+      offset.scale = ComputeDecay(x0, (x0 - x_1) * rcp_dt, simd_duration);
+    }
+  }
+
+  context->num_soa_joints_ = static_cast<int>(current.size());
+
+  return true;
+}
+
+InertializationJob::Context::Context()
+    : max_soa_joints_(0), num_soa_joints_(0), offsets_(nullptr) {}
+
+InertializationJob::Context::Context(int _max_joints)
+    : max_soa_joints_(0), num_soa_joints_(0), offsets_(nullptr) {
+  Resize(_max_joints);
+}
+
+InertializationJob::Context::~Context() {
+  memory::default_allocator()->Deallocate(offsets_);
+}
+
+void InertializationJob::Context::Resize(int _max_joints) {
+  using internal::InertializationSoaOffset;
+
+  // Reset existing data.
+  Invalidate();
+  memory::default_allocator()->Deallocate(offsets_);
+
+  // Updates maximum supported soa joints.
+  max_soa_joints_ = (_max_joints + 3) / 4;
+
+  offsets_ = reinterpret_cast<InertializationSoaOffset*>(
+      memory::default_allocator()->Allocate(
+          sizeof(InertializationSoaOffset) * max_soa_joints_,
+          alignof(InertializationSoaOffset)));
+}
+
+void InertializationJob::Context::Invalidate() { num_soa_joints_ = 0; }
+}  // namespace animation
+}  // namespace ozz
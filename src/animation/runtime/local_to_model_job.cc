@@ -27,9 +27,13 @@
 
 #include "ozz/animation/runtime/local_to_model_job.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
+#include "ozz/base/maths/float3x4.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_dual_quaternion.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -62,16 +66,505 @@ bool LocalToModelJob::Validate() const {
 
   // Test input and output ranges, implicitly tests for nullptr end pointers.
   valid &= input.size() >= num_soa_joints;
-  valid &= output.size() >= num_joints;
+
+  // A single output kind can be used.
+  const int num_outputs = !output.empty() + !soa_output.empty() +
+                          !affine_output.empty() +
+                          !dual_quaternion_output.empty();
+  valid &= num_outputs <= 1;
+  if (!soa_output.empty()) {
+    valid &= soa_output.size() >= num_soa_joints;
+  } else if (!affine_output.empty()) {
+    valid &= affine_output.size() >= num_joints;
+  } else if (!dual_quaternion_output.empty()) {
+    valid &= dual_quaternion_output.size() >= num_joints;
+  } else {
+    valid &= output.size() >= num_joints;
+  }
+
+  // Dirty mask is optional.
+  valid &= dirty.empty() || dirty.size() >= (num_joints + 7) / 8;
+
+  // Subtrees replace "from" hierarchy. They must be sorted, valid joints.
+  if (!subtrees.empty()) {
+    valid &= from == Skeleton::kNoParent && !from_excluded;
+    int previous = -1;
+    for (const int subtree : subtrees) {
+      valid &= subtree > previous;
+      previous = subtree;
+    }
+    valid &= previous < static_cast<int>(num_joints);
+  }
+
+  // Scratch buffer is optional, otherwise the number of joints of a multiple
+  // LODs skeleton whose hierarchy is partially updated is limited by the stack
+  // allocated buffer size.
+  if (!scratch.empty()) {
+    valid &= scratch.size() >= (num_joints + 7) / 8;
+  } else if (skeleton->num_lods() > 1) {
+    const bool partial =
+        !subtrees.empty() ||
+        (from >= 0 && from < math::Min(to + 1, static_cast<int>(num_joints)));
+    valid &= !partial || num_joints <= LocalToModelJob::kMaxStackJoints;
+  }
+
+  // Skinning matrices output is optional.
+  if (!joint_remaps.empty()) {
+    if (!dual_quaternion_output.empty()) {
+      valid &= inverse_bind_dual_quaternions.size() >= joint_remaps.size();
+      valid &= skinning_dual_quaternions.size() >= joint_remaps.size();
+    } else {
+      valid &= !output.empty();
+      valid &= inverse_bind_poses.size() >= joint_remaps.size();
+      valid &= skinning_matrices.size() >= joint_remaps.size();
+    }
+    int previous = -1;
+    for (const uint16_t remap : joint_remaps) {
+      valid &= remap > previous;
+      previous = remap;
+    }
+    valid &= previous < static_cast<int>(num_joints);
+  }
 
   return valid;
 }
 
+namespace {
+
+// Propagates _parent dirty flag to _joint, and returns true if _joint is dirty.
+// All joints are dirty if no mask is provided.
+inline bool PropagateDirty(const span<uint8_t>& _dirty, int _joint,
+                           int _parent) {
+  if (_dirty.empty()) {
+    return true;
+  }
+  uint8_t& flags = _dirty[_joint / 8];
+  const uint8_t bit = static_cast<uint8_t>(1 << (_joint & 7));
+  if (_parent != Skeleton::kNoParent &&
+      (_dirty[_parent / 8] & (1 << (_parent & 7)))) {
+    flags |= bit;
+  }
+  return (flags & bit) != 0;
+}
+
+// Iterates, in increasing order, the joints updated by a job. Those are either
+// "from" hierarchy (up to "to"), or the union of the job subtrees. Subtrees
+// are sorted, so the ones included in a previous subtree are skipped, and the
+// union is walked in a single ordered pass.
+// With multiple LODs, a subtree range [root, subtree end) also contains joints
+// of other subtrees. Updated joints are flagged in job scratch bitset (or a
+// stack allocated one), so that the ones whose parent isn't updated (and that
+// aren't subtree roots) are skipped.
+class JointIterator {
+ public:
+  explicit JointIterator(const LocalToModelJob& _job)
+      : parents_(_job.skeleton->joint_parents()),
+        subtree_ends_(_job.skeleton->joint_subtree_ends()),
+        to_end_(math::Min(_job.to + 1, _job.skeleton->num_joints())),
+        filter_(_job.skeleton->num_lods() > 1),
+        subtree_(_job.subtrees.begin()),
+        subtrees_end_(_job.subtrees.end()),
+        from_(_job.from),
+        end_(0),
+        joint_(0),
+        valid_(false),
+        updated_(_job.scratch.empty() ? stack_updated_ : _job.scratch.data()) {
+    if (filter_) {
+      std::memset(updated_, 0, (_job.skeleton->num_joints() + 7) / 8);
+    }
+    if (subtree_ == subtrees_end_) {
+      if (from_ < 0 || from_ >= to_end_) {
+        // The whole hierarchy (up to "to") is updated, there's nothing to
+        // filter.
+        filter_ = false;
+        joint_ = math::Max(from_ + _job.from_excluded, 0);
+        end_ = to_end_;
+      } else if (_job.from_excluded) {
+        // Starts with "from" children, which are updated from "from".
+        Flag(from_);
+        joint_ = from_ + 1;
+        end_ = math::Min(to_end_, static_cast<int>(subtree_ends_[from_]));
+      } else {
+        // "from" is the single subtree root.
+        subtree_ = &from_;
+        subtrees_end_ = &from_ + 1;
+        joint_ = from_;
+      }
+    } else {
+      joint_ = *subtree_;
+    }
+    Seek();
+  }
+
+  // Returns true while there are joints left to update.
+  bool valid() const { return valid_; }
+
+  // Returns current joint index, only meaningful while valid() is true.
+  int joint() const { return joint_; }
+
+  // Moves to the next updated joint.
+  void Next() {
+    ++joint_;
+    Seek();
+  }
+
+ private:
+  // Moves to the first updated joint from joint_ (included), jumping to the
+  // next subtree root once all current ranges are over.
+  void Seek() {
+    for (;; ++joint_) {
+      if (joint_ >= end_) {
+        if (subtree_ == subtrees_end_ || *subtree_ >= to_end_) {
+          valid_ = false;
+          return;
+        }
+        joint_ = *subtree_;
+      }
+      if (subtree_ < subtrees_end_ && *subtree_ == joint_) {
+        // Subtree root, which can extend the range of joints to iterate.
+        ++subtree_;
+        end_ = math::Max(
+            end_, math::Min(to_end_, static_cast<int>(subtree_ends_[joint_])));
+        break;
+      }
+      if (!filter_ || Flagged(parents_[joint_])) {
+        break;
+      }
+    }
+    if (filter_) {
+      Flag(joint_);
+    }
+    valid_ = true;
+  }
+
+  void Flag(int _joint) {
+    updated_[_joint / 8] |= static_cast<uint8_t>(1 << (_joint & 7));
+  }
+
+  bool Flagged(int _joint) const {
+    return _joint != Skeleton::kNoParent &&
+           (updated_[_joint / 8] & (1 << (_joint & 7))) != 0;
+  }
+
+  const span<const int16_t> parents_;
+  const span<const int16_t> subtree_ends_;
+  const int to_end_;
+  bool filter_;
+  const int* subtree_;
+  const int* subtrees_end_;
+  int from_;
+  int end_;
+  int joint_;
+  bool valid_;
+
+  // Bitset of updated joints, only used when filtering. It's either job
+  // scratch buffer or stack_updated_.
+  uint8_t* updated_;
+  uint8_t stack_updated_[LocalToModelJob::kMaxStackJoints / 8];
+};
+
+// Outputs skinning palette entries of _joint, whose model-space transform is
+// _model. _remap is a cursor in the sorted remap table. It only goes forward
+// as joints are processed in increasing order.
+template <typename _Transform>
+inline void OutputSkinning(const span<const uint16_t>& _remaps,
+                           const uint16_t*& _remap, int _joint,
+                           const _Transform& _model,
+                           const span<const _Transform>& _inverse_binds,
+                           const span<_Transform>& _skinning) {
+  for (const uint16_t* end = _remaps.end(); _remap < end && *_remap <= _joint;
+       ++_remap) {
+    if (*_remap == _joint) {
+      const size_t index = _remap - _remaps.begin();
+      _skinning[index] = _model * _inverse_binds[index];
+    }
+  }
+}
+
+// Returns the first entry of the sorted remap table that can match _joint.
+inline const uint16_t* FirstRemap(const span<const uint16_t>& _remaps,
+                                  int _joint) {
+  return std::lower_bound(_remaps.begin(), _remaps.end(), _joint);
+}
+
+// Stride (in floats) between 2 consecutive elements of a SoaFloat4x4 lane.
+const int kSoaLaneStride = 4;
+
+// Gathers 4 aos matrices into a soa matrix. Each _lanes pointer points to the
+// first element of a matrix stored in a soa lane.
+inline math::SoaFloat4x4 Gather(const float* const _lanes[4]) {
+  math::SoaFloat4x4 ret;
+  math::SimdFloat4* dest = &ret.cols[0].x;
+  for (int i = 0; i < 16; ++i) {
+    const int offset = i * kSoaLaneStride;
+    dest[i] = math::simd_float4::Load(_lanes[0][offset], _lanes[1][offset],
+                                      _lanes[2][offset], _lanes[3][offset]);
+  }
+  return ret;
+}
+
+// Extracts an aos matrix from a soa lane.
+inline math::Float4x4 Extract(const float* _lane) {
+  math::Float4x4 ret;
+  for (int i = 0; i < 4; ++i) {
+    const float* col = _lane + i * 4 * kSoaLaneStride;
+    ret.cols[i] = math::simd_float4::Load(col[0], col[kSoaLaneStride],
+                                          col[2 * kSoaLaneStride],
+                                          col[3 * kSoaLaneStride]);
+  }
+  return ret;
+}
+
+// Converts 4 aos matrices to a soa matrix, the opposite of Transpose16x16.
+inline math::SoaFloat4x4 ToSoa(const math::Float4x4 _in[4]) {
+  math::SoaFloat4x4 ret;
+  for (int i = 0; i < 4; ++i) {
+    const math::SimdFloat4 cols[4] = {_in[0].cols[i], _in[1].cols[i],
+                                      _in[2].cols[i], _in[3].cols[i]};
+    math::Transpose4x4(cols, &ret.cols[i].x);
+  }
+  return ret;
+}
+
+// Stores _value lanes selected by _mask to _dest.
+inline void StoreMasked(const math::SoaFloat4x4& _value,
+                        math::SimdInt4 _mask, math::SoaFloat4x4* _dest) {
+  const math::SimdFloat4* src = &_value.cols[0].x;
+  math::SimdFloat4* dest = &_dest->cols[0].x;
+  for (int i = 0; i < 16; ++i) {
+    dest[i] = math::Select(_mask, src[i], dest[i]);
+  }
+}
+
+// Implements local-to-model conversion for soa output. Soa entries are
+// processed 4 joints at once when no joint of the entry is the parent of
+// another one. Otherwise entry joints are processed one after the other.
+void RunSoa(const LocalToModelJob& _job) {
+  const span<const int16_t>& parents = _job.skeleton->joint_parents();
+  const span<math::SoaFloat4x4>& output = _job.soa_output;
+
+  // Root matrix is stored in soa format, so that it can be gathered like any
+  // other parent.
+  const math::Float4x4 identity = math::Float4x4::identity();
+  const math::Float4x4& root = _job.root ? *_job.root : identity;
+  float root_floats[16];
+  for (int i = 0; i < 4; ++i) {
+    math::StorePtrU(root.cols[i], root_floats + i * 4);
+  }
+  math::SoaFloat4x4 root_soa;
+  for (int i = 0; i < 16; ++i) {
+    (&root_soa.cols[0].x)[i] = math::simd_float4::Load1(root_floats[i]);
+  }
+  const float* root_lane = reinterpret_cast<const float*>(&root_soa);
+
+  for (JointIterator it(_job); it.valid();) {
+    // Finds the joints of this soa entry that need to be processed, and
+    // whether they depend on each other.
+    const int soa_begin = it.joint() & ~3;
+    bool in_range[4] = {false, false, false, false};
+    bool dependent = false;
+    for (const int soa_end = soa_begin + 4; it.valid() && it.joint() < soa_end;
+         it.Next()) {
+      const int i = it.joint();
+      // Parents are always ordered before their children, so in_range is
+      // already known for a parent that belongs to the same soa entry.
+      const int parent = parents[i];
+      if (!PropagateDirty(_job.dirty, i, parent)) {
+        continue;
+      }
+      dependent |= parent >= soa_begin && in_range[parent & 3];
+      in_range[i & 3] = true;
+    }
+    if (!(in_range[0] | in_range[1] | in_range[2] | in_range[3])) {
+      continue;  // Nothing to update in this soa entry.
+    }
+    const math::SimdInt4 mask = math::simd_int4::Load(
+        in_range[0], in_range[1], in_range[2], in_range[3]);
+
+    // Builds soa matrices from soa transforms.
+    const math::SoaTransform& transform = _job.input[soa_begin / 4];
+    const math::SoaFloat4x4 local = math::SoaFloat4x4::FromAffine(
+        transform.translation, transform.rotation, transform.scale);
+    math::SoaFloat4x4& dest = output[soa_begin / 4];
+
+    if (!dependent) {
+      // Gathers parents and concatenates 4 joints at once. Lanes that aren't
+      // processed gather the root, their result is discarded anyway.
+      const float* lanes[4];
+      for (int j = 0; j < 4; ++j) {
+        const int joint = soa_begin + j;
+        const int parent =
+            joint < _job.skeleton->num_joints() ? parents[joint] : -1;
+        lanes[j] = (!in_range[j] || parent == Skeleton::kNoParent)
+                       ? root_lane
+                       : reinterpret_cast<const float*>(&output[parent / 4]) +
+                             (parent & 3);
+      }
+      StoreMasked(Gather(lanes) * local, mask, &dest);
+    } else {
+      // Joints depend on each other, so they're processed in aos format, one
+      // after the other.
+      math::Float4x4 local_aos[4];
+      math::Transpose16x16(&local.cols[0].x, local_aos->cols);
+      math::Float4x4 model_aos[4];
+      for (int j = 0; j < 4; ++j) {
+        if (!in_range[j]) {
+          model_aos[j] = identity;
+          continue;
+        }
+        const int parent = parents[soa_begin + j];
+        if (parent == Skeleton::kNoParent) {
+          model_aos[j] = root * local_aos[j];
+        } else if (parent >= soa_begin && in_range[parent & 3]) {
+          model_aos[j] = model_aos[parent & 3] * local_aos[j];
+        } else {
+          model_aos[j] =
+              Extract(reinterpret_cast<const float*>(&output[parent / 4]) +
+                      (parent & 3)) *
+              local_aos[j];
+        }
+      }
+      StoreMasked(ToSoa(model_aos), mask, &dest);
+    }
+  }
+}
+
+// Implements local-to-model conversion for 3x4 affine output. Local matrices
+// rows are extracted from soa matrices, which is cheaper than converting the
+// whole 4x4 matrices.
+void RunAffine(const LocalToModelJob& _job) {
+  const span<const int16_t>& parents = _job.skeleton->joint_parents();
+  const span<math::Float3x4>& output = _job.affine_output;
+
+  const math::Float3x4 root =
+      _job.root ? math::Float3x4::FromFloat4x4(*_job.root)
+                : math::Float3x4::identity();
+
+  for (JointIterator it(_job); it.valid();) {
+    // Local matrices are built lazily, as the soa entry might not be dirty.
+    const int soa_end = (it.joint() + 4) & ~3;
+    const math::SoaTransform& transform = _job.input[it.joint() / 4];
+    math::SimdFloat4 rows[3][4];
+    bool built = false;
+
+    for (; it.valid() && it.joint() < soa_end; it.Next()) {
+      const int i = it.joint();
+      const int parent = parents[i];
+      if (!PropagateDirty(_job.dirty, i, parent)) {
+        continue;
+      }
+      if (!built) {
+        // Builds soa matrices from soa transforms, and converts the 3 first
+        // rows to aos.
+        const math::SoaFloat4x4 local_soa = math::SoaFloat4x4::FromAffine(
+            transform.translation, transform.rotation, transform.scale);
+        const math::SimdFloat4 xs[4] = {
+            local_soa.cols[0].x, local_soa.cols[1].x, local_soa.cols[2].x,
+            local_soa.cols[3].x};
+        const math::SimdFloat4 ys[4] = {
+            local_soa.cols[0].y, local_soa.cols[1].y, local_soa.cols[2].y,
+            local_soa.cols[3].y};
+        const math::SimdFloat4 zs[4] = {
+            local_soa.cols[0].z, local_soa.cols[1].z, local_soa.cols[2].z,
+            local_soa.cols[3].z};
+        math::Transpose4x4(xs, rows[0]);
+        math::Transpose4x4(ys, rows[1]);
+        math::Transpose4x4(zs, rows[2]);
+        built = true;
+      }
+      const int lane = i & 3;
+      const math::Float3x4 local = {
+          {rows[0][lane], rows[1][lane], rows[2][lane]}};
+      const math::Float3x4& parent_matrix =
+          parent == Skeleton::kNoParent ? root : output[parent];
+      output[i] = parent_matrix * local;
+    }
+  }
+}
+
+// Implements local-to-model conversion for dual quaternion output. Local dual
+// quaternions are built 4 at once in soa format, then concatenated in aos.
+void RunDualQuaternion(const LocalToModelJob& _job) {
+  const span<const int16_t>& parents = _job.skeleton->joint_parents();
+  const span<math::SimdDualQuaternion>& output = _job.dual_quaternion_output;
+
+  math::SimdDualQuaternion root = math::SimdDualQuaternion::identity();
+  if (_job.root) {
+    const math::SimdQuaternion rotation = {math::ToQuaternion(
+        math::Float4x4{{math::Normalize3(_job.root->cols[0]),
+                        math::Normalize3(_job.root->cols[1]),
+                        math::Normalize3(_job.root->cols[2]),
+                        _job.root->cols[3]}})};
+    root = math::SimdDualQuaternion::FromRotationTranslation(
+        rotation, _job.root->cols[3]);
+  }
+
+  JointIterator it(_job);
+  const uint16_t* remap = FirstRemap(_job.joint_remaps, it.joint());
+  while (it.valid()) {
+    // Local dual quaternions are built lazily, as the soa entry might not be
+    // dirty.
+    const int soa_end = (it.joint() + 4) & ~3;
+    const math::SoaTransform& transform = _job.input[it.joint() / 4];
+    math::SimdDualQuaternion locals[4];
+    bool built = false;
+
+    for (; it.valid() && it.joint() < soa_end; it.Next()) {
+      const int i = it.joint();
+      const int parent = parents[i];
+      if (!PropagateDirty(_job.dirty, i, parent)) {
+        continue;
+      }
+      if (!built) {
+        // Dual part is half the translation multiplied by the rotation.
+        const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+        const math::SoaQuaternion translation = {
+            transform.translation.x * half, transform.translation.y * half,
+            transform.translation.z * half, math::simd_float4::zero()};
+        const math::SoaQuaternion dual = translation * transform.rotation;
+        math::SimdFloat4 reals[4];
+        math::SimdFloat4 duals[4];
+        math::Transpose4x4(&transform.rotation.x, reals);
+        math::Transpose4x4(&dual.x, duals);
+        for (int j = 0; j < 4; ++j) {
+          locals[j].real.xyzw = reals[j];
+          locals[j].dual.xyzw = duals[j];
+        }
+        built = true;
+      }
+      const math::SimdDualQuaternion& parent_dq =
+          parent == Skeleton::kNoParent ? root : output[parent];
+      output[i] = parent_dq * locals[i & 3];
+
+      // Outputs skinning dual quaternion if joint is remapped.
+      OutputSkinning(_job.joint_remaps, remap, i, output[i],
+                     _job.inverse_bind_dual_quaternions,
+                     _job.skinning_dual_quaternions);
+    }
+  }
+}
+}  // namespace
+
 bool LocalToModelJob::Run() const {
   if (!Validate()) {
     return false;
   }
 
+  if (!soa_output.empty()) {
+    RunSoa(*this);
+    return true;
+  }
+
+  if (!affine_output.empty()) {
+    RunAffine(*this);
+    return true;
+  }
+
+  if (!dual_quaternion_output.empty()) {
+    RunDualQuaternion(*this);
+    return true;
+  }
+
   const span<const int16_t>& parents = skeleton->joint_parents();
 
   // Initializes an identity matrix that will be used to compute roots model
@@ -79,32 +572,41 @@ bool LocalToModelJob::Run() const {
   const math::Float4x4 identity = math::Float4x4::identity();
   const math::Float4x4* root_matrix = (root == nullptr) ? &identity : root;
 
-  // Applies hierarchical transformation.
-  // Loop ends after "to".
-  const int end = math::Min(to + 1, skeleton->num_joints());
-  // Begins iteration from "from", or the next joint if "from" is excluded.
-  // Process next joint if end is not reach. parents[begin] >= from is true as
-  // long as "begin" is a child of "from".
-  for (int i = math::Max(from + from_excluded, 0),
-           process = i < end && (!from_excluded || parents[i] >= from);
-       process;) {
-    // Builds soa matrices from soa transforms.
-    const math::SoaTransform& transform = input[i / 4];
-    const math::SoaFloat4x4 local_soa_matrices = math::SoaFloat4x4::FromAffine(
-        transform.translation, transform.rotation, transform.scale);
+  // Applies hierarchical transformation, to "from" hierarchy or subtrees.
+  JointIterator it(*this);
+
+  // Skinning matrices remap cursor.
+  const uint16_t* remap = FirstRemap(joint_remaps, it.joint());
 
-    // Converts to aos matrices.
+  while (it.valid()) {
+    // Local matrices are built lazily, as the soa entry might not be dirty.
+    const int soa_end = (it.joint() + 4) & ~3;
+    const math::SoaTransform& transform = input[it.joint() / 4];
     math::Float4x4 local_aos_matrices[4];
-    math::Transpose16x16(&local_soa_matrices.cols[0].x,
-                         local_aos_matrices->cols);
+    bool built = false;
 
-    // parents[i] >= from is true as long as "i" is a child of "from".
-    for (const int soa_end = (i + 4) & ~3; i < soa_end && process;
-         ++i, process = i < end && parents[i] >= from) {
+    for (; it.valid() && it.joint() < soa_end; it.Next()) {
+      const int i = it.joint();
       const int parent = parents[i];
+      if (!PropagateDirty(dirty, i, parent)) {
+        continue;
+      }
+      if (!built) {
+        // Builds soa matrices from soa transforms, and converts to aos.
+        const math::SoaFloat4x4 local_soa_matrices =
+            math::SoaFloat4x4::FromAffine(transform.translation,
+                                          transform.rotation, transform.scale);
+        math::Transpose16x16(&local_soa_matrices.cols[0].x,
+                             local_aos_matrices->cols);
+        built = true;
+      }
       const math::Float4x4* parent_matrix =
           parent == Skeleton::kNoParent ? root_matrix : &output[parent];
       output[i] = *parent_matrix * local_aos_matrices[i & 3];
+
+      // Outputs skinning matrix if joint is remapped.
+      OutputSkinning(joint_remaps, remap, i, output[i], inverse_bind_poses,
+                     skinning_matrices);
     }
   }
   return true;
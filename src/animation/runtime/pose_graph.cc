@@ -0,0 +1,272 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_graph.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+PoseGraph::PoseGraph() : skeleton_(nullptr), output_(-1), num_buffers_(0) {}
+
+PoseGraph::~PoseGraph() {
+  for (Node& node : nodes_) {
+    ozz::Delete(node.context);
+  }
+}
+
+int PoseGraph::AddSamplingNode(const Animation& _animation) {
+  if (compiled()) {
+    return -1;
+  }
+  Node node;
+  node.animation = &_animation;
+  node.context = nullptr;
+  node.ratio = 0.f;
+  node.num_blend_inputs = 0;
+  node.buffer = -1;
+  nodes_.push_back(node);
+  return num_nodes() - 1;
+}
+
+int PoseGraph::AddBlendingNode(const span<const int>& _inputs,
+                               const span<const int>& _additive_inputs) {
+  if (compiled() || (_inputs.empty() && _additive_inputs.empty())) {
+    return -1;
+  }
+
+  // Inputs must be existing nodes, which prevents cycles.
+  Node node;
+  node.animation = nullptr;
+  node.context = nullptr;
+  node.ratio = 0.f;
+  node.num_blend_inputs = static_cast<int>(_inputs.size());
+  node.buffer = -1;
+  node.inputs.reserve(_inputs.size() + _additive_inputs.size());
+  for (const int input : _inputs) {
+    node.inputs.push_back(input);
+  }
+  for (const int input : _additive_inputs) {
+    node.inputs.push_back(input);
+  }
+  for (const int input : node.inputs) {
+    if (input < 0 || input >= num_nodes()) {
+      return -1;
+    }
+  }
+  node.layers.resize(node.inputs.size());
+  nodes_.push_back(node);
+  return num_nodes() - 1;
+}
+
+namespace {
+// Appends _node and its inputs to _order, in depth-first post-order, so that
+// inputs are evaluated right before the nodes that use them.
+template <typename _Nodes>
+void Sort(const _Nodes& _nodes, int _node, ozz::vector<bool>* _visited,
+          ozz::vector<int>* _order) {
+  if ((*_visited)[_node]) {
+    return;
+  }
+  (*_visited)[_node] = true;
+  for (const int input : _nodes[_node].inputs) {
+    Sort(_nodes, input, _visited, _order);
+  }
+  _order->push_back(_node);
+}
+}  // namespace
+
+bool PoseGraph::Compile(const Skeleton& _skeleton, int _output) {
+  if (compiled() || _output < 0 || _output >= num_nodes()) {
+    return false;
+  }
+
+  // Checks animations match the skeleton.
+  for (const Node& node : nodes_) {
+    if (node.animation &&
+        node.animation->num_tracks() != _skeleton.num_joints()) {
+      return false;
+    }
+  }
+
+  // Computes execution order.
+  ozz::vector<bool> visited(nodes_.size(), false);
+  order_.clear();
+  order_.reserve(nodes_.size());
+  Sort(nodes_, _output, &visited, &order_);
+
+  // Computes buffers liveness, as the position in execution order of the last
+  // node that uses each node output. Output node buffer is never released.
+  const int num_steps = static_cast<int>(order_.size());
+  ozz::vector<int> last_use(nodes_.size(), -1);
+  for (int step = 0; step < num_steps; ++step) {
+    for (const int input : nodes_[order_[step]].inputs) {
+      last_use[input] = step;
+    }
+  }
+  last_use[_output] = num_steps;
+
+  // Assigns buffers, reusing released ones. A node's buffer is assigned before
+  // its inputs are released, as a node can't output to its inputs.
+  ozz::vector<int> free_buffers;
+  num_buffers_ = 0;
+  for (int step = 0; step < num_steps; ++step) {
+    Node& node = nodes_[order_[step]];
+    if (free_buffers.empty()) {
+      node.buffer = num_buffers_++;
+    } else {
+      node.buffer = free_buffers.back();
+      free_buffers.pop_back();
+    }
+    for (const int input : node.inputs) {
+      if (last_use[input] == step) {
+        free_buffers.push_back(nodes_[input].buffer);
+        last_use[input] = -1;  // Releases only once.
+      }
+    }
+  }
+
+  // Allocates buffers and sampling contexts.
+  const size_t num_soa_joints = _skeleton.num_soa_joints();
+  buffers_.resize(num_buffers_ * num_soa_joints);
+  for (const int index : order_) {
+    Node& node = nodes_[index];
+    if (node.animation) {
+      node.context =
+          ozz::New<SamplingJob::Context>(node.animation->num_tracks());
+    }
+  }
+
+  // Wires blending layers to their input buffers.
+  for (const int index : order_) {
+    Node& node = nodes_[index];
+    for (size_t i = 0; i < node.inputs.size(); ++i) {
+      const int buffer = nodes_[node.inputs[i]].buffer;
+      node.layers[i].transform = {buffers_.data() + buffer * num_soa_joints,
+                                  num_soa_joints};
+    }
+  }
+
+  skeleton_ = &_skeleton;
+  output_ = _output;
+  return true;
+}
+
+bool PoseGraph::SetRatio(int _node, float _ratio) {
+  if (_node < 0 || _node >= num_nodes() || !nodes_[_node].animation) {
+    return false;
+  }
+  nodes_[_node].ratio = _ratio;
+  return true;
+}
+
+PoseGraph::Node* PoseGraph::GetBlendingNode(int _node) {
+  if (_node < 0 || _node >= num_nodes() || nodes_[_node].animation) {
+    return nullptr;
+  }
+  return &nodes_[_node];
+}
+
+bool PoseGraph::SetWeight(int _node, int _input, float _weight) {
+  Node* node = GetBlendingNode(_node);
+  if (!node || _input < 0 || _input >= static_cast<int>(node->layers.size())) {
+    return false;
+  }
+  node->layers[_input].weight = _weight;
+  return true;
+}
+
+bool PoseGraph::SetJointWeights(
+    int _node, int _input, const span<const math::SimdFloat4>& _joint_weights) {
+  Node* node = GetBlendingNode(_node);
+  if (!node || _input < 0 || _input >= static_cast<int>(node->layers.size())) {
+    return false;
+  }
+  node->layers[_input].joint_weights = _joint_weights;
+  return true;
+}
+
+bool PoseGraph::Evaluate(const span<math::SoaTransform>& _locals,
+                         const span<math::Float4x4>& _models) {
+  if (!compiled()) {
+    return false;
+  }
+  const size_t num_soa_joints = skeleton_->num_soa_joints();
+  if (!_locals.empty() && _locals.size() < num_soa_joints) {
+    return false;
+  }
+
+  bool success = true;
+  span<math::SoaTransform> output;
+  for (const int index : order_) {
+    const Node& node = nodes_[index];
+
+    // Output node writes directly to user buffer if provided.
+    output = {buffers_.data() + node.buffer * num_soa_joints, num_soa_joints};
+    if (index == output_ && !_locals.empty()) {
+      output = _locals;
+    }
+
+    if (node.animation) {
+      SamplingJob sampling_job;
+      sampling_job.animation = node.animation;
+      sampling_job.context = node.context;
+      sampling_job.ratio = node.ratio;
+      sampling_job.output = output;
+      success &= sampling_job.Run();
+    } else {
+      const span<const BlendingJob::Layer> layers = make_span(node.layers);
+      BlendingJob blending_job;
+      blending_job.layers = layers.first(node.num_blend_inputs);
+      blending_job.additive_layers =
+          layers.last(layers.size() - node.num_blend_inputs);
+      blending_job.rest_pose = skeleton_->joint_rest_poses();
+      blending_job.output = output;
+      success &= blending_job.Run();
+    }
+  }
+
+  if (!_models.empty()) {
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = skeleton_;
+    ltm_job.input = output;
+    ltm_job.output = _models;
+    success &= ltm_job.Run();
+  }
+
+  return success;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/root_motion_job.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Rigid transformation (no scale) used to accumulate root motion.
+struct RigidTransform {
+  math::Float3 position;
+  math::Quaternion rotation;
+};
+
+inline RigidTransform Concatenate(const RigidTransform& _a,
+                                  const RigidTransform& _b) {
+  const RigidTransform ret = {
+      _a.position + TransformVector(_a.rotation, _b.position),
+      _a.rotation * _b.rotation};
+  return ret;
+}
+
+inline RigidTransform Invert(const RigidTransform& _t) {
+  const math::Quaternion inv_rotation = Conjugate(_t.rotation);
+  const RigidTransform ret = {-TransformVector(inv_rotation, _t.position),
+                              inv_rotation};
+  return ret;
+}
+
+// Samples root motion tracks at _ratio, which is expected to be in the unit
+// interval [0,1].
+RigidTransform Sample(const RootMotionJob& _job, float _ratio) {
+  RigidTransform ret = {math::Float3::zero(), math::Quaternion::identity()};
+  if (_job.position) {
+    Float3TrackSamplingJob sampling;
+    sampling.track = _job.position;
+    sampling.ratio = _ratio;
+    sampling.result = &ret.position;
+    const bool success = sampling.Run();
+    (void)success;
+    assert(success);
+  }
+  if (_job.rotation) {
+    QuaternionTrackSamplingJob sampling;
+    sampling.track = _job.rotation;
+    sampling.ratio = _ratio;
+    sampling.result = &ret.rotation;
+    const bool success = sampling.Run();
+    (void)success;
+    assert(success);
+  }
+  return ret;
+}
+}  // namespace
+
+RootMotionJob::RootMotionJob()
+    : from(0.f),
+      to(0.f),
+      loop(true),
+      position(nullptr),
+      rotation(nullptr),
+      delta(nullptr) {}
+
+bool RootMotionJob::Validate() const {
+  bool valid = true;
+  valid &= position != nullptr || rotation != nullptr;
+  valid &= delta != nullptr;
+  return valid;
+}
+
+bool RootMotionJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Splits ratios into a number of cycles and a ratio within the cycle.
+  float cycle_from = 0.f, cycle_to = 0.f;
+  float ratio_from = math::Clamp(0.f, from, 1.f);
+  float ratio_to = math::Clamp(0.f, to, 1.f);
+  if (loop) {
+    cycle_from = std::floor(from);
+    cycle_to = std::floor(to);
+    ratio_from = from - cycle_from;
+    ratio_to = to - cycle_to;
+  }
+
+  // Root transforms at "from" and "to" ratios, within their cycle.
+  const RigidTransform transform_from = Sample(*this, ratio_from);
+  const RigidTransform transform_to = Sample(*this, ratio_to);
+
+  // Accumulates whole cycles crossed from "from" to "to". A cycle transforms
+  // the beginning of the animation to its end, which is end * begin^-1.
+  RigidTransform cycles = {math::Float3::zero(), math::Quaternion::identity()};
+  const int num_cycles = static_cast<int>(cycle_to - cycle_from);
+  if (num_cycles != 0) {
+    const RigidTransform cycle =
+        Concatenate(Sample(*this, 1.f), Invert(Sample(*this, 0.f)));
+    const RigidTransform step = num_cycles > 0 ? cycle : Invert(cycle);
+    for (int i = 0, count = std::abs(num_cycles); i < count; ++i) {
+      cycles = Concatenate(cycles, step);
+    }
+  }
+
+  // delta = from^-1 * cycles * to
+  const RigidTransform result =
+      Concatenate(Concatenate(Invert(transform_from), cycles), transform_to);
+
+  delta->translation = result.position;
+  delta->rotation = Normalize(result.rotation);
+  delta->scale = math::Float3::one();
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
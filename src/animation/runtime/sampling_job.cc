@@ -139,6 +139,9 @@ void UpdateCacheCursor(float _ratio, int _num_soa_tracks,
   *_cursor = static_cast<int>(cursor - _keys.begin());
 }
 
+// Decompresses outdated keyframes of the _num_soa_tracks first soa tracks.
+// Following tracks remain flagged as outdated, so that they are decompressed
+// when they are sampled again (while sampling a finer skeleton LOD).
 template <typename _Key, typename _InterpKey, typename _Decompress>
 void UpdateInterpKeyframes(int _num_soa_tracks,
                            const ozz::span<const _Key>& _keys,
@@ -147,8 +150,13 @@ void UpdateInterpKeyframes(int _num_soa_tracks,
                            const _Decompress& _decompress) {
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
-    uint8_t outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    const uint8_t mask =
+        j == num_outdated_flags - 1
+            ? static_cast<uint8_t>(0xff >> (num_outdated_flags * 8 -
+                                            _num_soa_tracks))
+            : 0xff;
+    uint8_t outdated = _outdated[j] & mask;
+    _outdated[j] &= ~mask;  // Reset entries as all will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -311,12 +319,17 @@ bool SamplingJob::Run() const {
   assert(context->max_soa_tracks() >= num_soa_tracks);
   context->Step(*animation, anim_ratio);
 
+  // Only interpolates as much as there are output, which allows to sample a
+  // skeleton LOD. Keyframes of other tracks aren't decompressed.
+  const int num_soa_interp_tracks =
+      math::Min(static_cast<int>(output.size()), num_soa_tracks);
+
   // Fetch key frames from the animation to the context at r = anim_ratio.
   // Then updates outdated soa hot values.
   UpdateCacheCursor(anim_ratio, num_soa_tracks, animation->translations(),
                     &context->translation_cursor_, context->translation_keys_,
                     context->outdated_translations_);
-  UpdateInterpKeyframes(num_soa_tracks, animation->translations(),
+  UpdateInterpKeyframes(num_soa_interp_tracks, animation->translations(),
                         context->translation_keys_,
                         context->outdated_translations_,
                         context->soa_translations_, &DecompressFloat3);
@@ -324,20 +337,17 @@ bool SamplingJob::Run() const {
   UpdateCacheCursor(anim_ratio, num_soa_tracks, animation->rotations(),
                     &context->rotation_cursor_, context->rotation_keys_,
                     context->outdated_rotations_);
-  UpdateInterpKeyframes(num_soa_tracks, animation->rotations(),
+  UpdateInterpKeyframes(num_soa_interp_tracks, animation->rotations(),
                         context->rotation_keys_, context->outdated_rotations_,
                         context->soa_rotations_, &DecompressQuaternion);
 
   UpdateCacheCursor(anim_ratio, num_soa_tracks, animation->scales(),
                     &context->scale_cursor_, context->scale_keys_,
                     context->outdated_scales_);
-  UpdateInterpKeyframes(num_soa_tracks, animation->scales(),
+  UpdateInterpKeyframes(num_soa_interp_tracks, animation->scales(),
                         context->scale_keys_, context->outdated_scales_,
                         context->soa_scales_, &DecompressFloat3);
 
-  // only interp as much as we have output for.
-  const int num_soa_interp_tracks = math::Min(static_cast< int >(output.size()), num_soa_tracks);
-
   // Interpolates soa hot data.
   Interpolates(anim_ratio, num_soa_interp_tracks, context->soa_translations_,
                context->soa_rotations_, context->soa_scales_, output.begin());
@@ -27,6 +27,7 @@
 
 #include "ozz/animation/runtime/skeleton.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "ozz/base/io/archive.h"
@@ -39,6 +40,27 @@
 namespace ozz {
 namespace animation {
 
+namespace {
+// Computes the size of the joint names hash table, the smallest power of 2
+// that is at least twice the number of joints. This keeps the table load
+// factor under 50%, which bounds linear probing sequences length.
+size_t NameTableSize(size_t _num_joints) {
+  size_t size = 1;
+  while (size < _num_joints * 2) {
+    size <<= 1;
+  }
+  return size;
+}
+}  // namespace
+
+uint32_t HashJointName(const char* _name) {
+  uint32_t hash = 2166136261u;
+  for (const char* c = _name; *c; ++c) {
+    hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+  }
+  return hash;
+}
+
 Skeleton::Skeleton() {}
 
 Skeleton::Skeleton(Skeleton&& _other) { *this = std::move(_other); }
@@ -47,17 +69,26 @@ Skeleton& Skeleton::operator=(Skeleton&& _other) {
   std::swap(joint_rest_poses_, _other.joint_rest_poses_);
   std::swap(joint_parents_, _other.joint_parents_);
   std::swap(joint_names_, _other.joint_names_);
+  std::swap(joint_name_hashes_, _other.joint_name_hashes_);
+  std::swap(joint_name_table_, _other.joint_name_table_);
+  std::swap(joint_depths_, _other.joint_depths_);
+  std::swap(joint_subtree_ends_, _other.joint_subtree_ends_);
+  std::swap(joint_first_children_, _other.joint_first_children_);
+  std::swap(joint_next_siblings_, _other.joint_next_siblings_);
+  std::swap(lod_num_joints_, _other.lod_num_joints_);
 
   return *this;
 }
 
 Skeleton::~Skeleton() { Deallocate(); }
 
-char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
+char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints,
+                         size_t _num_lods) {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   static_assert(alignof(math::SoaTransform) >= alignof(char*) &&
-                    alignof(char*) >= alignof(int16_t) &&
+                    alignof(char*) >= alignof(uint32_t) &&
+                    alignof(uint32_t) >= alignof(int16_t) &&
                     alignof(int16_t) >= alignof(char),
                 "Must serve larger alignment values first)");
 
@@ -74,9 +105,16 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   const size_t joint_rest_poses_size =
       num_soa_joints * sizeof(math::SoaTransform);
   const size_t names_size = _num_joints * sizeof(char*);
+  const size_t name_hashes_size = _num_joints * sizeof(uint32_t);
+  const size_t name_table_size = NameTableSize(_num_joints) * sizeof(int16_t);
   const size_t joint_parents_size = _num_joints * sizeof(int16_t);
-  const size_t buffer_size =
-      names_size + _chars_size + joint_parents_size + joint_rest_poses_size;
+  // Depths, subtree ends, first children and next siblings.
+  const size_t hierarchy_size = _num_joints * 4 * sizeof(int16_t);
+  const size_t lods_size = _num_lods * sizeof(int16_t);
+  const size_t buffer_size = names_size + _chars_size + name_hashes_size +
+                             name_table_size + joint_parents_size +
+                             hierarchy_size + lods_size +
+                             joint_rest_poses_size;
 
   // Allocates whole buffer.
   span<byte> buffer = {static_cast<byte*>(memory::default_allocator()->Allocate(
@@ -90,8 +128,17 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   // Then names array, second biggest alignment.
   joint_names_ = fill_span<char*>(buffer, _num_joints);
 
-  // Parents, third biggest alignment.
+  // Name hashes, third biggest alignment.
+  joint_name_hashes_ = fill_span<uint32_t>(buffer, _num_joints);
+
+  // Parents and other int16 arrays, fourth biggest alignment.
   joint_parents_ = fill_span<int16_t>(buffer, _num_joints);
+  joint_name_table_ = fill_span<int16_t>(buffer, NameTableSize(_num_joints));
+  joint_depths_ = fill_span<int16_t>(buffer, _num_joints);
+  joint_subtree_ends_ = fill_span<int16_t>(buffer, _num_joints);
+  joint_first_children_ = fill_span<int16_t>(buffer, _num_joints);
+  joint_next_siblings_ = fill_span<int16_t>(buffer, _num_joints);
+  lod_num_joints_ = fill_span<int16_t>(buffer, _num_lods);
 
   // Remaning buffer will be used to store joint names.
   assert(buffer.size_bytes() == _chars_size &&
@@ -104,7 +151,65 @@ void Skeleton::Deallocate() {
       as_writable_bytes(joint_rest_poses_).data());
   joint_rest_poses_ = {};
   joint_names_ = {};
+  joint_name_hashes_ = {};
+  joint_name_table_ = {};
   joint_parents_ = {};
+  joint_depths_ = {};
+  joint_subtree_ends_ = {};
+  joint_first_children_ = {};
+  joint_next_siblings_ = {};
+  lod_num_joints_ = {};
+}
+
+void Skeleton::BuildHierarchy() {
+  const int num_joints = this->num_joints();
+
+  // Computes depths, and initializes subtree ends as if joints were leaves.
+  // Parents are always stored before their children, so parent depth is
+  // already known.
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = joint_parents_[i];
+    const int depth = parent == kNoParent ? 0 : joint_depths_[parent] + 1;
+    joint_depths_[i] = static_cast<int16_t>(depth);
+    joint_subtree_ends_[i] = static_cast<int16_t>(i + 1);
+    joint_first_children_[i] = kNoParent;
+  }
+
+  // Computes subtree ends and children lists backward, so that children subtree
+  // ends are known before their parent's. Children are pushed in front of their
+  // parent list, which keeps lists in increasing order. This doesn't rely on
+  // depth-first order, which isn't guaranteed across LODs.
+  int first_root = kNoParent;
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = joint_parents_[i];
+    if (parent != kNoParent) {
+      joint_subtree_ends_[parent] =
+          math::Max(joint_subtree_ends_[parent], joint_subtree_ends_[i]);
+      joint_next_siblings_[i] = joint_first_children_[parent];
+      joint_first_children_[parent] = static_cast<int16_t>(i);
+    } else {
+      joint_next_siblings_[i] = static_cast<int16_t>(first_root);
+      first_root = i;
+    }
+  }
+}
+
+void Skeleton::BuildNameTable() {
+  std::fill(joint_name_table_.begin(), joint_name_table_.end(),
+            int16_t(kNoParent));
+  const size_t mask = joint_name_table_.size() - 1;
+  for (int i = 0; i < num_joints(); ++i) {
+    const uint32_t hash = HashJointName(joint_names_[i]);
+    joint_name_hashes_[i] = hash;
+
+    // Joints are inserted in increasing order, so the first of joints sharing
+    // the same name is found first.
+    size_t slot = hash & mask;
+    while (joint_name_table_[slot] != kNoParent) {
+      slot = (slot + 1) & mask;
+    }
+    joint_name_table_[slot] = static_cast<int16_t>(i);
+  }
 }
 
 void Skeleton::Save(ozz::io::OArchive& _archive) const {
@@ -123,16 +228,31 @@ void Skeleton::Save(ozz::io::OArchive& _archive) const {
     chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
   }
   _archive << static_cast<int32_t>(chars_count);
+  // Number of LODs is required to allocate the skeleton, since version 3.
+  _archive << static_cast<int32_t>(num_lods());
   _archive << ozz::io::MakeArray(joint_names_[0], chars_count);
   _archive << ozz::io::MakeArray(joint_parents_);
   _archive << ozz::io::MakeArray(joint_rest_poses_);
+
+  // Hierarchy metadata, names hash table and LODs joint counts, since version
+  // 3.
+  _archive << ozz::io::MakeArray(joint_depths_);
+  _archive << ozz::io::MakeArray(joint_subtree_ends_);
+  _archive << ozz::io::MakeArray(joint_first_children_);
+  _archive << ozz::io::MakeArray(joint_next_siblings_);
+  _archive << ozz::io::MakeArray(joint_name_hashes_);
+  _archive << ozz::io::MakeArray(joint_name_table_);
+  _archive << ozz::io::MakeArray(lod_num_joints_);
 }
 
 void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   // Deallocate skeleton in case it was already used before.
   Deallocate();
 
-  if (_version != 2) {
+  // Versions 2 and 3 are supported. Version 2 hierarchy metadata and names
+  // hash table are rebuilt at load time, and version 2 skeletons have a single
+  // LOD.
+  if (_version < 2 || _version > 3) {
     log::Err() << "Unsupported Skeleton version " << _version << "."
                << std::endl;
     return;
@@ -150,8 +270,14 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   int32_t chars_count;
   _archive >> chars_count;
 
+  // Skeletons prior to version 3 have a single LOD.
+  int32_t num_lods = 1;
+  if (_version >= 3) {
+    _archive >> num_lods;
+  }
+
   // Allocates all skeleton data members.
-  char* cursor = Allocate(chars_count, num_joints);
+  char* cursor = Allocate(chars_count, num_joints, num_lods);
 
   // Reads name's buffer, they are all contiguous in the same buffer.
   _archive >> ozz::io::MakeArray(cursor, chars_count);
@@ -167,6 +293,20 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 
   _archive >> ozz::io::MakeArray(joint_parents_);
   _archive >> ozz::io::MakeArray(joint_rest_poses_);
+
+  if (_version >= 3) {
+    _archive >> ozz::io::MakeArray(joint_depths_);
+    _archive >> ozz::io::MakeArray(joint_subtree_ends_);
+    _archive >> ozz::io::MakeArray(joint_first_children_);
+    _archive >> ozz::io::MakeArray(joint_next_siblings_);
+    _archive >> ozz::io::MakeArray(joint_name_hashes_);
+    _archive >> ozz::io::MakeArray(joint_name_table_);
+    _archive >> ozz::io::MakeArray(lod_num_joints_);
+  } else {
+    BuildHierarchy();
+    BuildNameTable();
+    lod_num_joints_[0] = static_cast<int16_t>(num_joints);
+  }
 }
 }  // namespace animation
 }  // namespace ozz
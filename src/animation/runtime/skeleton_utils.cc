@@ -37,13 +37,29 @@ namespace ozz {
 namespace animation {
 
 int FindJoint(const Skeleton& _skeleton, const char* _name) {
+  return FindJoint(_skeleton, _name, HashJointName(_name));
+}
+
+int FindJoint(const Skeleton& _skeleton, const char* _name, uint32_t _hash) {
+  const span<const int16_t>& table = _skeleton.joint_name_table();
+  if (table.empty()) {
+    return -1;
+  }
+
+  // Probes the table from _hash slot, until an empty slot is found. Names are
+  // only compared when hashes match.
+  const span<const uint32_t>& hashes = _skeleton.joint_name_hashes();
   const auto& names = _skeleton.joint_names();
-  for (size_t i = 0; i < names.size(); ++i) {
-    if (std::strcmp(names[i], _name) == 0) {
-      return static_cast<int>(i);
+  const size_t mask = table.size() - 1;
+  for (size_t slot = _hash & mask;; slot = (slot + 1) & mask) {
+    const int joint = table[slot];
+    if (joint == Skeleton::kNoParent) {
+      return -1;
+    }
+    if (hashes[joint] == _hash && std::strcmp(names[joint], _name) == 0) {
+      return joint;
     }
   }
-  return -1;
 }
 
 // Unpacks skeleton rest pose stored in soa format by the skeleton.
@@ -72,5 +88,39 @@ ozz::math::Transform GetJointLocalRestPose(const Skeleton& _skeleton,
 
   return rest_pose;
 }
+
+size_t ComputeSubtreeMask(const Skeleton& _skeleton, int _root, float _weight,
+                          const span<uint16_t>& _soa_indices,
+                          const span<math::SimdFloat4>& _joint_weights) {
+  if (_root < 0 || _root >= _skeleton.num_joints()) {
+    return 0;
+  }
+
+  // Depth-first order guarantees subtree joints are in range [_root, last],
+  // which can also contain joints of other subtrees with multiple LODs.
+  const int last = _skeleton.joint_subtree_ends()[_root] - 1;
+  const int first_soa = _root / 4;
+  const int last_soa = last / 4;
+  const size_t count = static_cast<size_t>(last_soa - first_soa + 1);
+  if (_soa_indices.size() < count || _joint_weights.size() < count) {
+    return 0;
+  }
+
+  // Clears the range, then sets weights of subtree joints only.
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  for (size_t i = 0; i < count; ++i) {
+    _soa_indices[i] = static_cast<uint16_t>(first_soa + i);
+    _joint_weights[i] = zero;
+  }
+  float* weights = reinterpret_cast<float*>(_joint_weights.data());
+  const int first_joint = first_soa * 4;
+  IterateJointsDF(
+      _skeleton,
+      [weights, first_joint, _weight](int _joint, int) {
+        weights[_joint - first_joint] = _weight;
+      },
+      _root);
+  return count;
+}
 }  // namespace animation
 }  // namespace ozz
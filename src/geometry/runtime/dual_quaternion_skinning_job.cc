@@ -0,0 +1,315 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_dual_quaternion.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace geometry {
+
+DualQuaternionSkinningJob::DualQuaternionSkinningJob()
+    : vertex_count(0),
+      influences_count(0),
+      joint_indices_stride(0),
+      joint_weights_stride(0),
+      in_positions_stride(0),
+      in_normals_stride(0),
+      in_tangents_stride(0),
+      out_positions_stride(0),
+      out_normals_stride(0),
+      out_tangents_stride(0) {}
+
+bool DualQuaternionSkinningJob::Validate() const {
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks joints dual quaternions, required.
+  valid &= !joint_dual_quaternions.empty();
+
+  // Checks optional scale matrices, which are indexed like dual quaternions.
+  valid &= joint_scale_matrices.empty() ||
+           joint_scale_matrices.size() >= joint_dual_quaternions.size();
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks indices, required.
+  valid &= joint_indices.size_bytes() >=
+           joint_indices_stride * vertex_count_minus_1 +
+               sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count != 1) {
+    valid &=
+        joint_weights.size_bytes() >=
+        joint_weights_stride * vertex_count_minus_1 +
+            sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.size_bytes() >=
+           in_positions_stride * vertex_count_minus_1 +
+               sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= !out_positions.empty();
+  valid &= out_positions.size_bytes() >=
+           out_positions_stride * vertex_count_minus_1 +
+               sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals, optional.
+  if (!in_normals.empty()) {
+    valid &= in_normals.size_bytes() >=
+             in_normals_stride * vertex_count_minus_1 +
+                 sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= !out_normals.empty();
+    valid &= out_normals.size_bytes() >=
+             out_normals_stride * vertex_count_minus_1 +
+                 sizeof(float) * 3 * vertex_count_at_least_1;
+
+    // Checks tangents, optional but requires normals.
+    if (!in_tangents.empty()) {
+      valid &= in_tangents.size_bytes() >=
+               in_tangents_stride * vertex_count_minus_1 +
+                   sizeof(float) * 3 * vertex_count_at_least_1;
+      valid &= !out_tangents.empty();
+      valid &= out_tangents.size_bytes() >=
+               out_tangents_stride * vertex_count_minus_1 +
+                   sizeof(float) * 3 * vertex_count_at_least_1;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.empty();
+  }
+
+  return valid;
+}
+
+// Like SkinningJob, every skinning variant (number of influences, transformed
+// vectors, scale) is implemented as a separate specialized function. Variants
+// are instantiated from templates, where a number of influences of 0 means
+// that it's only known at runtime.
+namespace {
+
+// Iterates vertices input and output buffers.
+struct DualQuaternionVertexCursor {
+  explicit DualQuaternionVertexCursor(const DualQuaternionSkinningJob& _job)
+      : joint_indices(_job.joint_indices.begin()),
+        joint_weights(_job.joint_weights.begin()),
+        in_positions(_job.in_positions.begin()),
+        in_normals(_job.in_normals.begin()),
+        in_tangents(_job.in_tangents.begin()),
+        out_positions(_job.out_positions.begin()),
+        out_normals(_job.out_normals.begin()),
+        out_tangents(_job.out_tangents.begin()) {}
+
+  // Moves to next vertex. Only _Vectors first vectors are iterated.
+  template <int _Vectors>
+  OZZ_INLINE void Next(const DualQuaternionSkinningJob& _job) {
+    joint_indices = PointerStride(joint_indices, _job.joint_indices_stride);
+    joint_weights = PointerStride(joint_weights, _job.joint_weights_stride);
+    in_positions = PointerStride(in_positions, _job.in_positions_stride);
+    out_positions = PointerStride(out_positions, _job.out_positions_stride);
+    if (_Vectors > 0) {
+      in_normals = PointerStride(in_normals, _job.in_normals_stride);
+      out_normals = PointerStride(out_normals, _job.out_normals_stride);
+    }
+    if (_Vectors > 1) {
+      in_tangents = PointerStride(in_tangents, _job.in_tangents_stride);
+      out_tangents = PointerStride(out_tangents, _job.out_tangents_stride);
+    }
+  }
+
+  const uint16_t* joint_indices;
+  const float* joint_weights;
+  const float* in_positions;
+  const float* in_normals;
+  const float* in_tangents;
+  float* out_positions;
+  float* out_normals;
+  float* out_tangents;
+};
+
+// Blends vertex influences dual quaternions, and scale matrices if _Scale is
+// true. Returned dual quaternion is normalized.
+template <int _Inf, bool _Scale>
+OZZ_INLINE math::SimdDualQuaternion BlendDualQuaternions(
+    const DualQuaternionSkinningJob& _job, const uint16_t* _indices,
+    const float* _weights, math::Float4x4* _scale) {
+  const math::SimdDualQuaternion* dqs = _job.joint_dual_quaternions.begin();
+  const math::Float4x4* scales = _job.joint_scale_matrices.begin();
+  const int last = (_Inf != 0 ? _Inf : _job.influences_count) - 1;
+
+  // Single influence, there's nothing to blend.
+  const uint16_t i0 = _indices[0];
+  const math::SimdDualQuaternion& dq0 = dqs[i0];
+  if (last == 0) {
+    if (_Scale) {
+      *_scale = scales[i0];
+    }
+    return dq0;
+  }
+
+  // Dual quaternions dq and -dq represent the same transformation. Every
+  // influence is blended in the same hemisphere as the first one, by negating
+  // its weight when needed.
+  const math::SimdInt4 sign = math::simd_int4::mask_sign();
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(_weights);
+  math::SimdDualQuaternion blended = dq0 * wsum;
+  if (_Scale) {
+    *_scale = math::ColumnMultiply(scales[i0], wsum);
+  }
+  for (int i = 1; i <= last; ++i) {
+    math::SimdFloat4 w;
+    if (i < last) {
+      w = math::simd_float4::Load1PtrU(_weights + i);
+      wsum = wsum + w;
+    } else {
+      w = math::simd_float4::one() - wsum;
+    }
+    const uint16_t index = _indices[i];
+    const math::SimdDualQuaternion& dq = dqs[index];
+    const math::SimdFloat4 dot =
+        math::SplatX(math::Dot4(dq0.real.xyzw, dq.real.xyzw));
+    blended = blended + dq * math::Xor(w, math::And(dot, sign));
+    if (_Scale) {
+      *_scale = *_scale + math::ColumnMultiply(scales[index], w);
+    }
+  }
+
+  const math::SimdFloat4 len2 =
+      math::SplatX(math::Dot4(blended.real.xyzw, blended.real.xyzw));
+  return blended * math::RSqrtEstNR(len2);
+}
+
+// Skins a single vertex. _Last must be true for the last vertex, so that input
+// buffers aren't read beyond the vertex.
+template <int _Inf, int _Vectors, bool _Scale, bool _Last>
+OZZ_INLINE void SkinDualQuaternionVertex(
+    const DualQuaternionSkinningJob& _job,
+    const DualQuaternionVertexCursor& _cursor) {
+  math::Float4x4 scale;
+  const math::SimdDualQuaternion dq = BlendDualQuaternions<_Inf, _Scale>(
+      _job, _cursor.joint_indices, _cursor.joint_weights, &scale);
+
+  // Translation is shared by position.
+  const math::SimdFloat4 translation = math::GetTranslation(dq);
+
+  math::SimdFloat4 in_p =
+      _Last ? math::simd_float4::Load3PtrU(_cursor.in_positions)
+            : math::simd_float4::LoadPtrU(_cursor.in_positions);
+  if (_Scale) {
+    in_p = TransformPoint(scale, in_p);
+  }
+  const math::SimdFloat4 out_p = TransformVector(dq.real, in_p) + translation;
+  math::Store3PtrU(out_p, _cursor.out_positions);
+
+  if (_Vectors > 0) {
+    math::SimdFloat4 in_n =
+        _Last ? math::simd_float4::Load3PtrU(_cursor.in_normals)
+              : math::simd_float4::LoadPtrU(_cursor.in_normals);
+    if (_Scale) {
+      in_n = TransformVector(scale, in_n);
+    }
+    math::Store3PtrU(TransformVector(dq.real, in_n), _cursor.out_normals);
+  }
+  if (_Vectors > 1) {
+    math::SimdFloat4 in_t =
+        _Last ? math::simd_float4::Load3PtrU(_cursor.in_tangents)
+              : math::simd_float4::LoadPtrU(_cursor.in_tangents);
+    if (_Scale) {
+      in_t = TransformVector(scale, in_t);
+    }
+    math::Store3PtrU(TransformVector(dq.real, in_t), _cursor.out_tangents);
+  }
+}
+
+template <int _Inf, int _Vectors, bool _Scale>
+void SkinDualQuaternions(const DualQuaternionSkinningJob& _job) {
+  assert(_job.vertex_count > 0);
+  DualQuaternionVertexCursor cursor(_job);
+  const int loops = _job.vertex_count - 1;
+  for (int i = 0; i < loops; ++i) {
+    SkinDualQuaternionVertex<_Inf, _Vectors, _Scale, false>(_job, cursor);
+    cursor.Next<_Vectors>(_job);
+  }
+  SkinDualQuaternionVertex<_Inf, _Vectors, _Scale, true>(_job, cursor);
+}
+
+// Defines a matrix of skinning function pointers, indexed by number of
+// influences (1 to 4, and N) and transformed vectors.
+typedef void (*DualQuaternionSkinningFct)(const DualQuaternionSkinningJob&);
+template <bool _Scale>
+struct DualQuaternionSkinningFcts {
+  static const DualQuaternionSkinningFct kFct[5][3];
+};
+
+template <bool _Scale>
+const DualQuaternionSkinningFct DualQuaternionSkinningFcts<_Scale>::kFct[5][3] =
+    {{&SkinDualQuaternions<1, 0, _Scale>, &SkinDualQuaternions<1, 1, _Scale>,
+      &SkinDualQuaternions<1, 2, _Scale>},
+     {&SkinDualQuaternions<2, 0, _Scale>, &SkinDualQuaternions<2, 1, _Scale>,
+      &SkinDualQuaternions<2, 2, _Scale>},
+     {&SkinDualQuaternions<3, 0, _Scale>, &SkinDualQuaternions<3, 1, _Scale>,
+      &SkinDualQuaternions<3, 2, _Scale>},
+     {&SkinDualQuaternions<4, 0, _Scale>, &SkinDualQuaternions<4, 1, _Scale>,
+      &SkinDualQuaternions<4, 2, _Scale>},
+     {&SkinDualQuaternions<0, 0, _Scale>, &SkinDualQuaternions<0, 1, _Scale>,
+      &SkinDualQuaternions<0, 2, _Scale>}};
+}  // namespace
+
+bool DualQuaternionSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  if (vertex_count == 0) {
+    return true;
+  }
+
+  // Find skinning function index.
+  const DualQuaternionSkinningFct(*kSkinningFct)[3] =
+      joint_scale_matrices.empty() ? DualQuaternionSkinningFcts<false>::kFct
+                                   : DualQuaternionSkinningFcts<true>::kFct;
+  const size_t inf = influences_count > 4 ? 4 : influences_count - 1;
+  const size_t fct = !in_normals.empty() + !in_tangents.empty();
+
+  // Calls skinning function. Cannot fail because job is valid.
+  kSkinningFct[inf][fct](*this);
+
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include <cstring>
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace geometry {
+
+MorphJob::Target::Target()
+    : weight(0.f), position_scale(1.f), normal_scale(1.f) {}
+
+MorphJob::MorphJob()
+    : vertex_count(0),
+      min_weight(0.f),
+      in_positions_stride(0),
+      in_normals_stride(0),
+      out_positions_stride(0),
+      out_normals_stride(0) {}
+
+bool MorphJob::Validate() const {
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks vertex count and weight threshold.
+  valid &= vertex_count >= 0;
+  valid &= min_weight >= 0.f;
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks positions, mandatory.
+  valid &= in_positions.size_bytes() >=
+           in_positions_stride * vertex_count_minus_1 +
+               sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= !out_positions.empty();
+  valid &= out_positions.size_bytes() >=
+           out_positions_stride * vertex_count_minus_1 +
+               sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals, optional.
+  const bool normals = !in_normals.empty();
+  if (normals) {
+    valid &= in_normals.size_bytes() >=
+             in_normals_stride * vertex_count_minus_1 +
+                 sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= !out_normals.empty();
+    valid &= out_normals.size_bytes() >=
+             out_normals_stride * vertex_count_minus_1 +
+                 sizeof(float) * 3 * vertex_count_at_least_1;
+  }
+
+  // Morphing in place requires the same stride for input and output.
+  if (in_positions.begin() == out_positions.begin()) {
+    valid &= in_positions_stride == out_positions_stride;
+  }
+  if (normals && in_normals.begin() == out_normals.begin()) {
+    valid &= in_normals_stride == out_normals_stride;
+  }
+
+  // Checks targets. Every index is checked against vertex count, as an invalid
+  // index would write outside of output buffers.
+  for (const Target& target : targets) {
+    const size_t count = target.indices.size();
+    if (count == 0) {
+      continue;
+    }
+    int previous = 0;
+    for (const uint16_t index : target.indices) {
+      valid &= index >= previous;
+      previous = index;
+    }
+    valid &= previous < vertex_count;
+    valid &= target.position_deltas.size() >= count * 3;
+    if (normals && !target.normal_deltas.empty()) {
+      valid &= target.normal_deltas.size() >= count * 3;
+    }
+  }
+
+  return valid;
+}
+
+namespace {
+// Copies _count vertices (3 floats each) from _in to _out, unless they are the
+// same buffer (strides are validated to be equal in this case).
+void CopyMorphVertices(const float* _in, size_t _in_stride, float* _out,
+                       size_t _out_stride, int _count) {
+  if (_in == _out) {
+    return;
+  }
+  if (_in_stride == sizeof(float) * 3 && _out_stride == _in_stride) {
+    std::memcpy(_out, _in, _in_stride * _count);
+    return;
+  }
+  for (int i = 0; i < _count; ++i) {
+    std::memcpy(_out, _in, sizeof(float) * 3);
+    _in = PointerStride(_in, _in_stride);
+    _out = PointerStride(_out, _out_stride);
+  }
+}
+
+// Accumulates _deltas, scaled by _scale, to _out vertices referenced by
+// _indices. A SIMD register holds the 3 components of a delta.
+template <typename _Delta>
+void AccumulateMorphDeltas(const span<const uint16_t>& _indices,
+                           const _Delta* _deltas, float _scale, float* _out,
+                           size_t _out_stride) {
+  const math::SimdFloat4 scale = math::simd_float4::Load1(_scale);
+  const uint16_t* indices = _indices.begin();
+  const size_t count = _indices.size();
+  for (size_t i = 0; i < count; ++i, _deltas += 3) {
+    float* out = PointerStride(_out, _out_stride * indices[i]);
+    const math::SimdFloat4 delta = math::simd_float4::FromInt(
+        math::simd_int4::Load(_deltas[0], _deltas[1], _deltas[2], 0));
+    math::Store3PtrU(
+        math::MAdd(delta, scale, math::simd_float4::Load3PtrU(out)), out);
+  }
+}
+}  // namespace
+
+bool MorphJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  if (vertex_count == 0) {
+    return true;
+  }
+
+  // Base vertices are copied to the output first.
+  const bool normals = !in_normals.empty();
+  CopyMorphVertices(in_positions.begin(), in_positions_stride,
+                    out_positions.begin(), out_positions_stride, vertex_count);
+  if (normals) {
+    CopyMorphVertices(in_normals.begin(), in_normals_stride,
+                      out_normals.begin(), out_normals_stride, vertex_count);
+  }
+
+  // Then deltas of every significant target are accumulated.
+  for (const Target& target : targets) {
+    const float weight = target.weight;
+    if (!(weight > min_weight || weight < -min_weight)) {
+      continue;
+    }
+    AccumulateMorphDeltas(target.indices, target.position_deltas.begin(),
+                          weight * target.position_scale,
+                          out_positions.begin(), out_positions_stride);
+    if (normals && !target.normal_deltas.empty()) {
+      AccumulateMorphDeltas(target.indices, target.normal_deltas.begin(),
+                            weight * target.normal_scale, out_normals.begin(),
+                            out_normals_stride);
+    }
+  }
+
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
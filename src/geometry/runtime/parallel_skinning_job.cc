@@ -0,0 +1,220 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/float3x4.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace geometry {
+
+namespace {
+// Computes the number of vertices after which a stream of _stride bytes
+// elements starts again at the beginning of a cache line.
+template <typename _Type>
+int CacheLineVertices(const span<_Type>& _span, size_t _stride) {
+  if (_span.empty() || _stride == 0) {
+    return 1;
+  }
+  size_t gcd = kSkinningCacheLineSize;
+  for (size_t b = _stride; b != 0;) {
+    const size_t r = gcd % b;
+    gcd = b;
+    b = r;
+  }
+  return static_cast<int>(kSkinningCacheLineSize / gcd);
+}
+
+// Describes the partitioning of a job in ranges of aligned vertices.
+struct SkinningPartition {
+  SkinningPartition(const SkinningJob& _job, int _min_range_vertices,
+                    int _max_ranges)
+      : vertex_count(_job.vertex_count),
+        alignment(GetSkinningRangeAlignment(_job)),
+        units((vertex_count + alignment - 1) / alignment),
+        count(0) {
+    if (vertex_count <= 0 || _max_ranges <= 0) {
+      return;
+    }
+    const int min_units =
+        math::Max(1, (_min_range_vertices + alignment - 1) / alignment);
+    count = math::Clamp(1, units / min_units, _max_ranges);
+  }
+
+  // Returns the first vertex of range _index, _index being in [0, count].
+  int Begin(int _index) const {
+    assert(_index >= 0 && _index <= count);
+    const int begin =
+        (_index * (units / count) + math::Min(_index, units % count)) *
+        alignment;
+    return math::Min(begin, vertex_count);
+  }
+
+  int vertex_count;
+  int alignment;
+  int units;
+  int count;
+};
+
+// Context shared by all tasks of a ParallelSkinningJob.
+struct SkinningTaskContext {
+  SkinningTaskContext(const SkinningJob& _job,
+                      const SkinningPartition& _partition)
+      : job(_job), partition(_partition) {}
+  const SkinningJob& job;
+  const SkinningPartition& partition;
+};
+
+// Skins the _index-th range of the SkinningTaskContext _context.
+void RunSkinningRange(void* _context, int _index) {
+  const SkinningTaskContext& context =
+      *static_cast<const SkinningTaskContext*>(_context);
+  const int begin = context.partition.Begin(_index);
+  const int end = context.partition.Begin(_index + 1);
+  const bool success =
+      GetSkinningJobRange(context.job, begin, end - begin).Run();
+  (void)success;
+  assert(success);
+}
+
+// Dispatches all _partition ranges of _job to _executor, or runs them
+// sequentially if there's no executor or a single range.
+void DispatchSkinningRanges(const SkinningJob& _job,
+                            const SkinningPartition& _partition,
+                            SkinningTaskExecutor* _executor) {
+  if (_executor == nullptr || _partition.count == 1) {
+    SkinningTaskContext context(_job, _partition);
+    for (int i = 0; i < _partition.count; ++i) {
+      RunSkinningRange(&context, i);
+    }
+  } else {
+    // Concurrent tasks can't share the vertex scratch buffer, they use their
+    // own stack buffers.
+    SkinningJob job = _job;
+    job.vertex_scratch = {};
+    SkinningTaskContext context(job, _partition);
+    _executor->ParallelFor(_partition.count, &RunSkinningRange, &context);
+  }
+}
+
+// Computes remapped skinning matrices once, to a stack allocated palette,
+// before dispatching ranges. It's isolated in this function as the palette
+// requires a significant amount of stack memory (kMaxStackRemappedJoints).
+void DispatchRemappedStack(const SkinningJob& _job,
+                           const SkinningPartition& _partition,
+                           SkinningTaskExecutor* _executor) {
+  math::Float3x4 palette[SkinningJob::kMaxStackRemappedJoints];
+  DispatchSkinningRanges(GetRemappedSkinningJob(_job, palette), _partition,
+                         _executor);
+}
+}  // namespace
+
+int GetSkinningRangeAlignment(const SkinningJob& _job) {
+  // Strides in a cache line are powers of 2, so the biggest is a multiple of
+  // all the others.
+  int alignment =
+      CacheLineVertices(_job.out_positions, _job.out_positions_stride);
+  alignment = math::Max(
+      alignment, CacheLineVertices(_job.out_normals, _job.out_normals_stride));
+  alignment = math::Max(
+      alignment,
+      CacheLineVertices(_job.out_tangents, _job.out_tangents_stride));
+  alignment = math::Max(
+      alignment,
+      CacheLineVertices(_job.out_half_positions, _job.out_positions_stride));
+  alignment = math::Max(
+      alignment,
+      CacheLineVertices(_job.out_half_normals, _job.out_normals_stride));
+  alignment = math::Max(
+      alignment,
+      CacheLineVertices(_job.out_half_tangents, _job.out_tangents_stride));
+  return alignment;
+}
+
+int PartitionSkinningJob(const SkinningJob& _job, int _min_range_vertices,
+                         span<SkinningJob> _ranges) {
+  const SkinningPartition partition(_job, _min_range_vertices,
+                                    static_cast<int>(_ranges.size()));
+  for (int i = 0; i < partition.count; ++i) {
+    const int begin = partition.Begin(i);
+    _ranges[i] =
+        GetSkinningJobRange(_job, begin, partition.Begin(i + 1) - begin);
+    _ranges[i].vertex_scratch = {};
+  }
+  return partition.count;
+}
+
+SkinningTaskExecutor::~SkinningTaskExecutor() {}
+
+ParallelSkinningJob::ParallelSkinningJob()
+    : executor(nullptr), max_tasks(8), min_task_vertices(4096) {}
+
+bool ParallelSkinningJob::Validate() const {
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks skinning job.
+  valid &= job.Validate();
+
+  // Checks partitioning parameters.
+  valid &= max_tasks > 0;
+  valid &= min_task_vertices > 0;
+
+  return valid;
+}
+
+bool ParallelSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  const SkinningPartition partition(job, min_task_vertices, max_tasks);
+  if (partition.count == 0) {
+    return true;
+  }
+
+  // Tasks are dispatched to the executor, unless there's a single one.
+  // Remapped skinning matrices are computed once for all tasks, which then
+  // share the same palette.
+  if (job.joint_remaps.empty()) {
+    DispatchSkinningRanges(job, partition, executor);
+  } else if (job.remap_scratch.empty()) {
+    DispatchRemappedStack(job, partition, executor);
+  } else {
+    DispatchSkinningRanges(GetRemappedSkinningJob(job, job.remap_scratch),
+                           partition, executor);
+  }
+
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
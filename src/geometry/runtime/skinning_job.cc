@@ -29,6 +29,8 @@
 
 #include <cassert>
 
+#include "ozz/base/maths/float3x4.h"
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/simd_math.h"
 
 namespace ozz {
@@ -40,12 +42,31 @@ SkinningJob::SkinningJob()
       joint_indices_stride(0),
       joint_weights_stride(0),
       in_positions_stride(0),
+      positions_scale(1.f),
+      positions_offset(0.f),
       in_normals_stride(0),
       in_tangents_stride(0),
+      quantized_vectors_encoding(kSnorm8),
       out_positions_stride(0),
       out_normals_stride(0),
       out_tangents_stride(0) {}
 
+namespace {
+// Validates an output stream, which must be provided either as float or half.
+bool ValidateOutput(const span<float>& _floats, const span<uint16_t>& _halves,
+                    size_t _stride, int _vertex_count) {
+  if (_floats.empty() == _halves.empty()) {
+    return false;
+  }
+  const size_t size =
+      _floats.empty() ? _halves.size_bytes() : _floats.size_bytes();
+  const size_t element =
+      _floats.empty() ? sizeof(uint16_t) * 3 : sizeof(float) * 3;
+  return _vertex_count <= 0 ||
+         size >= _stride * (_vertex_count - 1) + element;
+}
+}  // namespace
+
 bool SkinningJob::Validate() const {
   // Start validation of all parameters.
   bool valid = true;
@@ -53,8 +74,29 @@ bool SkinningJob::Validate() const {
   // Checks influences bounds.
   valid &= influences_count > 0;
 
-  // Checks joints matrices, required.
-  valid &= !joint_matrices.empty();
+  // Checks joints matrices, required. Either 4x4 or 3x4 affine matrices can be
+  // used, not both.
+  valid &= joint_matrices.empty() != joint_affine_matrices.empty();
+
+  // Checks optional joint remapping.
+  if (!joint_remaps.empty()) {
+    const size_t num_joints =
+        joint_matrices.empty() ? joint_affine_matrices.size()
+                               : joint_matrices.size();
+    for (size_t i = 0; i < joint_remaps.size(); ++i) {
+      valid &= joint_remaps[i] < num_joints;
+    }
+    valid &= joint_inverse_bind_matrices.size() >= joint_remaps.size();
+    if (remap_scratch.empty()) {
+      valid &= joint_remaps.size() <= kMaxStackRemappedJoints;
+    } else {
+      valid &= remap_scratch.size() >= joint_remaps.size();
+    }
+  }
+
+  // Vertex scratch buffer is optional, stack buffers are used otherwise.
+  valid &= vertex_scratch.empty() ||
+           vertex_scratch.size() >= kVertexScratchSize;
 
   // Prepares local variables used to compute buffer size.
   const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
@@ -65,46 +107,78 @@ bool SkinningJob::Validate() const {
            joint_indices_stride * vertex_count_minus_1 +
                sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
 
-  // Checks weights, required if influences_count > 1.
+  // Checks weights, required if influences_count > 1. Either float or
+  // quantized weights can be used, not both.
   if (influences_count != 1) {
-    valid &=
-        joint_weights.size_bytes() >=
-        joint_weights_stride * vertex_count_minus_1 +
-            sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+    if (joint_quantized_weights.empty()) {
+      valid &=
+          joint_weights.size_bytes() >=
+          joint_weights_stride * vertex_count_minus_1 +
+              sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+    } else {
+      valid &= joint_weights.empty();
+      valid &= influences_count <= kMaxQuantizedInfluences;
+      valid &= joint_quantized_weights.size_bytes() >=
+               joint_weights_stride * vertex_count_minus_1 +
+                   sizeof(uint8_t) * (influences_count - 1) *
+                       vertex_count_at_least_1;
+    }
   }
 
-  // Checks positions, mandatory.
-  valid &= in_positions.size_bytes() >=
-           in_positions_stride * vertex_count_minus_1 +
-               sizeof(float) * 3 * vertex_count_at_least_1;
-  valid &= !out_positions.empty();
-  valid &= out_positions.size_bytes() >=
-           out_positions_stride * vertex_count_minus_1 +
-               sizeof(float) * 3 * vertex_count_at_least_1;
+  // Size of a quantized normal or tangent.
+  const size_t quantized_vector_size =
+      sizeof(int8_t) * (quantized_vectors_encoding == kSnorm8 ? 3 : 2);
+  valid &= quantized_vectors_encoding == kSnorm8 ||
+           quantized_vectors_encoding == kOctahedral8;
+
+  // Checks positions, mandatory. Either float or quantized positions can be
+  // used, not both.
+  if (in_quantized_positions.empty()) {
+    valid &= in_positions.size_bytes() >=
+             in_positions_stride * vertex_count_minus_1 +
+                 sizeof(float) * 3 * vertex_count_at_least_1;
+  } else {
+    valid &= in_positions.empty();
+    valid &= in_quantized_positions.size_bytes() >=
+             in_positions_stride * vertex_count_minus_1 +
+                 sizeof(int16_t) * 3 * vertex_count_at_least_1;
+  }
+  valid &= ValidateOutput(out_positions, out_half_positions,
+                          out_positions_stride, vertex_count);
 
   // Checks normals, optional.
-  if (!in_normals.empty()) {
-    valid &= in_normals.size_bytes() >=
-             in_normals_stride * vertex_count_minus_1 +
-                 sizeof(float) * 3 * vertex_count_at_least_1;
-    valid &= !out_normals.empty();
-    valid &= out_normals.size_bytes() >=
-             out_normals_stride * vertex_count_minus_1 +
-                 sizeof(float) * 3 * vertex_count_at_least_1;
+  if (!in_normals.empty() || !in_quantized_normals.empty()) {
+    if (in_quantized_normals.empty()) {
+      valid &= in_normals.size_bytes() >=
+               in_normals_stride * vertex_count_minus_1 +
+                   sizeof(float) * 3 * vertex_count_at_least_1;
+    } else {
+      valid &= in_normals.empty();
+      valid &= in_quantized_normals.size_bytes() >=
+               in_normals_stride * vertex_count_minus_1 +
+                   quantized_vector_size * vertex_count_at_least_1;
+    }
+    valid &= ValidateOutput(out_normals, out_half_normals, out_normals_stride,
+                            vertex_count);
 
     // Checks tangents, optional but requires normals.
-    if (!in_tangents.empty()) {
-      valid &= in_tangents.size_bytes() >=
-               in_tangents_stride * vertex_count_minus_1 +
-                   sizeof(float) * 3 * vertex_count_at_least_1;
-      valid &= !out_tangents.empty();
-      valid &= out_tangents.size_bytes() >=
-               out_tangents_stride * vertex_count_minus_1 +
-                   sizeof(float) * 3 * vertex_count_at_least_1;
+    if (!in_tangents.empty() || !in_quantized_tangents.empty()) {
+      if (in_quantized_tangents.empty()) {
+        valid &= in_tangents.size_bytes() >=
+                 in_tangents_stride * vertex_count_minus_1 +
+                     sizeof(float) * 3 * vertex_count_at_least_1;
+      } else {
+        valid &= in_tangents.empty();
+        valid &= in_quantized_tangents.size_bytes() >=
+                 in_tangents_stride * vertex_count_minus_1 +
+                     quantized_vector_size * vertex_count_at_least_1;
+      }
+      valid &= ValidateOutput(out_tangents, out_half_tangents,
+                              out_tangents_stride, vertex_count);
     }
   } else {
     // Tangents are not supported if normals are not there.
-    valid &= in_tangents.empty();
+    valid &= in_tangents.empty() && in_quantized_tangents.empty();
   }
 
   return valid;
@@ -117,8 +191,37 @@ bool SkinningJob::Validate() const {
 // define a skeleton code (SKINNING_FN) for the skinning loop, which internally
 // calls MACRO that are shared or specialized according to skinning variants.
 
+// Palette matrices type is a template argument, so that 4x4 and 3x4 affine
+// matrices share the same code. Blended palette matrices are converted to 4x4
+// column matrices before transforming vertices.
+namespace {
+// Returns the palette of matrices used by the skinning loop.
+template <typename _Matrix>
+const _Matrix* GetMatrices(const SkinningJob& _job);
+
+template <>
+const math::Float4x4* GetMatrices<math::Float4x4>(const SkinningJob& _job) {
+  return _job.joint_matrices.begin();
+}
+
+template <>
+const math::Float3x4* GetMatrices<math::Float3x4>(const SkinningJob& _job) {
+  return _job.joint_affine_matrices.begin();
+}
+
+// Converts palette matrices to the column matrices used for transformations.
+OZZ_INLINE const math::Float4x4& ToColumns(const math::Float4x4& _m) {
+  return _m;
+}
+
+OZZ_INLINE math::Float4x4 ToColumns(const math::Float3x4& _m) {
+  return math::ToFloat4x4(_m);
+}
+}  // namespace
+
 // Defines the skeleton code for the per vertex skinning loop.
 #define SKINNING_FN(_type, _it, _inf)                                        \
+  template <typename _Matrix>                                                \
   void SKINNING_FN_NAME(_type, _it, _inf)(const SkinningJob& _job) {         \
     ASSERT_##_type() ASSERT_##_it() INIT_##_type() INIT_W##_inf()            \
         const int loops = _job.vertex_count - 1;                             \
@@ -151,6 +254,7 @@ bool SkinningJob::Validate() const {
 
 // Implements loop initializations for positions, ...
 #define INIT_P()                                              \
+  const _Matrix* matrices = GetMatrices<_Matrix>(_job);       \
   const uint16_t* joint_indices = _job.joint_indices.begin(); \
   const float* in_positions = _job.in_positions.begin();      \
   float* out_positions = _job.out_positions.begin();
@@ -219,7 +323,7 @@ bool SkinningJob::Validate() const {
 // the buffer.
 #define PREPARE_1_INNER(_it)                                 \
   const uint16_t i0 = joint_indices[0];                      \
-  const math::Float4x4& transform = _job.joint_matrices[i0]; \
+  const math::Float4x4& transform = ToColumns(matrices[i0]); \
   PREPARE_##_it##_1()
 
 #define PREPARE_1_OUTER(_it) PREPARE_1_INNER(_it)
@@ -238,11 +342,12 @@ bool SkinningJob::Validate() const {
   const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
   const uint16_t i0 = joint_indices[0];                                        \
   const uint16_t i1 = joint_indices[1];                                        \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];                          \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];                          \
+  const _Matrix& m0 = matrices[i0];                                            \
+  const _Matrix& m1 = matrices[i1];                                            \
   const math::SimdFloat4 w1 = one - w0;                                        \
-  const math::Float4x4 transform =                                             \
+  const _Matrix blended =                                                      \
       math::ColumnMultiply(m0, w0) + math::ColumnMultiply(m1, w1);             \
+  const math::Float4x4& transform = ToColumns(blended);                        \
   PREPARE_##_it##_2()
 
 #define PREPARE_NOIT_2() PREPARE_NOIT()
@@ -259,13 +364,14 @@ bool SkinningJob::Validate() const {
   const uint16_t i0 = joint_indices[0];                           \
   const uint16_t i1 = joint_indices[1];                           \
   const uint16_t i2 = joint_indices[2];                           \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];             \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];             \
-  const math::Float4x4& m2 = _job.joint_matrices[i2];             \
+  const _Matrix& m0 = matrices[i0];                               \
+  const _Matrix& m1 = matrices[i1];                               \
+  const _Matrix& m2 = matrices[i2];                               \
   const math::SimdFloat4 w2 = one - (w0 + w1);                    \
-  const math::Float4x4 transform = math::ColumnMultiply(m0, w0) + \
-                                   math::ColumnMultiply(m1, w1) + \
-                                   math::ColumnMultiply(m2, w2);  \
+  const _Matrix blended = math::ColumnMultiply(m0, w0) +          \
+                         math::ColumnMultiply(m1, w1) +          \
+                         math::ColumnMultiply(m2, w2);           \
+  const math::Float4x4& transform = ToColumns(blended);           \
   PREPARE_##_it##_3()
 
 #define PREPARE_NOIT_3() PREPARE_NOIT()
@@ -294,14 +400,15 @@ bool SkinningJob::Validate() const {
   const uint16_t i1 = joint_indices[1];                             \
   const uint16_t i2 = joint_indices[2];                             \
   const uint16_t i3 = joint_indices[3];                             \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];               \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];               \
-  const math::Float4x4& m2 = _job.joint_matrices[i2];               \
-  const math::Float4x4& m3 = _job.joint_matrices[i3];               \
+  const _Matrix& m0 = matrices[i0];                                 \
+  const _Matrix& m1 = matrices[i1];                                 \
+  const _Matrix& m2 = matrices[i2];                                 \
+  const _Matrix& m3 = matrices[i3];                                 \
   const math::SimdFloat4 w3 = one - (w0 + w1 + w2);                 \
-  const math::Float4x4 transform =                                  \
+  const _Matrix blended =                                           \
       math::ColumnMultiply(m0, w0) + math::ColumnMultiply(m1, w1) + \
       math::ColumnMultiply(m2, w2) + math::ColumnMultiply(m3, w3);  \
+  const math::Float4x4& transform = ToColumns(blended);             \
   PREPARE_##_it##_4()
 
 #define PREPARE_NOIT_4() PREPARE_NOIT()
@@ -328,28 +435,25 @@ bool SkinningJob::Validate() const {
   const math::SimdFloat4 w2 = math::simd_float4::Load1PtrU(joint_weights + 2); \
   PREPARE_4_CONCAT(_it)
 
-#define PREPARE_NOIT_N()                                                     \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0);   \
-  math::Float4x4 transform =                                                 \
-      math::ColumnMultiply(_job.joint_matrices[joint_indices[0]], wsum);     \
-  const int last = _job.influences_count - 1;                                \
-  for (int j = 1; j < last; ++j) {                                           \
-    const math::SimdFloat4 w =                                               \
-        math::simd_float4::Load1PtrU(joint_weights + j);                     \
-    wsum = wsum + w;                                                         \
-    transform = transform + math::ColumnMultiply(                            \
-                                _job.joint_matrices[joint_indices[j]], w);   \
-  }                                                                          \
-  transform =                                                                \
-      transform + math::ColumnMultiply(                                      \
-                      _job.joint_matrices[joint_indices[last]], one - wsum); \
+#define PREPARE_NOIT_N()                                                      \
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0);    \
+  _Matrix blended = math::ColumnMultiply(matrices[joint_indices[0]], wsum);   \
+  const int last = _job.influences_count - 1;                                 \
+  for (int j = 1; j < last; ++j) {                                            \
+    const math::SimdFloat4 w =                                                \
+        math::simd_float4::Load1PtrU(joint_weights + j);                      \
+    wsum = wsum + w;                                                          \
+    blended = blended + math::ColumnMultiply(matrices[joint_indices[j]], w);  \
+  }                                                                           \
+  blended = blended +                                                         \
+            math::ColumnMultiply(matrices[joint_indices[last]], one - wsum);  \
+  const math::Float4x4& transform = ToColumns(blended);                       \
   PREPARE_NOIT()
 
 #define PREPARE_IT_N()                                                        \
   math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0);    \
   const uint16_t i0 = joint_indices[0];                                       \
-  math::Float4x4 transform =                                                  \
-      math::ColumnMultiply(_job.joint_matrices[i0], wsum);                    \
+  _Matrix blended = math::ColumnMultiply(matrices[i0], wsum);                 \
   math::Float4x4 it_transform =                                               \
       math::ColumnMultiply(_job.joint_inverse_transpose_matrices[i0], wsum);  \
   const int last = _job.influences_count - 1;                                 \
@@ -358,15 +462,15 @@ bool SkinningJob::Validate() const {
     const math::SimdFloat4 w =                                                \
         math::simd_float4::Load1PtrU(joint_weights + j);                      \
     wsum = wsum + w;                                                          \
-    transform = transform + math::ColumnMultiply(_job.joint_matrices[ij], w); \
+    blended = blended + math::ColumnMultiply(matrices[ij], w);                \
     it_transform =                                                            \
         it_transform +                                                        \
         math::ColumnMultiply(_job.joint_inverse_transpose_matrices[ij], w);   \
   }                                                                           \
   const math::SimdFloat4 wlast = one - wsum;                                  \
   const int ilast = joint_indices[last];                                      \
-  transform =                                                                 \
-      transform + math::ColumnMultiply(_job.joint_matrices[ilast], wlast);    \
+  blended = blended + math::ColumnMultiply(matrices[ilast], wlast);           \
+  const math::Float4x4& transform = ToColumns(blended);                       \
   it_transform =                                                              \
       it_transform + math::ColumnMultiply(                                    \
                          _job.joint_inverse_transpose_matrices[ilast], wlast);
@@ -441,32 +545,883 @@ SKINNING_FN(PNT, IT, N)
 // Defines a matrix of skinning function pointers. This matrix will then be
 // indexed according to skinning jobs parameters.
 typedef void (*SkiningFct)(const SkinningJob&);
-static const SkiningFct kSkinningFct[2][5][3] = {
+template <typename _Matrix>
+struct SkinningFcts {
+  static const SkiningFct kFct[2][5][3];
+};
+
+template <typename _Matrix>
+const SkiningFct SkinningFcts<_Matrix>::kFct[2][5][3] = {
     {
-        {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, NOIT, 1),
-         &SKINNING_FN_NAME(PNT, NOIT, 1)},
-        {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, NOIT, 2),
-         &SKINNING_FN_NAME(PNT, NOIT, 2)},
-        {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, NOIT, 3),
-         &SKINNING_FN_NAME(PNT, NOIT, 3)},
-        {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, NOIT, 4),
-         &SKINNING_FN_NAME(PNT, NOIT, 4)},
-        {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, NOIT, N),
-         &SKINNING_FN_NAME(PNT, NOIT, N)},
+        {&SKINNING_FN_NAME(P, NOIT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PN, NOIT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, NOIT, 1)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, 2)<_Matrix>,
+         &SKINNING_FN_NAME(PN, NOIT, 2)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, NOIT, 2)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, 3)<_Matrix>,
+         &SKINNING_FN_NAME(PN, NOIT, 3)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, NOIT, 3)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, 4)<_Matrix>,
+         &SKINNING_FN_NAME(PN, NOIT, 4)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, NOIT, 4)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, N)<_Matrix>,
+         &SKINNING_FN_NAME(PN, NOIT, N)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, NOIT, N)<_Matrix>},
     },
     {
-        {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, IT, 1),
-         &SKINNING_FN_NAME(PNT, IT, 1)},
-        {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, IT, 2),
-         &SKINNING_FN_NAME(PNT, IT, 2)},
-        {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, IT, 3),
-         &SKINNING_FN_NAME(PNT, IT, 3)},
-        {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, IT, 4),
-         &SKINNING_FN_NAME(PNT, IT, 4)},
-        {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, IT, N),
-         &SKINNING_FN_NAME(PNT, IT, N)},
+        {&SKINNING_FN_NAME(P, NOIT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PN, IT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, IT, 1)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, 2)<_Matrix>,
+         &SKINNING_FN_NAME(PN, IT, 2)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, IT, 2)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, 3)<_Matrix>,
+         &SKINNING_FN_NAME(PN, IT, 3)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, IT, 3)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, 4)<_Matrix>,
+         &SKINNING_FN_NAME(PN, IT, 4)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, IT, 4)<_Matrix>},
+        {&SKINNING_FN_NAME(P, NOIT, N)<_Matrix>,
+         &SKINNING_FN_NAME(PN, IT, N)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, IT, N)<_Matrix>},
     }};
 
+#if defined(OZZ_SIMD_AVX2)
+// Implements 256 bits variants of the skinning functions, which process two
+// vertices per loop iteration. Each 128 bits lane holds one vertex data, so
+// both vertices' matrices are blended and applied in a single pass, using the
+// same in-lane operations as the 4 wide SSE implementation.
+// Variants are template arguments rather than macros, as the loop structure is
+// shared, only the number of influences and transformed vectors change.
+namespace {
+
+// Pair of matrices, the first one in the low lane, the second one in the high
+// lane. Float4x4 are stored as columns, Float3x4 as rows.
+template <typename _Matrix>
+struct Matrix2;
+
+template <>
+struct Matrix2<math::Float4x4> {
+  enum { kCount = 4 };
+  __m256 v[kCount];
+};
+
+template <>
+struct Matrix2<math::Float3x4> {
+  enum { kCount = 3 };
+  __m256 v[kCount];
+};
+
+OZZ_INLINE __m256 Combine(__m128 _lo, __m128 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+OZZ_INLINE __m256 MulAdd(__m256 _a, __m256 _b, __m256 _c) {
+#if defined(OZZ_SIMD_FMA)
+  return _mm256_fmadd_ps(_a, _b, _c);
+#else
+  return _mm256_add_ps(_mm256_mul_ps(_a, _b), _c);
+#endif
+}
+
+// Combines _a and _b matrices vectors to _out. Combined vectors are copied
+// (kCopy), scaled by _w (kScale), or scaled and added to _out (kAdd). Loops
+// are explicitly unrolled, so that pairs are kept in registers.
+enum CombineMode { kCopy, kScale, kAdd };
+
+template <CombineMode _Mode>
+OZZ_INLINE void Combine(__m128 _a, __m128 _b, __m256 _w, __m256* _out) {
+  const __m256 v = Combine(_a, _b);
+  *_out = _Mode == kCopy    ? v
+          : _Mode == kScale ? _mm256_mul_ps(v, _w)
+                            : MulAdd(v, _w, *_out);
+}
+
+template <CombineMode _Mode>
+OZZ_INLINE void Combine(const math::Float4x4& _a, const math::Float4x4& _b,
+                        __m256 _w, Matrix2<math::Float4x4>* _out) {
+  Combine<_Mode>(_a.cols[0], _b.cols[0], _w, &_out->v[0]);
+  Combine<_Mode>(_a.cols[1], _b.cols[1], _w, &_out->v[1]);
+  Combine<_Mode>(_a.cols[2], _b.cols[2], _w, &_out->v[2]);
+  Combine<_Mode>(_a.cols[3], _b.cols[3], _w, &_out->v[3]);
+}
+
+template <CombineMode _Mode>
+OZZ_INLINE void Combine(const math::Float3x4& _a, const math::Float3x4& _b,
+                        __m256 _w, Matrix2<math::Float3x4>* _out) {
+  Combine<_Mode>(_a.rows[0], _b.rows[0], _w, &_out->v[0]);
+  Combine<_Mode>(_a.rows[1], _b.rows[1], _w, &_out->v[1]);
+  Combine<_Mode>(_a.rows[2], _b.rows[2], _w, &_out->v[2]);
+}
+
+// Converts a pair of matrices to columns, transposing affine rows within each
+// lane.
+OZZ_INLINE const Matrix2<math::Float4x4>& ToColumns(
+    const Matrix2<math::Float4x4>& _m) {
+  return _m;
+}
+
+OZZ_INLINE Matrix2<math::Float4x4> ToColumns(
+    const Matrix2<math::Float3x4>& _m) {
+  const __m256 w = _mm256_set_ps(1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f);
+  const __m256 t0 = _mm256_unpacklo_ps(_m.v[0], _m.v[1]);
+  const __m256 t1 = _mm256_unpacklo_ps(_m.v[2], w);
+  const __m256 t2 = _mm256_unpackhi_ps(_m.v[0], _m.v[1]);
+  const __m256 t3 = _mm256_unpackhi_ps(_m.v[2], w);
+  const Matrix2<math::Float4x4> ret = {
+      {_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0)),
+       _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)),
+       _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+       _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2))}};
+  return ret;
+}
+
+// Transforms a pair of vectors (w = 0) or points (w = 1), one per lane.
+template <bool _Point>
+OZZ_INLINE __m256 Transform(const Matrix2<math::Float4x4>& _m, __m256 _v) {
+  const __m256 x = _mm256_permute_ps(_v, _MM_SHUFFLE(0, 0, 0, 0));
+  const __m256 y = _mm256_permute_ps(_v, _MM_SHUFFLE(1, 1, 1, 1));
+  const __m256 z = _mm256_permute_ps(_v, _MM_SHUFFLE(2, 2, 2, 2));
+  const __m256 a = _Point ? MulAdd(_m.v[0], x, _m.v[3])
+                          : _mm256_mul_ps(_m.v[0], x);
+  return MulAdd(_m.v[2], z, MulAdd(_m.v[1], y, a));
+}
+
+// Loads 3 floats of the two vertices. _Safe loads only read 3 floats, others
+// read 4 which is only allowed if the vertex isn't the last one.
+template <bool _Safe>
+OZZ_INLINE __m256 Load2(const float* _a, const float* _b) {
+  return _Safe ? Combine(math::simd_float4::Load3PtrU(_a),
+                         math::simd_float4::Load3PtrU(_b))
+               : Combine(_mm_loadu_ps(_a), _mm_loadu_ps(_b));
+}
+
+OZZ_INLINE void Store2(__m256 _v, float* _a, float* _b) {
+  math::Store3PtrU(_mm256_castps256_ps128(_v), _a);
+  math::Store3PtrU(_mm256_extractf128_ps(_v, 1), _b);
+}
+
+// Input and output pointers of the first vertex of a pair. The second vertex
+// is found by striding, so that a single set of pointers is maintained.
+struct VertexCursor {
+  const uint16_t* joint_indices;
+  const float* joint_weights;
+  const float* in_positions;
+  const float* in_normals;
+  const float* in_tangents;
+  float* out_positions;
+  float* out_normals;
+  float* out_tangents;
+};
+
+// Blends palette matrices of vertices _a and _b. _Inf is the number of
+// influences, or 0 for any number (_job.influences_count).
+template <typename _Matrix, int _Inf>
+OZZ_INLINE void Blend(const SkinningJob& _job, const _Matrix* _matrices,
+                      const uint16_t* _ia, const uint16_t* _ib,
+                      const float* _wa, const float* _wb,
+                      Matrix2<_Matrix>* _out) {
+  const int last = (_Inf ? _Inf : _job.influences_count) - 1;
+  if (last == 0) {
+    Combine<kCopy>(_matrices[_ia[0]], _matrices[_ib[0]], __m256(), _out);
+    return;
+  }
+  __m256 wsum = Combine(_mm_set1_ps(_wa[0]), _mm_set1_ps(_wb[0]));
+  Combine<kScale>(_matrices[_ia[0]], _matrices[_ib[0]], wsum, _out);
+  for (int j = 1; j < last; ++j) {
+    const __m256 w = Combine(_mm_set1_ps(_wa[j]), _mm_set1_ps(_wb[j]));
+    wsum = _mm256_add_ps(wsum, w);
+    Combine<kAdd>(_matrices[_ia[j]], _matrices[_ib[j]], w, _out);
+  }
+  const __m256 wlast = _mm256_sub_ps(_mm256_set1_ps(1.f), wsum);
+  Combine<kAdd>(_matrices[_ia[last]], _matrices[_ib[last]], wlast, _out);
+}
+
+// Skins the vertex pair starting at _c, or the single vertex _c if _pair is
+// false (it's then processed twice). _Vectors is the number of vectors to
+// transform (normals, then tangents), _It selects inverse transpose matrices
+// for vectors.
+template <typename _Matrix, int _Inf, int _Vectors, bool _It, bool _Safe>
+OZZ_INLINE void Skin2(const SkinningJob& _job, const _Matrix* _matrices,
+                      const VertexCursor& _c, bool _pair) {
+  const size_t pair = _pair;
+  const uint16_t* ib =
+      NEXT(const uint16_t*, _c.joint_indices, _job.joint_indices_stride * pair);
+  const float* wb =
+      NEXT(const float*, _c.joint_weights, _job.joint_weights_stride * pair);
+
+  Matrix2<_Matrix> blended;
+  Blend<_Matrix, _Inf>(_job, _matrices, _c.joint_indices, ib,
+                       _c.joint_weights, wb, &blended);
+  const Matrix2<math::Float4x4>& transform = ToColumns(blended);
+
+  const __m256 in_p = Load2<_Safe>(
+      _c.in_positions,
+      NEXT(const float*, _c.in_positions, _job.in_positions_stride * pair));
+  Store2(Transform<true>(transform, in_p), _c.out_positions,
+         NEXT(float*, _c.out_positions, _job.out_positions_stride * pair));
+  if (_Vectors == 0) {
+    return;
+  }
+
+  Matrix2<math::Float4x4> it_blended;
+  if (_It) {
+    Blend<math::Float4x4, _Inf>(
+        _job, _job.joint_inverse_transpose_matrices.begin(),
+        _c.joint_indices, ib, _c.joint_weights, wb, &it_blended);
+  }
+  const Matrix2<math::Float4x4>& it_transform = _It ? it_blended : transform;
+
+  const __m256 in_n = Load2<_Safe>(
+      _c.in_normals,
+      NEXT(const float*, _c.in_normals, _job.in_normals_stride * pair));
+  Store2(Transform<false>(it_transform, in_n), _c.out_normals,
+         NEXT(float*, _c.out_normals, _job.out_normals_stride * pair));
+  if (_Vectors == 1) {
+    return;
+  }
+  const __m256 in_t = Load2<_Safe>(
+      _c.in_tangents,
+      NEXT(const float*, _c.in_tangents, _job.in_tangents_stride * pair));
+  Store2(Transform<false>(it_transform, in_t), _c.out_tangents,
+         NEXT(float*, _c.out_tangents, _job.out_tangents_stride * pair));
+}
+
+// Implements the two vertices per iteration skinning loop.
+template <typename _Matrix, int _Inf, int _Vectors, bool _It>
+void Skinning2(const SkinningJob& _job) {
+  assert(_job.vertex_count && !_job.in_positions.empty());
+  assert(!_It || !_job.joint_inverse_transpose_matrices.empty());
+  const _Matrix* matrices = GetMatrices<_Matrix>(_job);
+  VertexCursor c = {_job.joint_indices.begin(),  _job.joint_weights.begin(),
+                    _job.in_positions.begin(),   _job.in_normals.begin(),
+                    _job.in_tangents.begin(),    _job.out_positions.begin(),
+                    _job.out_normals.begin(),    _job.out_tangents.begin()};
+
+  // Neither vertex of a pair is the last one while more than 2 vertices
+  // remain, so 4 floats can be read. Only used pointers are moved forward.
+  int remaining = _job.vertex_count;
+  for (; remaining > 2; remaining -= 2) {
+    Skin2<_Matrix, _Inf, _Vectors, _It, false>(_job, matrices, c, true);
+    c.joint_indices = NEXT(const uint16_t*, c.joint_indices,
+                           _job.joint_indices_stride * 2);
+    if (_Inf != 1) {
+      c.joint_weights = NEXT(const float*, c.joint_weights,
+                             _job.joint_weights_stride * 2);
+    }
+    c.in_positions =
+        NEXT(const float*, c.in_positions, _job.in_positions_stride * 2);
+    c.out_positions =
+        NEXT(float*, c.out_positions, _job.out_positions_stride * 2);
+    if (_Vectors > 0) {
+      c.in_normals =
+          NEXT(const float*, c.in_normals, _job.in_normals_stride * 2);
+      c.out_normals =
+          NEXT(float*, c.out_normals, _job.out_normals_stride * 2);
+    }
+    if (_Vectors > 1) {
+      c.in_tangents =
+          NEXT(const float*, c.in_tangents, _job.in_tangents_stride * 2);
+      c.out_tangents =
+          NEXT(float*, c.out_tangents, _job.out_tangents_stride * 2);
+    }
+  }
+
+  // Last one or two vertices.
+  Skin2<_Matrix, _Inf, _Vectors, _It, true>(_job, matrices, c,
+                                            remaining == 2);
+}
+
+// Defines a matrix of skinning function pointers, with the same layout as
+// SkinningFcts. Single influence variants are kept from the 4 wide
+// implementation, as there's no matrix blending to amortize the cost of
+// combining both vertices' matrices.
+typedef void (*SkiningFct2)(const SkinningJob&);
+template <typename _Matrix>
+struct Skinning2Fcts {
+  static const SkiningFct2 kFct[2][5][3];
+};
+
+template <typename _Matrix>
+const SkiningFct2 Skinning2Fcts<_Matrix>::kFct[2][5][3] = {
+    {
+        {&SKINNING_FN_NAME(P, NOIT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PN, NOIT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, NOIT, 1)<_Matrix>},
+        {&Skinning2<_Matrix, 2, 0, false>, &Skinning2<_Matrix, 2, 1, false>,
+         &Skinning2<_Matrix, 2, 2, false>},
+        {&Skinning2<_Matrix, 3, 0, false>, &Skinning2<_Matrix, 3, 1, false>,
+         &Skinning2<_Matrix, 3, 2, false>},
+        {&Skinning2<_Matrix, 4, 0, false>, &Skinning2<_Matrix, 4, 1, false>,
+         &Skinning2<_Matrix, 4, 2, false>},
+        {&Skinning2<_Matrix, 0, 0, false>, &Skinning2<_Matrix, 0, 1, false>,
+         &Skinning2<_Matrix, 0, 2, false>},
+    },
+    {
+        {&SKINNING_FN_NAME(P, NOIT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PN, IT, 1)<_Matrix>,
+         &SKINNING_FN_NAME(PNT, IT, 1)<_Matrix>},
+        {&Skinning2<_Matrix, 2, 0, false>, &Skinning2<_Matrix, 2, 1, true>,
+         &Skinning2<_Matrix, 2, 2, true>},
+        {&Skinning2<_Matrix, 3, 0, false>, &Skinning2<_Matrix, 3, 1, true>,
+         &Skinning2<_Matrix, 3, 2, true>},
+        {&Skinning2<_Matrix, 4, 0, false>, &Skinning2<_Matrix, 4, 1, true>,
+         &Skinning2<_Matrix, 4, 2, true>},
+        {&Skinning2<_Matrix, 0, 0, false>, &Skinning2<_Matrix, 0, 1, true>,
+         &Skinning2<_Matrix, 0, 2, true>},
+    }};
+}  // namespace
+#endif  // OZZ_SIMD_AVX2
+
+// Implements quantized inputs support. Quantized vertices are decoded by
+// batches to a buffer small enough to remain in L1 cache (job vertex_scratch or
+// a stack buffer), which is then skinned by the float skinning functions. This
+// keeps a single implementation of all skinning variants, whatever the input
+// formats.
+namespace {
+// Size of the decoding buffer, in number of SimdFloat4. It follows the output
+// buffer in job vertex_scratch.
+enum { kQuantizedBufferSize = 512 };
+
+// Offsets _span begin by _offset bytes, or returns an empty span if _span
+// doesn't extend that far (which happens for empty or unused streams).
+template <typename _Type>
+span<_Type> OffsetSpan(const span<_Type>& _span, size_t _offset) {
+  if (_offset >= _span.size_bytes()) {
+    return span<_Type>();
+  }
+  return span<_Type>(PointerStride(_span.begin(), _offset), _span.end());
+}
+
+// Quantized positions, normals and tangents are decoded 4 vertices at a time,
+// each SIMD register holding one component of the 4 vertices. Decoded vertices
+// are stored as aligned SimdFloat4, w being undefined.
+
+// Gets pointers to the 4 vertices starting at _in. Vertices past _count are
+// clamped to the last one, so that no read happens out of the buffer.
+template <typename _Type>
+OZZ_INLINE void Fetch4(const _Type* _in, size_t _stride, int _count,
+                       const _Type* _vertices[4]) {
+  for (int i = 0; i < 4; ++i) {
+    _vertices[i] = NEXT(const _Type*, _in, _stride * math::Min(i, _count - 1));
+  }
+}
+
+// Loads component _c of the 4 vertices, converted to float.
+template <typename _Type>
+OZZ_INLINE math::SimdFloat4 Gather4(const _Type* const _vertices[4], int _c) {
+  return math::simd_float4::FromInt(
+      math::simd_int4::Load(_vertices[0][_c], _vertices[1][_c],
+                            _vertices[2][_c], _vertices[3][_c]));
+}
+
+// Stores x, y and z components of the 4 vertices to _out.
+OZZ_INLINE void Scatter4(const math::SimdFloat4 _xyz[3],
+                         math::SimdFloat4* _out) {
+  math::Transpose3x4(_xyz, _out);
+}
+
+// Iterates groups of 4 vertices, calling _decoder for each group. Full groups
+// are iterated first, so that vertex pointers only need clamping for the last
+// group.
+template <typename _Type, typename _Decoder>
+OZZ_INLINE void DecodeGroups(const _Type* _in, size_t _stride, int _count,
+                             const _Decoder& _decoder,
+                             math::SimdFloat4* _out) {
+  const _Type* vertices[4];
+  const int full = _count & ~3;
+  int i = 0;
+  for (; i < full; i += 4, _out += 4) {
+    Fetch4(_in, _stride, 4, vertices);
+    _decoder(vertices, _out);
+    _in = NEXT(const _Type*, _in, _stride * 4);
+  }
+  if (i < _count) {
+    Fetch4(_in, _stride, _count - i, vertices);
+    _decoder(vertices, _out);
+  }
+}
+
+// Decodes positions as quantized * scale + offset.
+struct PositionsDecoder {
+  PositionsDecoder(const math::Float3& _scale, const math::Float3& _offset)
+      : scale_x(math::simd_float4::Load1(_scale.x)),
+        scale_y(math::simd_float4::Load1(_scale.y)),
+        scale_z(math::simd_float4::Load1(_scale.z)),
+        offset_x(math::simd_float4::Load1(_offset.x)),
+        offset_y(math::simd_float4::Load1(_offset.y)),
+        offset_z(math::simd_float4::Load1(_offset.z)) {}
+
+  OZZ_INLINE void operator()(const int16_t* const _vertices[4],
+                             math::SimdFloat4* _out) const {
+    const math::SimdFloat4 xyz[3] = {
+        math::MAdd(Gather4(_vertices, 0), scale_x, offset_x),
+        math::MAdd(Gather4(_vertices, 1), scale_y, offset_y),
+        math::MAdd(Gather4(_vertices, 2), scale_z, offset_z)};
+    Scatter4(xyz, _out);
+  }
+
+  math::SimdFloat4 scale_x, scale_y, scale_z;
+  math::SimdFloat4 offset_x, offset_y, offset_z;
+};
+
+// Decodes snorm8 or octahedral vectors.
+template <bool _Octahedral>
+struct VectorsDecoder {
+  VectorsDecoder()
+      : zero(math::simd_float4::zero()),
+        one(math::simd_float4::one()),
+        snorm(math::simd_float4::Load1(1.f / 127.f)) {}
+
+  OZZ_INLINE void operator()(const int8_t* const _vertices[4],
+                             math::SimdFloat4* _out) const {
+    math::SimdFloat4 xyz[3];
+    xyz[0] = math::Max(Gather4(_vertices, 0) * snorm, -one);
+    xyz[1] = math::Max(Gather4(_vertices, 1) * snorm, -one);
+    if (_Octahedral) {
+      // Unfolds the octahedron lower hemisphere, and normalizes.
+      xyz[2] = one - math::Abs(xyz[0]) - math::Abs(xyz[1]);
+      const math::SimdFloat4 t = math::Max(-xyz[2], zero);
+      xyz[0] = xyz[0] + math::Select(math::CmpGe(xyz[0], zero), -t, t);
+      xyz[1] = xyz[1] + math::Select(math::CmpGe(xyz[1], zero), -t, t);
+      const math::SimdFloat4 len2 =
+          xyz[0] * xyz[0] + xyz[1] * xyz[1] + xyz[2] * xyz[2];
+      const math::SimdFloat4 inv_len = math::RSqrtEstNR(len2);
+      xyz[0] = xyz[0] * inv_len;
+      xyz[1] = xyz[1] * inv_len;
+      xyz[2] = xyz[2] * inv_len;
+    } else {
+      xyz[2] = math::Max(Gather4(_vertices, 2) * snorm, -one);
+    }
+    Scatter4(xyz, _out);
+  }
+
+  math::SimdFloat4 zero, one, snorm;
+};
+
+void DecodePositions(const int16_t* _in, size_t _stride, int _count,
+                     const math::Float3& _scale, const math::Float3& _offset,
+                     math::SimdFloat4* _out) {
+  DecodeGroups(_in, _stride, _count, PositionsDecoder(_scale, _offset), _out);
+}
+
+void DecodeVectors(const int8_t* _in, size_t _stride, int _count,
+                   SkinningJob::VectorEncoding _encoding,
+                   math::SimdFloat4* _out) {
+  if (_encoding == SkinningJob::kSnorm8) {
+    DecodeGroups(_in, _stride, _count, VectorsDecoder<false>(), _out);
+  } else {
+    assert(_encoding == SkinningJob::kOctahedral8);
+    DecodeGroups(_in, _stride, _count, VectorsDecoder<true>(), _out);
+  }
+}
+
+void DecodeWeights(const uint8_t* _in, size_t _stride, int _count,
+                   int _weights, float* _out) {
+  for (int i = 0; i < _count; ++i, _out += _weights) {
+    for (int j = 0; j < _weights; ++j) {
+      _out[j] = _in[j] * (1.f / 255.f);
+    }
+    _in = NEXT(const uint8_t*, _in, _stride);
+  }
+}
+
+// Returns the float span of _count decoded vertices.
+OZZ_INLINE span<const float> DecodedSpan(const math::SimdFloat4* _decoded,
+                                         int _count) {
+  return span<const float>(reinterpret_cast<const float*>(_decoded),
+                           static_cast<size_t>(_count) * 4);
+}
+
+// Runs _fct skinning function on batches of vertices decoded to _buffer. Non
+// quantized inputs and outputs are forwarded to the skinning function as is.
+void SkinQuantizedBatches(const SkinningJob& _job, SkiningFct _fct,
+                          math::SimdFloat4* _buffer) {
+  // Computes decoding buffer layout, according to the quantized inputs.
+  // Positions, normals and tangents use a SimdFloat4 per vertex, weights use
+  // influences_count - 1 floats. Batches are a multiple of 4 vertices, which
+  // is the decoding granularity.
+  const int positions = !_job.in_quantized_positions.empty();
+  const int normals = !_job.in_quantized_normals.empty();
+  const int tangents = !_job.in_quantized_tangents.empty();
+  const int weights = _job.influences_count > 1 &&
+                              !_job.joint_quantized_weights.empty()
+                          ? _job.influences_count - 1
+                          : 0;
+  const int group_size = (positions + normals + tangents) * 4 + weights;
+  assert(group_size > 0 && group_size <= kQuantizedBufferSize);
+  const int batch_count = kQuantizedBufferSize / group_size * 4;
+
+  math::SimdFloat4* decoded_positions = _buffer;
+  math::SimdFloat4* decoded_normals =
+      decoded_positions + positions * batch_count;
+  math::SimdFloat4* decoded_tangents = decoded_normals + normals * batch_count;
+  float* decoded_weights =
+      reinterpret_cast<float*>(decoded_tangents + tangents * batch_count);
+
+  // Batch job reads decoded inputs from the buffer.
+  SkinningJob batch = _job;
+  batch.in_quantized_positions = span<const int16_t>();
+  batch.in_quantized_normals = span<const int8_t>();
+  batch.in_quantized_tangents = span<const int8_t>();
+  batch.joint_quantized_weights = span<const uint8_t>();
+  if (positions) {
+    batch.in_positions_stride = sizeof(math::SimdFloat4);
+  }
+  if (normals) {
+    batch.in_normals_stride = sizeof(math::SimdFloat4);
+  }
+  if (tangents) {
+    batch.in_tangents_stride = sizeof(math::SimdFloat4);
+  }
+  if (weights) {
+    batch.joint_weights_stride = sizeof(float) * weights;
+  }
+
+  for (int from = 0; from < _job.vertex_count; from += batch_count) {
+    const int count = math::Min(batch_count, _job.vertex_count - from);
+    batch.vertex_count = count;
+
+    batch.joint_indices =
+        OffsetSpan(_job.joint_indices, _job.joint_indices_stride * from);
+    const size_t weights_offset = _job.joint_weights_stride * from;
+    if (weights) {
+      DecodeWeights(
+          NEXT(const uint8_t*, _job.joint_quantized_weights.begin(),
+               weights_offset),
+          _job.joint_weights_stride, count, weights, decoded_weights);
+      batch.joint_weights = {decoded_weights,
+                             decoded_weights + count * weights};
+    } else {
+      batch.joint_weights = OffsetSpan(_job.joint_weights, weights_offset);
+    }
+
+    const size_t positions_offset = _job.in_positions_stride * from;
+    if (positions) {
+      DecodePositions(NEXT(const int16_t*, _job.in_quantized_positions.begin(),
+                           positions_offset),
+                      _job.in_positions_stride, count, _job.positions_scale,
+                      _job.positions_offset, decoded_positions);
+      batch.in_positions = DecodedSpan(decoded_positions, count);
+    } else {
+      batch.in_positions = OffsetSpan(_job.in_positions, positions_offset);
+    }
+
+    const size_t normals_offset = _job.in_normals_stride * from;
+    if (normals) {
+      DecodeVectors(NEXT(const int8_t*, _job.in_quantized_normals.begin(),
+                         normals_offset),
+                    _job.in_normals_stride, count,
+                    _job.quantized_vectors_encoding, decoded_normals);
+      batch.in_normals = DecodedSpan(decoded_normals, count);
+    } else {
+      batch.in_normals = OffsetSpan(_job.in_normals, normals_offset);
+    }
+
+    const size_t tangents_offset = _job.in_tangents_stride * from;
+    if (tangents) {
+      DecodeVectors(NEXT(const int8_t*, _job.in_quantized_tangents.begin(),
+                         tangents_offset),
+                    _job.in_tangents_stride, count,
+                    _job.quantized_vectors_encoding, decoded_tangents);
+      batch.in_tangents = DecodedSpan(decoded_tangents, count);
+    } else {
+      batch.in_tangents = OffsetSpan(_job.in_tangents, tangents_offset);
+    }
+
+    batch.out_positions =
+        OffsetSpan(_job.out_positions, _job.out_positions_stride * from);
+    batch.out_normals =
+        OffsetSpan(_job.out_normals, _job.out_normals_stride * from);
+    batch.out_tangents =
+        OffsetSpan(_job.out_tangents, _job.out_tangents_stride * from);
+
+    _fct(batch);
+  }
+}
+
+// Stack allocated decoding buffer is isolated in this function, only used when
+// no vertex scratch buffer is provided.
+void SkinQuantizedStack(const SkinningJob& _job, SkiningFct _fct) {
+  math::SimdFloat4 buffer[kQuantizedBufferSize];
+  SkinQuantizedBatches(_job, _fct, buffer);
+}
+
+// Runs _fct skinning function on decoded quantized inputs.
+void SkinQuantized(const SkinningJob& _job, SkiningFct _fct) {
+  if (_job.vertex_scratch.empty()) {
+    SkinQuantizedStack(_job, _fct);
+  } else {
+    SkinQuantizedBatches(_job, _fct,
+                         _job.vertex_scratch.begin() +
+                             (SkinningJob::kVertexScratchSize -
+                              kQuantizedBufferSize));
+  }
+}
+}  // namespace
+
+// Implements half precision outputs. Vertices are skinned by batches to a
+// buffer (job vertex_scratch or a stack buffer), which is then converted and
+// written to job outputs. Like quantized inputs, this keeps a single
+// implementation of all skinning variants, whatever the output formats.
+namespace {
+// Size of the output buffer, in number of SimdFloat4. It's at the beginning of
+// job vertex_scratch.
+enum { kOutputBufferSize = 512 };
+static_assert(kOutputBufferSize + kQuantizedBufferSize <=
+                  SkinningJob::kVertexScratchSize,
+              "Vertex scratch buffer is too small");
+
+// Describes a half precision output stream, which is buffered.
+struct BufferedOutput {
+  BufferedOutput(const span<uint16_t>& _halves, size_t _stride)
+      : halves(_halves.begin()),
+        stride(_stride),
+        buffered(!_halves.empty()) {}
+
+  // Writes buffered vertex _v to output vertex _index.
+  OZZ_INLINE void Write(math::_SimdFloat4 _v, int _index) const {
+    int h[4];
+    math::StorePtrU(math::FloatToHalf(_v), h);
+    uint16_t* out =
+        NEXT(uint16_t*, halves, stride * static_cast<size_t>(_index));
+    out[0] = static_cast<uint16_t>(h[0]);
+    out[1] = static_cast<uint16_t>(h[1]);
+    out[2] = static_cast<uint16_t>(h[2]);
+  }
+
+  uint16_t* halves;
+  size_t stride;
+  bool buffered;
+};
+
+// Returns the float span of a buffer of _count vertices.
+OZZ_INLINE span<float> BufferedSpan(math::SimdFloat4* _buffer, int _count) {
+  return span<float>(reinterpret_cast<float*>(_buffer),
+                     static_cast<size_t>(_count) * 4);
+}
+
+// Runs _fct skinning function on batches of vertices, whose half outputs are
+// buffered to _buffer. Quantized inputs are decoded if _quantized is true.
+void SkinBufferedBatches(const SkinningJob& _job, SkiningFct _fct,
+                         bool _quantized, math::SimdFloat4* _buffer) {
+  const bool normals = !_job.in_normals.empty() ||
+                       !_job.in_quantized_normals.empty();
+  const bool tangents = !_job.in_tangents.empty() ||
+                        !_job.in_quantized_tangents.empty();
+  const BufferedOutput positions(_job.out_half_positions,
+                                 _job.out_positions_stride);
+  const BufferedOutput normals_output(_job.out_half_normals,
+                                      _job.out_normals_stride);
+  const BufferedOutput tangents_output(_job.out_half_tangents,
+                                       _job.out_tangents_stride);
+  const bool buffer_normals = normals && normals_output.buffered;
+  const bool buffer_tangents = tangents && tangents_output.buffered;
+
+  // Computes buffer layout, using a SimdFloat4 per vertex and output.
+  const int streams = positions.buffered + buffer_normals + buffer_tangents;
+  assert(streams > 0);
+  const int batch_count = kOutputBufferSize / streams / 4 * 4;
+  math::SimdFloat4* buffered_positions = _buffer;
+  math::SimdFloat4* buffered_normals =
+      buffered_positions + positions.buffered * batch_count;
+  math::SimdFloat4* buffered_tangents =
+      buffered_normals + buffer_normals * batch_count;
+
+  for (int from = 0; from < _job.vertex_count; from += batch_count) {
+    const int count = math::Min(batch_count, _job.vertex_count - from);
+
+    // Batch job writes buffered outputs to the buffer.
+    SkinningJob batch = GetSkinningJobRange(_job, from, count);
+    batch.out_half_positions = span<uint16_t>();
+    batch.out_half_normals = span<uint16_t>();
+    batch.out_half_tangents = span<uint16_t>();
+    if (positions.buffered) {
+      batch.out_positions = BufferedSpan(buffered_positions, count);
+      batch.out_positions_stride = sizeof(math::SimdFloat4);
+    }
+    if (buffer_normals) {
+      batch.out_normals = BufferedSpan(buffered_normals, count);
+      batch.out_normals_stride = sizeof(math::SimdFloat4);
+    }
+    if (buffer_tangents) {
+      batch.out_tangents = BufferedSpan(buffered_tangents, count);
+      batch.out_tangents_stride = sizeof(math::SimdFloat4);
+    }
+
+    if (_quantized) {
+      SkinQuantized(batch, _fct);
+    } else {
+      _fct(batch);
+    }
+
+    // Outputs are written vertex by vertex, so that interleaved outputs are
+    // written sequentially.
+    for (int i = 0; i < count; ++i) {
+      if (positions.buffered) {
+        positions.Write(buffered_positions[i], from + i);
+      }
+      if (buffer_normals) {
+        normals_output.Write(buffered_normals[i], from + i);
+      }
+      if (buffer_tangents) {
+        tangents_output.Write(buffered_tangents[i], from + i);
+      }
+    }
+  }
+}
+
+// Stack allocated output buffer is isolated in this function, only used when
+// no vertex scratch buffer is provided.
+void SkinBufferedStack(const SkinningJob& _job, SkiningFct _fct,
+                       bool _quantized) {
+  math::SimdFloat4 buffer[kOutputBufferSize];
+  SkinBufferedBatches(_job, _fct, _quantized, buffer);
+}
+
+// Runs _fct skinning function with buffered half outputs.
+void SkinBuffered(const SkinningJob& _job, SkiningFct _fct, bool _quantized) {
+  if (_job.vertex_scratch.empty()) {
+    SkinBufferedStack(_job, _fct, _quantized);
+  } else {
+    SkinBufferedBatches(_job, _fct, _quantized, _job.vertex_scratch.begin());
+  }
+}
+}  // namespace
+
+namespace {
+// Skins a valid job, whose joint indices directly index joint matrices.
+void Skin(const SkinningJob& _job) {
+  // Find skinning function index. Two vertices per iteration variants are
+  // used if 256 bits instructions are available.
+#if defined(OZZ_SIMD_AVX2)
+  const SkiningFct2(*kSkinningFct)[5][3] =
+      _job.joint_affine_matrices.empty()
+          ? Skinning2Fcts<math::Float4x4>::kFct
+          : Skinning2Fcts<math::Float3x4>::kFct;
+#else   // OZZ_SIMD_AVX2
+  const SkiningFct(*kSkinningFct)[5][3] =
+      _job.joint_affine_matrices.empty() ? SkinningFcts<math::Float4x4>::kFct
+                                         : SkinningFcts<math::Float3x4>::kFct;
+#endif  // OZZ_SIMD_AVX2
+  const size_t it = !_job.joint_inverse_transpose_matrices.empty();
+  assert(it < 2);
+  const size_t inf = static_cast<size_t>(_job.influences_count) >
+                             OZZ_ARRAY_SIZE(kSkinningFct[0])
+                         ? OZZ_ARRAY_SIZE(kSkinningFct[0]) - 1
+                         : _job.influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct[0]));
+  const size_t fct =
+      (!_job.in_normals.empty() || !_job.in_quantized_normals.empty()) +
+      (!_job.in_tangents.empty() || !_job.in_quantized_tangents.empty());
+  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0][0]));
+
+  // Calls skinning function. Quantized inputs are decoded before being
+  // forwarded to the skinning function, and buffered outputs are written
+  // after.
+  const bool quantized =
+      !_job.in_quantized_positions.empty() ||
+      !_job.in_quantized_normals.empty() ||
+      !_job.in_quantized_tangents.empty() ||
+      (_job.influences_count > 1 && !_job.joint_quantized_weights.empty());
+  const bool buffered = !_job.out_half_positions.empty() ||
+                        !_job.out_half_normals.empty() ||
+                        !_job.out_half_tangents.empty();
+  if (buffered) {
+    SkinBuffered(_job, kSkinningFct[it][inf][fct], quantized);
+  } else if (quantized) {
+    SkinQuantized(_job, kSkinningFct[it][inf][fct]);
+  } else {
+    kSkinningFct[it][inf][fct](_job);
+  }
+}
+
+// Computes skinning matrices of remapped joints, from joint model-space
+// matrices and inverse bind-pose matrices.
+void RemapMatrices(const SkinningJob& _job, math::Float3x4* _palette) {
+  const size_t count = _job.joint_remaps.size();
+  if (_job.joint_matrices.empty()) {
+    const math::Float3x4* models = _job.joint_affine_matrices.begin();
+    for (size_t i = 0; i < count; ++i) {
+      _palette[i] = models[_job.joint_remaps[i]] *
+                    math::Float3x4::FromFloat4x4(
+                        _job.joint_inverse_bind_matrices[i]);
+    }
+  } else {
+    const math::Float4x4* models = _job.joint_matrices.begin();
+    for (size_t i = 0; i < count; ++i) {
+      _palette[i] = math::Float3x4::FromFloat4x4(
+          models[_job.joint_remaps[i]] * _job.joint_inverse_bind_matrices[i]);
+    }
+  }
+}
+
+// Stack allocated remapped palette requires a significant amount of stack
+// memory (kMaxStackRemappedJoints), which is why it's isolated in this
+// function, only used when no scratch buffer is provided.
+void SkinRemappedStack(const SkinningJob& _job) {
+  math::Float3x4 palette[SkinningJob::kMaxStackRemappedJoints];
+  Skin(GetRemappedSkinningJob(_job, palette));
+}
+}  // namespace
+
+SkinningJob GetRemappedSkinningJob(const SkinningJob& _job,
+                                   const span<math::Float3x4>& _palette) {
+  assert(_palette.size() >= _job.joint_remaps.size());
+  RemapMatrices(_job, _palette.begin());
+  SkinningJob job = _job;
+  job.joint_matrices = {};
+  job.joint_affine_matrices = {_palette.begin(), _job.joint_remaps.size()};
+  job.joint_remaps = {};
+  job.joint_inverse_bind_matrices = {};
+  job.remap_scratch = {};
+  return job;
+}
+
+SkinningJob GetSkinningJobRange(const SkinningJob& _job, int _begin,
+                                int _count) {
+  assert(_begin >= 0 && _count >= 0 && _begin + _count <= _job.vertex_count);
+  const size_t begin = static_cast<size_t>(_begin);
+
+  SkinningJob range = _job;
+  range.vertex_count = _count;
+  if (_count == 0) {
+    return range;
+  }
+  range.joint_indices =
+      OffsetSpan(_job.joint_indices, _job.joint_indices_stride * begin);
+  range.joint_weights =
+      OffsetSpan(_job.joint_weights, _job.joint_weights_stride * begin);
+  range.joint_quantized_weights = OffsetSpan(_job.joint_quantized_weights,
+                                             _job.joint_weights_stride * begin);
+  range.in_positions =
+      OffsetSpan(_job.in_positions, _job.in_positions_stride * begin);
+  range.in_quantized_positions = OffsetSpan(_job.in_quantized_positions,
+                                            _job.in_positions_stride * begin);
+  range.in_normals =
+      OffsetSpan(_job.in_normals, _job.in_normals_stride * begin);
+  range.in_quantized_normals =
+      OffsetSpan(_job.in_quantized_normals, _job.in_normals_stride * begin);
+  range.in_tangents =
+      OffsetSpan(_job.in_tangents, _job.in_tangents_stride * begin);
+  range.in_quantized_tangents =
+      OffsetSpan(_job.in_quantized_tangents, _job.in_tangents_stride * begin);
+  range.out_positions =
+      OffsetSpan(_job.out_positions, _job.out_positions_stride * begin);
+  range.out_normals =
+      OffsetSpan(_job.out_normals, _job.out_normals_stride * begin);
+  range.out_tangents =
+      OffsetSpan(_job.out_tangents, _job.out_tangents_stride * begin);
+  range.out_half_positions =
+      OffsetSpan(_job.out_half_positions, _job.out_positions_stride * begin);
+  range.out_half_normals =
+      OffsetSpan(_job.out_half_normals, _job.out_normals_stride * begin);
+  range.out_half_tangents =
+      OffsetSpan(_job.out_half_tangents, _job.out_tangents_stride * begin);
+  return range;
+}
+
 // Implements job Run function.
 bool SkinningJob::Run() const {
   // Exit with an error if job is invalid.
@@ -480,19 +1435,15 @@ bool SkinningJob::Run() const {
     return true;
   }
 
-  // Find skinning function index.
-  const size_t it = !joint_inverse_transpose_matrices.empty();
-  assert(it < OZZ_ARRAY_SIZE(kSkinningFct));
-  const size_t inf =
-      static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct[0])
-          ? OZZ_ARRAY_SIZE(kSkinningFct[0]) - 1
-          : influences_count - 1;
-  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct[0]));
-  const size_t fct = !in_normals.empty() + !in_tangents.empty();
-  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0][0]));
-
-  // Calls skinning function. Cannot fail because job is valid.
-  kSkinningFct[it][inf][fct](*this);
+  // Calls skinning function. Cannot fail because job is valid. Remapped
+  // skinning matrices are computed first if needed.
+  if (joint_remaps.empty()) {
+    Skin(*this);
+  } else if (remap_scratch.empty()) {
+    SkinRemappedStack(*this);
+  } else {
+    Skin(GetRemappedSkinningJob(*this, remap_scratch));
+  }
 
   return true;
 }
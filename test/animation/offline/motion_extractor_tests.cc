@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/motion_extractor.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+
+using ozz::animation::offline::MotionExtractor;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawFloat3Track;
+using ozz::animation::offline::RawQuaternionTrack;
+
+TEST(Error, MotionExtractor) {
+  MotionExtractor extractor;
+  RawFloat3Track position;
+  RawQuaternionTrack rotation;
+
+  {  // nullptr outputs.
+    RawAnimation input;
+    input.tracks.resize(1);
+    EXPECT_TRUE(input.Validate());
+
+    RawAnimation output;
+    EXPECT_FALSE(extractor(input, nullptr, &rotation, &output));
+    EXPECT_FALSE(extractor(input, &position, nullptr, &output));
+    EXPECT_FALSE(extractor(input, &position, &rotation, nullptr));
+  }
+
+  {  // Invalid input animation.
+    RawAnimation input;
+    input.duration = -1.f;
+    input.tracks.resize(1);
+    EXPECT_FALSE(input.Validate());
+
+    RawAnimation output;
+    output.tracks.resize(1);
+    position.keyframes.resize(1);
+    EXPECT_FALSE(extractor(input, &position, &rotation, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+    EXPECT_EQ(position.keyframes.size(), 0u);
+  }
+
+  {  // Invalid root joint.
+    RawAnimation input;
+    input.tracks.resize(1);
+    EXPECT_TRUE(input.Validate());
+
+    RawAnimation output;
+    MotionExtractor invalid;
+    invalid.root_joint = 1;
+    EXPECT_FALSE(invalid(input, &position, &rotation, &output));
+    invalid.root_joint = -1;
+    EXPECT_FALSE(invalid(input, &position, &rotation, &output));
+  }
+}
+
+TEST(Extract, MotionExtractor) {
+  RawAnimation input;
+  input.duration = 2.f;
+  input.tracks.resize(2);
+
+  const ozz::math::Quaternion yaw = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float3::y_axis(), ozz::math::kPi_2);
+  const ozz::math::Quaternion pitch = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float3::x_axis(), ozz::math::kPi_2 * .5f);
+
+  RawAnimation::JointTrack& root = input.tracks[0];
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 1.f, 0.f)};
+  root.translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {2.f,
+                                           ozz::math::Float3(2.f, 1.f, 4.f)};
+  root.translations.push_back(t1);
+  const RawAnimation::RotationKey r0 = {0.f, pitch};
+  root.rotations.push_back(r0);
+  const RawAnimation::RotationKey r1 = {2.f, yaw * pitch};
+  root.rotations.push_back(r1);
+
+  MotionExtractor extractor;
+  RawFloat3Track position;
+  RawQuaternionTrack rotation;
+  RawAnimation output;
+  ASSERT_TRUE(extractor(input, &position, &rotation, &output));
+  EXPECT_TRUE(position.Validate());
+  EXPECT_TRUE(rotation.Validate());
+  EXPECT_TRUE(output.Validate());
+
+  // Extracted motion, y position is not extracted.
+  ASSERT_EQ(position.keyframes.size(), 2u);
+  EXPECT_FLOAT_EQ(position.keyframes[0].ratio, 0.f);
+  EXPECT_FLOAT3_EQ(position.keyframes[0].value, 0.f, 0.f, 0.f);
+  EXPECT_FLOAT_EQ(position.keyframes[1].ratio, 1.f);
+  EXPECT_FLOAT3_EQ(position.keyframes[1].value, 2.f, 0.f, 4.f);
+
+  // Extracted yaw only.
+  ASSERT_EQ(rotation.keyframes.size(), 2u);
+  EXPECT_QUATERNION_EQ(rotation.keyframes[0].value, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(rotation.keyframes[1].value, yaw.x, yaw.y, yaw.z,
+                       yaw.w);
+
+  // Baked root joint is relative to the extracted motion.
+  EXPECT_EQ(output.num_tracks(), 2);
+  const RawAnimation::JointTrack& baked = output.tracks[0];
+  ASSERT_EQ(baked.translations.size(), 2u);
+  EXPECT_FLOAT3_EQ(baked.translations[0].value, 0.f, 1.f, 0.f);
+  EXPECT_FLOAT3_EQ(baked.translations[1].value, 0.f, 1.f, 0.f);
+  ASSERT_EQ(baked.rotations.size(), 2u);
+  EXPECT_QUATERNION_EQ(baked.rotations[0].value, pitch.x, pitch.y, pitch.z,
+                       pitch.w);
+  EXPECT_QUATERNION_EQ(baked.rotations[1].value, pitch.x, pitch.y, pitch.z,
+                       pitch.w);
+
+  // Without baking, output matches input.
+  extractor.bake = false;
+  ASSERT_TRUE(extractor(input, &position, &rotation, &output));
+  EXPECT_FLOAT3_EQ(output.tracks[0].translations[1].value, 2.f, 1.f, 4.f);
+  EXPECT_QUATERNION_EQ(output.tracks[0].rotations[1].value, r1.value.x,
+                       r1.value.y, r1.value.z, r1.value.w);
+
+  // Without rotation extraction.
+  extractor.rotation_y = false;
+  extractor.position_y = true;
+  ASSERT_TRUE(extractor(input, &position, &rotation, &output));
+  EXPECT_EQ(rotation.keyframes.size(), 0u);
+  EXPECT_FLOAT3_EQ(position.keyframes[1].value, 2.f, 1.f, 4.f);
+}
@@ -83,6 +83,7 @@ TEST(Filled, RawSkeletonSerialize) {
   root.children[0].children[0].transform = ozz::math::Transform::identity();
   root.children[0].children[0].transform.rotation =
       ozz::math::Quaternion(0.f, 0.f, 1.f, 0.f);
+  root.children[0].children[0].lod = 2;
 
   EXPECT_TRUE(o_skeleton.Validate());
   EXPECT_EQ(o_skeleton.num_joints(), 4);
@@ -115,6 +116,10 @@ TEST(Filled, RawSkeletonSerialize) {
     EXPECT_STREQ(o_skeleton.roots[0].children[1].name.c_str(),
                  i_skeleton.roots[0].children[1].name.c_str());
 
+    // Compares skeletons joint's LOD.
+    EXPECT_EQ(i_skeleton.roots[0].lod, 0);
+    EXPECT_EQ(i_skeleton.roots[0].children[0].children[0].lod, 2);
+
     // Compares skeletons joint's transform.
     EXPECT_TRUE(Compare(o_skeleton.roots[0].transform.translation,
                         i_skeleton.roots[0].transform.translation, 0.f));
@@ -603,6 +603,154 @@ TEST(MultiRoots, SkeletonBuilder) {
   }
 }
 
+TEST(Hierarchy, SkeletonBuilder) {
+  // Instantiates a builder objects with default parameters.
+  SkeletonBuilder builder;
+
+  {  // Empty skeleton.
+    RawSkeleton raw_skeleton;
+    ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+    ASSERT_TRUE(skeleton);
+    EXPECT_EQ(skeleton->joint_depths().size(), 0u);
+    EXPECT_EQ(skeleton->joint_subtree_ends().size(), 0u);
+    EXPECT_EQ(skeleton->joint_first_children().size(), 0u);
+    EXPECT_EQ(skeleton->joint_next_siblings().size(), 0u);
+    EXPECT_EQ(skeleton->num_lods(), 0);
+  }
+
+  /*
+  7 joints (2 roots)
+     *
+    /  \
+   j0   j2
+   |    |  \
+   j1  j3  j5
+        |    \
+       j4    j6
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  raw_skeleton.roots[0].name = "j0";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "j1";
+  raw_skeleton.roots[1].name = "j2";
+  raw_skeleton.roots[1].children.resize(2);
+  raw_skeleton.roots[1].children[0].name = "j3";
+  raw_skeleton.roots[1].children[0].children.resize(1);
+  raw_skeleton.roots[1].children[0].children[0].name = "j4";
+  raw_skeleton.roots[1].children[1].name = "j5";
+  raw_skeleton.roots[1].children[1].children.resize(1);
+  raw_skeleton.roots[1].children[1].children[0].name = "j6";
+
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 7);
+
+  // Joints are ordered depth first, so joint index matches joint name.
+  const int16_t depths[] = {0, 1, 0, 1, 2, 1, 2};
+  for (int i = 0; i < skeleton->num_joints(); i++) {
+    EXPECT_EQ(skeleton->joint_depths()[i], depths[i]);
+  }
+
+  // Hierarchy metadata.
+  const int16_t subtree_ends[] = {2, 2, 7, 5, 5, 7, 7};
+  const int16_t first_children[] = {1, -1, 3, 4, -1, 6, -1};
+  const int16_t next_siblings[] = {2, -1, -1, 5, -1, -1, -1};
+  for (int i = 0; i < skeleton->num_joints(); i++) {
+    EXPECT_EQ(skeleton->joint_subtree_ends()[i], subtree_ends[i]);
+    EXPECT_EQ(skeleton->joint_first_children()[i], first_children[i]);
+    EXPECT_EQ(skeleton->joint_next_siblings()[i], next_siblings[i]);
+  }
+
+  // A single LOD by default.
+  ASSERT_EQ(skeleton->num_lods(), 1);
+  EXPECT_EQ(skeleton->lod_num_joints()[0], 7);
+}
+
+TEST(Lods, SkeletonBuilder) {
+  // Instantiates a builder objects with default parameters.
+  SkeletonBuilder builder;
+
+  /*
+  7 joints (2 roots), with LODs in brackets
+      *
+     /  \
+   j0[0] j6[2]
+   |    \
+  j1[0] j4[0]
+   |     |
+  j2[1] j5[1]
+   |
+  j3[2]
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.name = "j0";
+  j0.children.resize(2);
+  RawSkeleton::Joint& j1 = j0.children[0];
+  j1.name = "j1";
+  j1.children.resize(1);
+  RawSkeleton::Joint& j2 = j1.children[0];
+  j2.name = "j2";
+  j2.lod = 1;
+  j2.children.resize(1);
+  RawSkeleton::Joint& j3 = j2.children[0];
+  j3.name = "j3";
+  j3.lod = 2;
+  RawSkeleton::Joint& j4 = j0.children[1];
+  j4.name = "j4";
+  j4.children.resize(1);
+  RawSkeleton::Joint& j5 = j4.children[0];
+  j5.name = "j5";
+  j5.lod = 1;
+  RawSkeleton::Joint& j6 = raw_skeleton.roots[1];
+  j6.name = "j6";
+  j6.lod = 2;
+  ASSERT_TRUE(raw_skeleton.Validate());
+
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 7);
+
+  // Joints are sorted by LOD, then depth first.
+  const char* names[] = {"j0", "j1", "j4", "j2", "j5", "j3", "j6"};
+  const int16_t parents[] = {-1, 0, 0, 1, 2, 3, -1};
+  const int16_t depths[] = {0, 1, 1, 2, 2, 3, 0};
+  for (int i = 0; i < skeleton->num_joints(); i++) {
+    EXPECT_STREQ(skeleton->joint_names()[i], names[i]);
+    EXPECT_EQ(skeleton->joint_parents()[i], parents[i]);
+    EXPECT_EQ(skeleton->joint_depths()[i], depths[i]);
+  }
+
+  ASSERT_EQ(skeleton->num_lods(), 3);
+  const int16_t lod_num_joints[] = {3, 5, 7};
+  for (int i = 0; i < skeleton->num_lods(); i++) {
+    EXPECT_EQ(skeleton->lod_num_joints()[i], lod_num_joints[i]);
+  }
+
+  // Subtrees ranges contain all descendants, but aren't exact anymore.
+  const int16_t subtree_ends[] = {6, 6, 5, 6, 5, 6, 7};
+  const int16_t first_children[] = {1, 3, 4, 5, -1, -1, -1};
+  const int16_t next_siblings[] = {6, 2, -1, -1, -1, -1, -1};
+  for (int i = 0; i < skeleton->num_joints(); i++) {
+    EXPECT_EQ(skeleton->joint_subtree_ends()[i], subtree_ends[i]);
+    EXPECT_EQ(skeleton->joint_first_children()[i], first_children[i]);
+    EXPECT_EQ(skeleton->joint_next_siblings()[i], next_siblings[i]);
+  }
+
+  // A joint LOD can't be lower than its parent's.
+  j3.lod = 0;
+  EXPECT_FALSE(raw_skeleton.Validate());
+  EXPECT_FALSE(builder(raw_skeleton));
+
+  // LOD can't be negative.
+  j3.lod = 2;
+  j6.lod = -1;
+  EXPECT_FALSE(raw_skeleton.Validate());
+  EXPECT_FALSE(builder(raw_skeleton));
+}
+
 TEST(RestPose, SkeletonBuilder) {
   using ozz::math::Float3;
   using ozz::math::Float4;
@@ -0,0 +1,192 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/blend_space_job.h"
+
+#include "gtest/gtest.h"
+
+using ozz::animation::BlendSpaceJob;
+
+TEST(JobValidity, BlendSpaceJob) {
+  const ozz::math::Float2 positions[3] = {ozz::math::Float2(-1.f, 0.f),
+                                          ozz::math::Float2(0.f, 0.f),
+                                          ozz::math::Float2(1.f, 0.f)};
+  BlendSpaceJob::Contributor contributors[3];
+  int num_contributors;
+
+  {  // Empty/default job.
+    BlendSpaceJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No positions.
+    BlendSpaceJob job;
+    job.contributors = contributors;
+    job.num_contributors = &num_contributors;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Contributors too small.
+    BlendSpaceJob job;
+    job.positions = positions;
+    job.contributors = {contributors, 2};
+    job.num_contributors = &num_contributors;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No count output.
+    BlendSpaceJob job;
+    job.positions = positions;
+    job.contributors = contributors;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid threshold.
+    BlendSpaceJob job;
+    job.positions = positions;
+    job.contributors = contributors;
+    job.num_contributors = &num_contributors;
+    job.threshold = -.1f;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid.
+    BlendSpaceJob job;
+    job.positions = positions;
+    job.contributors = contributors;
+    job.num_contributors = &num_contributors;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Blend1D, BlendSpaceJob) {
+  const ozz::math::Float2 positions[3] = {ozz::math::Float2(-1.f, 0.f),
+                                          ozz::math::Float2(0.f, 0.f),
+                                          ozz::math::Float2(2.f, 0.f)};
+  BlendSpaceJob::Contributor contributors[3];
+  int num_contributors = 0;
+
+  BlendSpaceJob job;
+  job.positions = positions;
+  job.contributors = contributors;
+  job.num_contributors = &num_contributors;
+
+  // Exactly on a sample.
+  job.parameter = ozz::math::Float2(0.f, 0.f);
+  ASSERT_TRUE(job.Run());
+  ASSERT_EQ(num_contributors, 1);
+  EXPECT_EQ(contributors[0].index, 1);
+  EXPECT_FLOAT_EQ(contributors[0].weight, 1.f);
+
+  // Between two samples.
+  job.parameter = ozz::math::Float2(.5f, 0.f);
+  ASSERT_TRUE(job.Run());
+  ASSERT_EQ(num_contributors, 2);
+  EXPECT_EQ(contributors[0].index, 1);
+  EXPECT_FLOAT_EQ(contributors[0].weight, .75f);
+  EXPECT_EQ(contributors[1].index, 2);
+  EXPECT_FLOAT_EQ(contributors[1].weight, .25f);
+
+  // Outside of the blend space, the nearest sample only contributes.
+  job.parameter = ozz::math::Float2(-3.f, 0.f);
+  ASSERT_TRUE(job.Run());
+  ASSERT_EQ(num_contributors, 1);
+  EXPECT_EQ(contributors[0].index, 0);
+  EXPECT_FLOAT_EQ(contributors[0].weight, 1.f);
+
+  // Single sample.
+  job.positions = {positions, 1};
+  job.parameter = ozz::math::Float2(5.f, 0.f);
+  ASSERT_TRUE(job.Run());
+  ASSERT_EQ(num_contributors, 1);
+  EXPECT_EQ(contributors[0].index, 0);
+  EXPECT_FLOAT_EQ(contributors[0].weight, 1.f);
+}
+
+TEST(Blend2D, BlendSpaceJob) {
+  // 3x3 grid.
+  ozz::math::Float2 positions[9];
+  for (int i = 0; i < 9; ++i) {
+    positions[i] = ozz::math::Float2(static_cast<float>(i % 3 - 1),
+                                     static_cast<float>(i / 3 - 1));
+  }
+  BlendSpaceJob::Contributor contributors[9];
+  int num_contributors = 0;
+
+  BlendSpaceJob job;
+  job.positions = positions;
+  job.contributors = contributors;
+  job.num_contributors = &num_contributors;
+
+  // Exactly on the center sample.
+  job.parameter = ozz::math::Float2(0.f, 0.f);
+  ASSERT_TRUE(job.Run());
+  ASSERT_EQ(num_contributors, 1);
+  EXPECT_EQ(contributors[0].index, 4);
+  EXPECT_FLOAT_EQ(contributors[0].weight, 1.f);
+
+  // Within a cell, only cell corners contribute.
+  job.parameter = ozz::math::Float2(.25f, .5f);
+  ASSERT_TRUE(job.Run());
+  ASSERT_EQ(num_contributors, 4);
+  EXPECT_EQ(contributors[0].index, 4);
+  EXPECT_EQ(contributors[1].index, 5);
+  EXPECT_EQ(contributors[2].index, 7);
+  EXPECT_EQ(contributors[3].index, 8);
+  float sum = 0.f;
+  for (int i = 0; i < num_contributors; ++i) {
+    EXPECT_GT(contributors[i].weight, 0.f);
+    sum += contributors[i].weight;
+  }
+  EXPECT_FLOAT_EQ(sum, 1.f);
+  EXPECT_GT(contributors[0].weight, contributors[3].weight);
+
+  // Threshold prunes low weights and renormalizes.
+  job.threshold = .2f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_LT(num_contributors, 4);
+  EXPECT_GE(num_contributors, 1);
+  sum = 0.f;
+  for (int i = 0; i < num_contributors; ++i) {
+    EXPECT_GT(contributors[i].weight, .2f);
+    sum += contributors[i].weight;
+  }
+  EXPECT_FLOAT_EQ(sum, 1.f);
+
+  // Threshold never prunes the highest weight.
+  job.threshold = 1.f;
+  ASSERT_TRUE(job.Run());
+  ASSERT_EQ(num_contributors, 1);
+  EXPECT_EQ(contributors[0].index, 4);
+  EXPECT_FLOAT_EQ(contributors[0].weight, 1.f);
+}
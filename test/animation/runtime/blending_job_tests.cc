@@ -25,11 +25,15 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/runtime/blending_job.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/soa_transform.h"
 
+using ozz::animation::BatchBlendingJob;
 using ozz::animation::BlendingJob;
 
 TEST(JobValidity, BlendingJob) {
@@ -439,6 +443,398 @@ TEST(JointWeights, BlendingJob) {
   }
 }
 
+TEST(Scratch, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+
+  // Uses a rest pose bigger than the stack limit.
+  const size_t num_soa_joints = BlendingJob::kMaxStackSoAJoints + 1;
+  ozz::vector<ozz::math::SoaTransform> rest_poses(num_soa_joints, identity);
+  ozz::vector<ozz::math::SoaTransform> input_transforms(num_soa_joints,
+                                                        identity);
+  ozz::vector<ozz::math::SimdFloat4> joint_weights(num_soa_joints, one);
+  ozz::vector<ozz::math::SoaTransform> output_transforms(num_soa_joints);
+  ozz::vector<ozz::math::SimdFloat4> scratch(num_soa_joints);
+
+  for (size_t i = 0; i < num_soa_joints; ++i) {
+    const float v = static_cast<float>(i);
+    input_transforms[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(v, v + 1.f, v + 2.f, v + 3.f),
+        ozz::math::simd_float4::zero(), ozz::math::simd_float4::zero());
+  }
+  joint_weights.back() = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+
+  BlendingJob::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform = ozz::make_span(input_transforms);
+
+  {  // Too many joints without scratch.
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = ozz::make_span(rest_poses);
+    job.output = ozz::make_span(output_transforms);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Scratch too small.
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = ozz::make_span(rest_poses);
+    job.output = ozz::make_span(output_transforms);
+    job.scratch = {scratch.data(), num_soa_joints - 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid scratch, small rest pose.
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = {rest_poses.data(), 1};
+    job.output = ozz::make_span(output_transforms);
+    job.scratch = ozz::make_span(scratch);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid scratch, full layer.
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = ozz::make_span(rest_poses);
+    job.output = ozz::make_span(output_transforms);
+    job.scratch = ozz::make_span(scratch);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation, 0.f, 1.f, 2.f, 3.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[num_soa_joints - 1].translation,
+                        256.f, 257.f, 258.f, 259.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f);
+  }
+
+  {  // Valid scratch, partial layer.
+    layers[0].joint_weights = ozz::make_span(joint_weights);
+
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = ozz::make_span(rest_poses);
+    job.output = ozz::make_span(output_transforms);
+    job.scratch = ozz::make_span(scratch);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation, 1.f, 2.f, 3.f, 4.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[num_soa_joints - 1].translation,
+                        256.f, 257.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f);
+  }
+}
+
+namespace {
+// Compares all members of two soa transforms. Tolerance accounts for
+// additive blending normalization estimations, which are skipped by sparse
+// layers for uncovered joints.
+void ExpectSoaTransformNear(const ozz::math::SoaTransform& _expected,
+                            const ozz::math::SoaTransform& _actual) {
+  const ozz::math::SimdFloat4* expected =
+      reinterpret_cast<const ozz::math::SimdFloat4*>(&_expected);
+  const ozz::math::SimdFloat4* actual =
+      reinterpret_cast<const ozz::math::SimdFloat4*>(&_actual);
+  for (size_t i = 0; i < sizeof(ozz::math::SoaTransform) /
+                             sizeof(ozz::math::SimdFloat4);
+       ++i) {
+    float e[4], a[4];
+    ozz::math::StorePtrU(expected[i], e);
+    ozz::math::StorePtrU(actual[i], a);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(e[j], a[j], 1e-3f * (1.f + std::abs(e[j])));
+    }
+  }
+}
+}  // namespace
+
+TEST(SparseJointWeights, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+
+  // Initialize inputs.
+  ozz::math::SoaTransform input_transforms[2][3];
+  for (int l = 0; l < 2; ++l) {
+    for (int i = 0; i < 3; ++i) {
+      const float v = static_cast<float>(l * 12 + i * 4) * (l ? -1.f : 1.f);
+      ozz::math::SoaTransform& transform = input_transforms[l][i];
+      transform = identity;
+      transform.translation = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(v, v + 1.f, v + 2.f, v + 3.f),
+          ozz::math::simd_float4::Load(v * 2.f, v, 0.f, 1.f),
+          ozz::math::simd_float4::Load(1.f, 2.f, v, v * 3.f));
+      transform.rotation.y = ozz::math::simd_float4::Load(.5f, 0.f, .1f, .7f);
+      transform.rotation = NormalizeEst(transform.rotation);
+      transform.scale.x = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f);
+    }
+  }
+  ozz::math::SoaTransform rest_poses[3] = {identity, identity, identity};
+  rest_poses[1].translation.y = ozz::math::simd_float4::Load1(5.f);
+
+  // Sparse mask covers soa joint 1 only.
+  const ozz::math::SimdFloat4 sparse_weight =
+      ozz::math::simd_float4::Load(1.f, .5f, 0.f, .25f);
+  const uint16_t soa_indices[1] = {1};
+  const ozz::math::SimdFloat4 sparse_weights[1] = {sparse_weight};
+  const ozz::math::SimdFloat4 dense_weights[3] = {zero, sparse_weight, zero};
+
+  BlendingJob::Layer sparse_layers[2];
+  sparse_layers[0].transform = input_transforms[0];
+  sparse_layers[1].transform = input_transforms[1];
+  sparse_layers[1].soa_indices = soa_indices;
+  sparse_layers[1].joint_weights = sparse_weights;
+
+  BlendingJob::Layer dense_layers[2];
+  dense_layers[0].transform = input_transforms[0];
+  dense_layers[1].transform = input_transforms[1];
+  dense_layers[1].joint_weights = dense_weights;
+
+  {  // Invalid soa index.
+    const uint16_t invalid_indices[1] = {3};
+    BlendingJob::Layer layer;
+    layer.weight = 1.f;
+    layer.transform = input_transforms[0];
+    layer.soa_indices = invalid_indices;
+    ozz::math::SoaTransform output[3];
+
+    BlendingJob job;
+    job.layers = {&layer, 1};
+    job.rest_pose = rest_poses;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+
+    // Duplicated soa indices.
+    const uint16_t duplicated_indices[2] = {1, 1};
+    layer.soa_indices = duplicated_indices;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+
+    // Unsorted soa indices.
+    const uint16_t unsorted_indices[2] = {1, 0};
+    layer.soa_indices = unsorted_indices;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+
+    // Compact joint weights too small.
+    layer.soa_indices = soa_indices;
+    layer.joint_weights = {sparse_weights, static_cast<size_t>(0)};
+    EXPECT_TRUE(job.Validate());
+    const uint16_t two_indices[2] = {0, 1};
+    layer.soa_indices = two_indices;
+    layer.joint_weights = sparse_weights;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  const float weights[][2] = {{1.f, 1.f}, {.3f, .7f}, {0.f, 1.f}, {0.f, .05f}};
+  for (size_t w = 0; w < OZZ_ARRAY_SIZE(weights); ++w) {
+    for (int additive = 0; additive < 2; ++additive) {
+      sparse_layers[0].weight = dense_layers[0].weight = weights[w][0];
+      sparse_layers[1].weight = dense_layers[1].weight = weights[w][1];
+
+      ozz::math::SoaTransform sparse_output[3];
+      BlendingJob sparse_job;
+      sparse_job.rest_pose = rest_poses;
+      sparse_job.output = sparse_output;
+
+      ozz::math::SoaTransform dense_output[3];
+      BlendingJob dense_job;
+      dense_job.rest_pose = rest_poses;
+      dense_job.output = dense_output;
+
+      if (additive) {
+        sparse_job.layers = {sparse_layers, 1};
+        sparse_job.additive_layers = {sparse_layers + 1, 1};
+        dense_job.layers = {dense_layers, 1};
+        dense_job.additive_layers = {dense_layers + 1, 1};
+      } else {
+        sparse_job.layers = sparse_layers;
+        dense_job.layers = dense_layers;
+      }
+
+      ASSERT_TRUE(sparse_job.Run());
+      ASSERT_TRUE(dense_job.Run());
+      for (int i = 0; i < 3; ++i) {
+        ExpectSoaTransformNear(dense_output[i], sparse_output[i]);
+      }
+    }
+  }
+
+  {  // Subtractive sparse layer.
+    sparse_layers[0].weight = dense_layers[0].weight = 1.f;
+    sparse_layers[1].weight = dense_layers[1].weight = -.5f;
+
+    ozz::math::SoaTransform sparse_output[3];
+    BlendingJob sparse_job;
+    sparse_job.rest_pose = rest_poses;
+    sparse_job.output = sparse_output;
+    sparse_job.layers = {sparse_layers, 1};
+    sparse_job.additive_layers = {sparse_layers + 1, 1};
+
+    ozz::math::SoaTransform dense_output[3];
+    BlendingJob dense_job;
+    dense_job.rest_pose = rest_poses;
+    dense_job.output = dense_output;
+    dense_job.layers = {dense_layers, 1};
+    dense_job.additive_layers = {dense_layers + 1, 1};
+
+    ASSERT_TRUE(sparse_job.Run());
+    ASSERT_TRUE(dense_job.Run());
+    for (int i = 0; i < 3; ++i) {
+      ExpectSoaTransformNear(dense_output[i], sparse_output[i]);
+    }
+  }
+
+  {  // Sparse first layer, without joint weights.
+    BlendingJob::Layer layers[2];
+    layers[0].weight = .5f;
+    layers[0].transform = input_transforms[1];
+    layers[0].soa_indices = soa_indices;
+    layers[1].weight = .5f;
+    layers[1].transform = input_transforms[0];
+
+    const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+    const ozz::math::SimdFloat4 dense_unit_weights[3] = {zero, one, zero};
+    BlendingJob::Layer expected_layers[2];
+    expected_layers[0] = layers[0];
+    expected_layers[0].soa_indices = {};
+    expected_layers[0].joint_weights = dense_unit_weights;
+    expected_layers[1] = layers[1];
+
+    ozz::math::SoaTransform output[3];
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = rest_poses;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform expected[3];
+    BlendingJob expected_job;
+    expected_job.layers = expected_layers;
+    expected_job.rest_pose = rest_poses;
+    expected_job.output = expected;
+    ASSERT_TRUE(expected_job.Run());
+
+    for (int i = 0; i < 3; ++i) {
+      ExpectSoaTransformNear(expected[i], output[i]);
+    }
+  }
+}
+
+TEST(Batch, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // 3 instances, with 2 layers and 1 additive layer each.
+  const int kInstances = 3;
+  ozz::math::SoaTransform input_transforms[kInstances][3][2];
+  for (int i = 0; i < kInstances; ++i) {
+    for (int l = 0; l < 3; ++l) {
+      for (int j = 0; j < 2; ++j) {
+        const float v = static_cast<float>(i * 100 + l * 10 + j);
+        ozz::math::SoaTransform& transform = input_transforms[i][l][j];
+        transform = identity;
+        transform.translation.x =
+            ozz::math::simd_float4::Load(v, v + 1.f, v + 2.f, v + 3.f);
+        transform.rotation.z = ozz::math::simd_float4::Load1(v * .01f);
+        transform.rotation = NormalizeEst(transform.rotation);
+        transform.scale.y = ozz::math::simd_float4::Load1(1.f + v * .001f);
+      }
+    }
+  }
+  const ozz::math::SoaTransform rest_poses[2] = {identity, identity};
+  const ozz::math::SimdFloat4 joint_weights[2] = {
+      ozz::math::simd_float4::Load(1.f, 0.f, .5f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 1.f, .2f, 1.f)};
+
+  BlendingJob::Layer layers[kInstances][2];
+  BlendingJob::Layer additive_layers[kInstances][1];
+  ozz::math::SoaTransform batch_outputs[kInstances][2];
+  ozz::span<ozz::math::SoaTransform> outputs[kInstances];
+  for (int i = 0; i < kInstances; ++i) {
+    layers[i][0].weight = .2f + i * .3f;
+    layers[i][0].transform = input_transforms[i][0];
+    layers[i][1].weight = .5f;
+    layers[i][1].transform = input_transforms[i][1];
+    layers[i][1].joint_weights = joint_weights;
+    additive_layers[i][0].weight = .5f * i;
+    additive_layers[i][0].transform = input_transforms[i][2];
+    outputs[i] = batch_outputs[i];
+  }
+
+  {  // Default job.
+    BatchBlendingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Layers aren't a multiple of instances.
+    BatchBlendingJob job;
+    job.layers = {layers[0], 5};
+    job.rest_pose = rest_poses;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    ozz::span<ozz::math::SoaTransform> invalid_outputs[kInstances] = {
+        outputs[0], {batch_outputs[1], 1}, outputs[2]};
+    BatchBlendingJob job;
+    job.layers = {layers[0], kInstances * 2};
+    job.rest_pose = rest_poses;
+    job.outputs = invalid_outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid threshold.
+    BatchBlendingJob job;
+    job.threshold = 0.f;
+    job.layers = {layers[0], kInstances * 2};
+    job.rest_pose = rest_poses;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  // Batch must match individual jobs, with or without scratch.
+  for (int use_scratch = 0; use_scratch < 2; ++use_scratch) {
+    ozz::math::SimdFloat4 scratch[2];
+
+    BatchBlendingJob job;
+    job.layers = {layers[0], kInstances * 2};
+    job.additive_layers = {additive_layers[0], kInstances};
+    job.rest_pose = rest_poses;
+    job.outputs = outputs;
+    if (use_scratch) {
+      job.scratch = scratch;
+    }
+    EXPECT_TRUE(job.Validate());
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kInstances; ++i) {
+      ozz::math::SoaTransform expected[2];
+      BlendingJob single;
+      single.layers = layers[i];
+      single.additive_layers = additive_layers[i];
+      single.rest_pose = rest_poses;
+      single.output = expected;
+      ASSERT_TRUE(single.Run());
+      for (int j = 0; j < 2; ++j) {
+        ExpectSoaTransformNear(expected[j], batch_outputs[i][j]);
+      }
+    }
+  }
+}
+
 TEST(Normalize, BlendingJob) {
   const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
 
@@ -0,0 +1,254 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::InertializationCaptureJob;
+using ozz::animation::InertializationJob;
+
+TEST(JobValidity, InertializationJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform poses[2] = {identity, identity};
+  ozz::math::SoaTransform output[2];
+  InertializationJob::Context context(8);
+  EXPECT_EQ(context.max_soa_joints(), 2);
+  EXPECT_EQ(context.num_soa_joints(), 0);
+
+  {  // Empty/default capture job.
+    InertializationCaptureJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Missing context.
+    InertializationCaptureJob job;
+    job.previous = poses;
+    job.current = poses;
+    job.target = poses;
+    job.delta_time = 1.f / 30.f;
+    job.duration = .3f;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Context too small.
+    InertializationJob::Context small(4);
+    InertializationCaptureJob job;
+    job.previous = poses;
+    job.current = poses;
+    job.target = poses;
+    job.delta_time = 1.f / 30.f;
+    job.duration = .3f;
+    job.context = &small;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Previous pose too small.
+    InertializationCaptureJob job;
+    job.previous = {poses, 1};
+    job.current = poses;
+    job.target = poses;
+    job.delta_time = 1.f / 30.f;
+    job.duration = .3f;
+    job.context = &context;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Target pose too small.
+    InertializationCaptureJob job;
+    job.previous = poses;
+    job.current = poses;
+    job.target = {poses, 1};
+    job.delta_time = 1.f / 30.f;
+    job.duration = .3f;
+    job.context = &context;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid times.
+    InertializationCaptureJob job;
+    job.previous = poses;
+    job.current = poses;
+    job.target = poses;
+    job.context = &context;
+    job.duration = .3f;
+    EXPECT_FALSE(job.Validate());
+    job.delta_time = 1.f / 30.f;
+    job.duration = 0.f;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Not captured context.
+    InertializationJob job;
+    job.context = &context;
+    job.input = poses;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid capture.
+    InertializationCaptureJob job;
+    job.previous = poses;
+    job.current = {poses, 1};
+    job.target = poses;
+    job.delta_time = 1.f / 30.f;
+    job.duration = .3f;
+    job.context = &context;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(context.num_soa_joints(), 1);
+  }
+
+  {  // Input bigger than captured.
+    InertializationJob job;
+    job.context = &context;
+    job.input = poses;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Output too small.
+    InertializationJob job;
+    job.context = &context;
+    job.input = {poses, 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid.
+    InertializationJob job;
+    job.context = &context;
+    job.input = {poses, 1};
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Invalidated context.
+    context.Invalidate();
+    InertializationJob job;
+    job.context = &context;
+    job.input = {poses, 1};
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+}
+
+TEST(Decay, InertializationJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Source pose, moving along x toward target on the first joint, with a
+  // constant pose on the others.
+  ozz::math::SoaTransform previous = identity;
+  previous.translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(1.1f, 1.f, 0.f, 0.f),
+      ozz::math::simd_float4::zero(), ozz::math::simd_float4::zero());
+  previous.scale = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(1.f, 1.f, 2.f, 1.f),
+      ozz::math::simd_float4::one(), ozz::math::simd_float4::one());
+  ozz::math::SoaTransform current = previous;
+  current.translation.x = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+  // 90 degrees around y on the last joint.
+  current.rotation = ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::zero(),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, .7071067f),
+      ozz::math::simd_float4::zero(),
+      ozz::math::simd_float4::Load(1.f, 1.f, 1.f, .7071067f));
+  previous.rotation = current.rotation;
+
+  // Destination pose is identity.
+  const ozz::math::SoaTransform target = identity;
+
+  InertializationJob::Context context(4);
+  InertializationCaptureJob capture;
+  capture.previous = {&previous, 1};
+  capture.current = {&current, 1};
+  capture.target = {&target, 1};
+  capture.delta_time = .1f;
+  capture.duration = .5f;
+  capture.context = &context;
+  ASSERT_TRUE(capture.Run());
+
+  ozz::math::SoaTransform output;
+  InertializationJob job;
+  job.context = &context;
+  job.input = {&target, 1};
+  job.output = {&output, 1};
+
+  // Output matches source pose at transition time.
+  job.time = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output.translation, 1.f, 1.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output.rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, .7071067f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                              1.f, .7071067f);
+  EXPECT_SOAFLOAT3_EQ_EST(output.scale, 1.f, 1.f, 2.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+
+  // Offset decays, faster when source was moving toward target.
+  job.time = .1f;
+  ASSERT_TRUE(job.Run());
+  ozz::math::SimdFloat4 x = output.translation.x;
+  const float moving = ozz::math::GetX(x);
+  const float still = ozz::math::GetY(x);
+  EXPECT_LT(moving, still);
+  EXPECT_LT(still, 1.f);
+  EXPECT_GT(moving, 0.f);
+  EXPECT_GT(still, 0.f);
+
+  // Offset is fully decayed after duration.
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output.translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output.rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
+                              1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output.scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f);
+
+  // Output can be the input buffer.
+  output = target;
+  job.time = 0.f;
+  job.output = {&output, 1};
+  job.input = {&output, 1};
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output.translation, 1.f, 1.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+}
@@ -25,12 +25,18 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/float3x4.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_dual_quaternion.h"
+#include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/unique_ptr.h"
 
@@ -1026,3 +1032,1020 @@ TEST(Empty, LocalToModel) {
     EXPECT_TRUE(job.Run());
   }
 }
+
+namespace {
+// Builds a skeleton mixing chains (joints depending on joints of the same soa
+// entry) and siblings (independent joints of the same soa entry).
+/*
+ 11 joints
+       *
+     /   \
+    j0    j9
+   /  \    \
+  j1  j3   j10
+  |   /|\
+  j2 j4 j7 j8
+     |
+     j5
+     |
+     j6
+*/
+ozz::unique_ptr<Skeleton> BuildSoaSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.name = "j0";
+  j0.children.resize(2);
+  j0.children[0].name = "j1";
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].name = "j2";
+  RawSkeleton::Joint& j3 = j0.children[1];
+  j3.name = "j3";
+  j3.children.resize(3);
+  j3.children[0].name = "j4";
+  j3.children[0].children.resize(1);
+  j3.children[0].children[0].name = "j5";
+  j3.children[0].children[0].children.resize(1);
+  j3.children[0].children[0].children[0].name = "j6";
+  j3.children[1].name = "j7";
+  j3.children[2].name = "j8";
+  RawSkeleton::Joint& j9 = raw_skeleton.roots[1];
+  j9.name = "j9";
+  j9.children.resize(1);
+  j9.children[0].name = "j10";
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Compares aos output with soa output, joint by joint.
+void ExpectSoaOutputEq(const ozz::math::Float4x4* _aos,
+                       const ozz::math::SoaFloat4x4* _soa, int _num_joints) {
+  for (int i = 0; i < _num_joints; ++i) {
+    ozz::math::Float4x4 soa_aos[4];
+    ozz::math::Transpose16x16(&_soa[i / 4].cols[0].x, soa_aos->cols);
+    for (int c = 0; c < 4; ++c) {
+      float expected[4];
+      float actual[4];
+      ozz::math::StorePtrU(_aos[i].cols[c], expected);
+      ozz::math::StorePtrU(soa_aos[i & 3].cols[c], actual);
+      for (int r = 0; r < 4; ++r) {
+        EXPECT_NEAR(expected[r], actual[r],
+                    1e-5f * (1.f + std::fabs(expected[r])))
+            << "joint " << i << ", column " << c << ", row " << r;
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(SoaOutputValidity, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSoaSkeleton();
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 11);
+
+  ozz::math::SoaTransform input[3] = {ozz::math::SoaTransform::identity(),
+                                      ozz::math::SoaTransform::identity(),
+                                      ozz::math::SoaTransform::identity()};
+  ozz::math::Float4x4 output[11];
+  ozz::math::SoaFloat4x4 soa_output[3];
+
+  {  // Valid soa output.
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.soa_output = soa_output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Soa output too small.
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.soa_output = {soa_output, soa_output + 2};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Both outputs.
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.output = output;
+    job.soa_output = soa_output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+}
+
+TEST(SoaOutput, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSoaSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  // Non trivial inputs, different for every joint.
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f),
+        ozz::math::simd_float4::Load(1.f, -2.f, 3.f, -4.f),
+        ozz::math::simd_float4::Load(-f, 2.f, -f, .5f));
+    input[i].rotation = ozz::math::SoaQuaternion::Load(
+        ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .5f),
+        ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .5f),
+        ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, .5f),
+        ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f,
+                                     .5f));
+    input[i].scale = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+        ozz::math::simd_float4::Load(1.f, 2.f, -1.f, .5f),
+        ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 3.f));
+  }
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(4.f, 3.f, 2.f, 0.f));
+
+  const int kFroms[] = {Skeleton::kNoParent, 0, 1, 3, 4, 5, 9, 10, 46};
+  const int kTos[] = {0, 2, 5, 8, 10, Skeleton::kMaxJoints};
+  for (const int from : kFroms) {
+    for (const int to : kTos) {
+      for (int excluded = 0; excluded < 2; ++excluded) {
+        for (int with_root = 0; with_root < 2; ++with_root) {
+          // Initializes outputs with the same arbitrary values, to test that
+          // joints out of range are preserved.
+          const ozz::math::Float4x4 init = ozz::math::Float4x4::Scaling(
+              ozz::math::simd_float4::Load(46.f, 46.f, 46.f, 0.f));
+          ozz::math::Float4x4 output[12];
+          for (ozz::math::Float4x4& m : output) {
+            m = init;
+          }
+          ozz::math::SoaFloat4x4 soa_output[3];
+          for (ozz::math::SoaFloat4x4& m : soa_output) {
+            for (int c = 0; c < 4; ++c) {
+              float col[4];
+              ozz::math::StorePtrU(init.cols[c], col);
+              m.cols[c] = {ozz::math::simd_float4::Load1(col[0]),
+                           ozz::math::simd_float4::Load1(col[1]),
+                           ozz::math::simd_float4::Load1(col[2]),
+                           ozz::math::simd_float4::Load1(col[3])};
+            }
+          }
+
+          LocalToModelJob job;
+          job.skeleton = skeleton.get();
+          job.root = with_root ? &root : nullptr;
+          job.from = from;
+          job.to = to;
+          job.from_excluded = excluded != 0;
+          job.input = input;
+          job.output = {output, output + num_joints};
+          ASSERT_TRUE(job.Run());
+
+          LocalToModelJob soa_job = job;
+          soa_job.output = {};
+          soa_job.soa_output = soa_output;
+          ASSERT_TRUE(soa_job.Run());
+
+          ExpectSoaOutputEq(output, soa_output, num_joints);
+        }
+      }
+    }
+  }
+}
+
+TEST(AffineOutput, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSoaSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f),
+        ozz::math::simd_float4::Load(1.f, -2.f, 3.f, -4.f),
+        ozz::math::simd_float4::Load(-f, 2.f, -f, .5f));
+    input[i].rotation = ozz::math::SoaQuaternion::Load(
+        ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .5f),
+        ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .5f),
+        ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, .5f),
+        ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f,
+                                     .5f));
+    input[i].scale = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+        ozz::math::simd_float4::Load(1.f, 2.f, -1.f, .5f),
+        ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 3.f));
+  }
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(4.f, 3.f, 2.f, 0.f));
+
+  {  // Validity.
+    ozz::math::Float4x4 output[11];
+    ozz::math::Float3x4 affine_output[11];
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.affine_output = affine_output;
+    EXPECT_TRUE(job.Validate());
+    job.affine_output = {affine_output, affine_output + 10};
+    EXPECT_FALSE(job.Validate());
+    job.affine_output = affine_output;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  const int kFroms[] = {Skeleton::kNoParent, 0, 3, 5, 9};
+  const int kTos[] = {2, 8, Skeleton::kMaxJoints};
+  for (const int from : kFroms) {
+    for (const int to : kTos) {
+      for (int excluded = 0; excluded < 2; ++excluded) {
+        const ozz::math::Float4x4 init = ozz::math::Float4x4::Scaling(
+            ozz::math::simd_float4::Load(46.f, 46.f, 46.f, 0.f));
+        ozz::math::Float4x4 output[11];
+        ozz::math::Float3x4 affine_output[11];
+        for (int i = 0; i < num_joints; ++i) {
+          output[i] = init;
+          affine_output[i] = ozz::math::Float3x4::FromFloat4x4(init);
+        }
+
+        LocalToModelJob job;
+        job.skeleton = skeleton.get();
+        job.root = &root;
+        job.from = from;
+        job.to = to;
+        job.from_excluded = excluded != 0;
+        job.input = input;
+        job.output = output;
+        ASSERT_TRUE(job.Run());
+
+        LocalToModelJob affine_job = job;
+        affine_job.output = {};
+        affine_job.affine_output = affine_output;
+        ASSERT_TRUE(affine_job.Run());
+
+        for (int i = 0; i < num_joints; ++i) {
+          const ozz::math::Float4x4 affine =
+              ozz::math::ToFloat4x4(affine_output[i]);
+          for (int c = 0; c < 4; ++c) {
+            float expected[4];
+            float actual[4];
+            ozz::math::StorePtrU(output[i].cols[c], expected);
+            ozz::math::StorePtrU(affine.cols[c], actual);
+            for (int r = 0; r < 4; ++r) {
+              EXPECT_NEAR(expected[r], actual[r],
+                          1e-5f * (1.f + std::fabs(expected[r])));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(Dirty, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSoaSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f),
+        ozz::math::simd_float4::Load(1.f, -2.f, 3.f, -4.f),
+        ozz::math::simd_float4::Load(-f, 2.f, -f, .5f));
+  }
+
+  uint8_t dirty[2] = {0xff, 0xff};
+
+  {  // Validity.
+    ozz::math::Float4x4 output[11];
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.output = output;
+    job.dirty = dirty;
+    EXPECT_TRUE(job.Validate());
+    job.dirty = {dirty, 1};
+    EXPECT_FALSE(job.Validate());
+  }
+
+  // Computes model-space matrices with the original input.
+  ozz::math::Float4x4 output[11];
+  ozz::math::SoaFloat4x4 soa_output[3];
+  ozz::math::Float3x4 affine_output[11];
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = input;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  job.output = {};
+  job.soa_output = soa_output;
+  ASSERT_TRUE(job.Run());
+  job.soa_output = {};
+  job.affine_output = affine_output;
+  ASSERT_TRUE(job.Run());
+  job.affine_output = {};
+
+  // Changes j4 and j9 local transforms, and flags them dirty.
+  input[1].translation.x =
+      ozz::math::simd_float4::Load(46.f, 5.f, 6.f, 7.f);
+  input[2].translation.y =
+      ozz::math::simd_float4::Load(1.f, 93.f, 3.f, -4.f);
+  dirty[0] = 1 << 4;
+  dirty[1] = 1 << (9 - 8);
+  uint8_t soa_dirty[2] = {dirty[0], dirty[1]};
+  uint8_t affine_dirty[2] = {dirty[0], dirty[1]};
+
+  // Joint j1 isn't a descendant of a dirty joint, its output is preserved.
+  const ozz::math::Float4x4 sentinel = ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(46.f, 46.f, 46.f, 0.f));
+  output[1] = sentinel;
+  affine_output[1] = ozz::math::Float3x4::FromFloat4x4(sentinel);
+
+  job.dirty = dirty;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  job.output = {};
+  job.dirty = soa_dirty;
+  job.soa_output = soa_output;
+  ASSERT_TRUE(job.Run());
+  job.soa_output = {};
+  job.dirty = affine_dirty;
+  job.affine_output = affine_output;
+  ASSERT_TRUE(job.Run());
+
+  // Dirty flags were propagated to j4 and j9 descendants.
+  EXPECT_EQ(dirty[0], (1 << 4) | (1 << 5) | (1 << 6));
+  EXPECT_EQ(dirty[1], (1 << (9 - 8)) | (1 << (10 - 8)));
+  EXPECT_EQ(soa_dirty[0], dirty[0]);
+  EXPECT_EQ(soa_dirty[1], dirty[1]);
+  EXPECT_EQ(affine_dirty[0], dirty[0]);
+  EXPECT_EQ(affine_dirty[1], dirty[1]);
+
+  EXPECT_FLOAT4x4_EQ(output[1], 46.f, 0.f, 0.f, 0.f, 0.f, 46.f, 0.f, 0.f,
+                     0.f, 0.f, 46.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+  output[1] = ToFloat4x4(affine_output[1]);
+  EXPECT_FLOAT4x4_EQ(output[1], 46.f, 0.f, 0.f, 0.f, 0.f, 46.f, 0.f, 0.f,
+                     0.f, 0.f, 46.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+
+  // Other joints match a full update.
+  ozz::math::Float4x4 expected[11];
+  LocalToModelJob full_job;
+  full_job.skeleton = skeleton.get();
+  full_job.input = input;
+  full_job.output = expected;
+  ASSERT_TRUE(full_job.Run());
+  output[1] = expected[1];
+  ExpectSoaOutputEq(expected, soa_output, num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    if (i == 1) {
+      continue;
+    }
+    const ozz::math::Float4x4 affine = ToFloat4x4(affine_output[i]);
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(output[i].cols[c],
+                              ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+      EXPECT_SIMDFLOAT_EQ_EST(affine.cols[c],
+                              ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+    }
+  }
+}
+
+TEST(SkinningMatrices, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSoaSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f),
+        ozz::math::simd_float4::Load(1.f, -2.f, 3.f, -4.f),
+        ozz::math::simd_float4::Load(-f, 2.f, -f, .5f));
+  }
+
+  const uint16_t remaps[] = {1, 3, 4, 8, 10};
+  ozz::math::Float4x4 inverse_bind_poses[5];
+  for (int i = 0; i < 5; ++i) {
+    const float f = static_cast<float>(i);
+    inverse_bind_poses[i] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(-f, f * 2.f, 1.f, 0.f));
+  }
+  ozz::math::Float4x4 output[11];
+  ozz::math::Float4x4 skinning_matrices[5];
+
+  {  // Validity.
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.output = output;
+    job.joint_remaps = remaps;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.skinning_matrices = skinning_matrices;
+    EXPECT_TRUE(job.Validate());
+
+    // Palette too small.
+    job.skinning_matrices = {skinning_matrices, 4};
+    EXPECT_FALSE(job.Validate());
+    job.skinning_matrices = skinning_matrices;
+
+    // Inverse bind poses too small.
+    job.inverse_bind_poses = {inverse_bind_poses, 4};
+    EXPECT_FALSE(job.Validate());
+    job.inverse_bind_poses = inverse_bind_poses;
+
+    // Unsorted remaps.
+    const uint16_t unsorted[] = {1, 4, 3};
+    job.joint_remaps = unsorted;
+    EXPECT_FALSE(job.Validate());
+
+    // Out of range remaps.
+    const uint16_t out_of_range[] = {1, 11};
+    job.joint_remaps = out_of_range;
+    EXPECT_FALSE(job.Validate());
+    job.joint_remaps = remaps;
+
+    // Unsupported with affine output.
+    ozz::math::Float3x4 affine_output[11];
+    job.output = {};
+    job.affine_output = affine_output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Whole hierarchy.
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.output = output;
+    job.joint_remaps = remaps;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.skinning_matrices = skinning_matrices;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < 5; ++i) {
+      const ozz::math::Float4x4 expected =
+          output[remaps[i]] * inverse_bind_poses[i];
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(skinning_matrices[i].cols[c],
+                            ozz::math::GetX(expected.cols[c]),
+                            ozz::math::GetY(expected.cols[c]),
+                            ozz::math::GetZ(expected.cols[c]),
+                            ozz::math::GetW(expected.cols[c]));
+      }
+    }
+  }
+
+  {  // Partial update from j3 only writes j3 descendants skinning matrices.
+    const ozz::math::Float4x4 sentinel = ozz::math::Float4x4::Scaling(
+        ozz::math::simd_float4::Load(46.f, 46.f, 46.f, 0.f));
+    for (ozz::math::Float4x4& matrix : skinning_matrices) {
+      matrix = sentinel;
+    }
+
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.output = output;
+    job.from = 3;
+    job.joint_remaps = remaps;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.skinning_matrices = skinning_matrices;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < 5; ++i) {
+      const bool updated = remaps[i] >= 3 && remaps[i] <= 8;
+      const ozz::math::Float4x4 expected =
+          updated ? output[remaps[i]] * inverse_bind_poses[i] : sentinel;
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(skinning_matrices[i].cols[c],
+                            ozz::math::GetX(expected.cols[c]),
+                            ozz::math::GetY(expected.cols[c]),
+                            ozz::math::GetZ(expected.cols[c]),
+                            ozz::math::GetW(expected.cols[c]));
+      }
+    }
+  }
+}
+
+namespace {
+// Expects dual quaternion _dq to transform points as matrix _expected.
+void ExpectDualQuaternionEq(const ozz::math::SimdDualQuaternion& _dq,
+                            const ozz::math::Float4x4& _expected) {
+  const ozz::math::SimdFloat4 points[] = {
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, -2.f, 3.f, 1.f),
+      ozz::math::simd_float4::Load(-4.f, 5.f, .5f, 1.f)};
+  for (const ozz::math::SimdFloat4& point : points) {
+    const ozz::math::SimdFloat4 expected = TransformPoint(_expected, point);
+    EXPECT_SIMDFLOAT3_EQ_TOL(TransformPoint(_dq, point),
+                             ozz::math::GetX(expected),
+                             ozz::math::GetY(expected),
+                             ozz::math::GetZ(expected), 1e-4f);
+  }
+}
+}  // namespace
+
+TEST(DualQuaternionOutput, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSoaSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  // Rigid transformations only, as dual quaternions don't support scale.
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f),
+        ozz::math::simd_float4::Load(1.f, -2.f, 3.f, -4.f),
+        ozz::math::simd_float4::Load(-f, 2.f, -f, .5f));
+    input[i].rotation = ozz::math::SoaQuaternion::Load(
+        ozz::math::simd_float4::Load(.5f, 0.f, .70710677f, 0.f),
+        ozz::math::simd_float4::Load(.5f, .70710677f, 0.f, 0.f),
+        ozz::math::simd_float4::Load(.5f, 0.f, 0.f, .70710677f),
+        ozz::math::simd_float4::Load(.5f, .70710677f, .70710677f, .70710677f));
+  }
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(10.f, -20.f, 30.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, .70710677f),
+      ozz::math::simd_float4::one());
+
+  // Reference model-space matrices.
+  ozz::math::Float4x4 expected[11];
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.root = &root;
+    job.input = input;
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+  }
+
+  const uint16_t remaps[] = {1, 3, 4, 8, 10};
+  ozz::math::SimdDualQuaternion inverse_binds[5];
+  for (int i = 0; i < 5; ++i) {
+    const float f = static_cast<float>(i);
+    inverse_binds[i] = ozz::math::SimdDualQuaternion::FromRotationTranslation(
+        ozz::math::SimdQuaternion::identity(),
+        ozz::math::simd_float4::Load(-f, f * 2.f, 1.f, 0.f));
+  }
+  ozz::math::SimdDualQuaternion output[11];
+  ozz::math::SimdDualQuaternion skinning[5];
+
+  {  // Validity.
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.dual_quaternion_output = output;
+    EXPECT_TRUE(job.Validate());
+
+    // Output too small.
+    job.dual_quaternion_output = {output, 10};
+    EXPECT_FALSE(job.Validate());
+    job.dual_quaternion_output = output;
+
+    // More than one output.
+    job.output = expected;
+    EXPECT_FALSE(job.Validate());
+    job.output = {};
+
+    job.joint_remaps = remaps;
+    job.inverse_bind_dual_quaternions = inverse_binds;
+    job.skinning_dual_quaternions = skinning;
+    EXPECT_TRUE(job.Validate());
+
+    // Palette too small.
+    job.skinning_dual_quaternions = {skinning, 4};
+    EXPECT_FALSE(job.Validate());
+    job.skinning_dual_quaternions = skinning;
+
+    // Inverse bind dual quaternions too small.
+    job.inverse_bind_dual_quaternions = {inverse_binds, 4};
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Whole hierarchy, with skinning palette.
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.root = &root;
+    job.input = input;
+    job.dual_quaternion_output = output;
+    job.joint_remaps = remaps;
+    job.inverse_bind_dual_quaternions = inverse_binds;
+    job.skinning_dual_quaternions = skinning;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < 11; ++i) {
+      ExpectDualQuaternionEq(output[i], expected[i]);
+    }
+    for (int i = 0; i < 5; ++i) {
+      const float f = static_cast<float>(i);
+      const ozz::math::Float4x4 inverse_bind = ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(-f, f * 2.f, 1.f, 0.f));
+      ExpectDualQuaternionEq(skinning[i], expected[remaps[i]] * inverse_bind);
+    }
+  }
+
+  {  // Partial update from j3 only writes j3 descendants.
+    const ozz::math::SimdDualQuaternion sentinel = {
+        {ozz::math::simd_float4::Load1(46.f)},
+        {ozz::math::simd_float4::Load1(46.f)}};
+    for (ozz::math::SimdDualQuaternion& dq : output) {
+      dq = sentinel;
+    }
+    output[0] = ozz::math::SimdDualQuaternion::identity();
+
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.root = &root;
+    job.input = input;
+    job.dual_quaternion_output = output;
+    job.from = 3;
+    ASSERT_TRUE(job.Run());
+
+    // j3 parent is j0, which was set to identity.
+    ozz::math::Float4x4 j3_expected[11];
+    {
+      LocalToModelJob reference;
+      reference.skeleton = skeleton.get();
+      reference.input = input;
+      reference.output = j3_expected;
+      ASSERT_TRUE(reference.Run());
+    }
+    const ozz::math::Float4x4 inv_j0 = Invert(j3_expected[0]);
+    for (int i = 0; i < 11; ++i) {
+      if (i >= 3 && i <= 8) {
+        ExpectDualQuaternionEq(output[i], inv_j0 * j3_expected[i]);
+      } else if (i != 0) {
+        EXPECT_SIMDFLOAT_EQ(output[i].real.xyzw, 46.f, 46.f, 46.f, 46.f);
+      }
+    }
+  }
+}
+
+TEST(Subtrees, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSoaSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f),
+        ozz::math::simd_float4::Load(1.f, -2.f, 3.f, -4.f),
+        ozz::math::simd_float4::Load(-f, 2.f, -f, .5f));
+  }
+
+  // j5 is part of j4 subtree, it's skipped.
+  const int subtrees[] = {1, 4, 5, 9};
+
+  {  // Validity.
+    ozz::math::Float4x4 output[11];
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.input = input;
+    job.output = output;
+    job.subtrees = subtrees;
+    EXPECT_TRUE(job.Validate());
+
+    // Unsorted subtrees.
+    const int unsorted[] = {4, 1};
+    job.subtrees = unsorted;
+    EXPECT_FALSE(job.Validate());
+
+    // Invalid joint indices.
+    const int negative[] = {-1, 4};
+    job.subtrees = negative;
+    EXPECT_FALSE(job.Validate());
+    const int out_of_range[] = {4, 11};
+    job.subtrees = out_of_range;
+    EXPECT_FALSE(job.Validate());
+    job.subtrees = subtrees;
+
+    // Unsupported with "from" and "from_excluded".
+    job.from = 0;
+    EXPECT_FALSE(job.Validate());
+    job.from = Skeleton::kNoParent;
+    job.from_excluded = true;
+    EXPECT_FALSE(job.Validate());
+    job.from_excluded = false;
+  }
+
+  // Computes model-space matrices with the original input.
+  ozz::math::Float4x4 previous[11];
+  ozz::math::Float4x4 output[11];
+  ozz::math::SoaFloat4x4 soa_output[3];
+  ozz::math::Float3x4 affine_output[11];
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = input;
+  job.output = previous;
+  ASSERT_TRUE(job.Run());
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  job.output = {};
+  job.soa_output = soa_output;
+  ASSERT_TRUE(job.Run());
+  job.soa_output = {};
+  job.affine_output = affine_output;
+  ASSERT_TRUE(job.Run());
+  job.affine_output = {};
+
+  // Changes subtrees joints local transforms.
+  input[0].translation.y = input[0].translation.y +
+                           ozz::math::simd_float4::Load(0.f, 10.f, 10.f, 0.f);
+  input[1].translation.y = input[1].translation.y +
+                           ozz::math::simd_float4::Load(10.f, 10.f, 10.f, 0.f);
+  input[2].translation.y = input[2].translation.y +
+                           ozz::math::simd_float4::Load(0.f, 10.f, 10.f, 0.f);
+  ozz::math::Float4x4 updated[11];
+  job.output = updated;
+  ASSERT_TRUE(job.Run());
+
+  // Joints j7 and j8 aren't part of a subtree, their output is preserved.
+  const ozz::math::Float4x4 sentinel = ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(46.f, 46.f, 46.f, 0.f));
+  previous[7] = previous[8] = sentinel;
+  output[7] = output[8] = sentinel;
+  affine_output[7] = affine_output[8] =
+      ozz::math::Float3x4::FromFloat4x4(sentinel);
+  for (int joint = 7; joint <= 8; ++joint) {
+    float* lane =
+        reinterpret_cast<float*>(&soa_output[joint / 4]) + (joint & 3);
+    for (int c = 0; c < 4; ++c) {
+      float col[4];
+      ozz::math::StorePtrU(sentinel.cols[c], col);
+      for (int r = 0; r < 4; ++r) {
+        lane[(c * 4 + r) * 4] = col[r];
+      }
+    }
+  }
+
+  job.subtrees = subtrees;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  job.output = {};
+  job.soa_output = soa_output;
+  ASSERT_TRUE(job.Run());
+  job.soa_output = {};
+  job.affine_output = affine_output;
+  ASSERT_TRUE(job.Run());
+
+  const bool in_subtrees[11] = {false, true,  true,  false, true, true,
+                                true,  false, false, true,  true};
+  ozz::math::Float4x4 expected[OZZ_ARRAY_SIZE(in_subtrees)];
+  ASSERT_EQ(num_joints, static_cast<int>(OZZ_ARRAY_SIZE(expected)));
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+    expected[i] = in_subtrees[i] ? updated[i] : previous[i];
+  }
+  ExpectSoaOutputEq(expected, soa_output, num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const ozz::math::Float4x4 affine = ToFloat4x4(affine_output[i]);
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(output[i].cols[c],
+                              ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+      EXPECT_SIMDFLOAT_EQ_EST(affine.cols[c],
+                              ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+    }
+  }
+
+  {  // "to" ends the update, j9 subtree is after j6 so it isn't updated.
+    ozz::math::Float4x4 partial[11];
+    for (int i = 0; i < num_joints; ++i) {
+      partial[i] = previous[i];
+    }
+    LocalToModelJob to_job;
+    to_job.skeleton = skeleton.get();
+    to_job.input = input;
+    to_job.output = partial;
+    to_job.subtrees = subtrees;
+    to_job.to = 6;
+    ASSERT_TRUE(to_job.Run());
+    for (int i = 0; i < num_joints; ++i) {
+      const ozz::math::Float4x4& ref =
+          in_subtrees[i] && i <= 6 ? updated[i] : previous[i];
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ_EST(partial[i].cols[c],
+                                ozz::math::GetX(ref.cols[c]),
+                                ozz::math::GetY(ref.cols[c]),
+                                ozz::math::GetZ(ref.cols[c]),
+                                ozz::math::GetW(ref.cols[c]));
+      }
+    }
+  }
+}
+
+namespace {
+// Expects _output to be _full for _updated joints, and _sentinel otherwise.
+void ExpectLodOutputEq(const ozz::math::Float4x4* _output,
+                       const ozz::math::Float4x4* _full,
+                       const ozz::math::Float4x4& _sentinel,
+                       const bool* _updated, int _num_joints) {
+  for (int i = 0; i < _num_joints; ++i) {
+    const ozz::math::Float4x4& ref = _updated[i] ? _full[i] : _sentinel;
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(_output[i].cols[c], ozz::math::GetX(ref.cols[c]),
+                              ozz::math::GetY(ref.cols[c]),
+                              ozz::math::GetZ(ref.cols[c]),
+                              ozz::math::GetW(ref.cols[c]));
+    }
+  }
+}
+}  // namespace
+
+TEST(Lods, LocalToModel) {
+  // 7 joints, with LODs in brackets: j0[0] -> (j1[0] -> j2[1] -> j3[2],
+  // j4[0] -> j5[1]), j6[2].
+  // Skeleton order is j0, j1, j4, j2, j5, j3, j6.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.name = "j0";
+  j0.children.resize(2);
+  j0.children[0].name = "j1";
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].name = "j2";
+  j0.children[0].children[0].lod = 1;
+  j0.children[0].children[0].children.resize(1);
+  j0.children[0].children[0].children[0].name = "j3";
+  j0.children[0].children[0].children[0].lod = 2;
+  j0.children[1].name = "j4";
+  j0.children[1].children.resize(1);
+  j0.children[1].children[0].name = "j5";
+  j0.children[1].children[0].lod = 1;
+  raw_skeleton.roots[1].name = "j6";
+  raw_skeleton.roots[1].lod = 2;
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_lods(), 3);
+  const int num_joints = skeleton->num_joints();
+
+  ozz::math::SoaTransform input[2];
+  for (int i = 0; i < 2; ++i) {
+    const float f = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f),
+        ozz::math::simd_float4::Load(1.f, -2.f, 3.f, -4.f),
+        ozz::math::simd_float4::Load(-f, 2.f, -f, .5f));
+  }
+
+  // Reference, full update.
+  ozz::math::Float4x4 full[7];
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = input;
+  job.output = full;
+  ASSERT_TRUE(job.Run());
+
+  const ozz::math::Float4x4 sentinel = ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(46.f, 46.f, 46.f, 0.f));
+  ozz::math::Float4x4 output[7];
+
+  {  // Coarsest LOD only.
+    for (int i = 0; i < num_joints; ++i) {
+      output[i] = sentinel;
+    }
+    job.output = output;
+    job.to = skeleton->lod_num_joints()[0] - 1;
+    ASSERT_TRUE(job.Run());
+    const bool updated[7] = {true, true, true, false, false, false, false};
+    ExpectLodOutputEq(output, full, sentinel, updated, num_joints);
+    job.to = Skeleton::kMaxJoints;
+  }
+
+  {  // j1 hierarchy range also contains j4 and j5, which aren't descendants
+     // so they aren't updated.
+    for (int i = 0; i < num_joints; ++i) {
+      output[i] = i == 0 ? full[i] : sentinel;
+    }
+    job.from = 1;
+    ASSERT_TRUE(job.Run());
+    const bool updated[7] = {true, true, false, true, false, true, false};
+    ExpectLodOutputEq(output, full, sentinel, updated, num_joints);
+    job.from = Skeleton::kNoParent;
+  }
+
+  {  // Same with j1 excluded.
+    for (int i = 0; i < num_joints; ++i) {
+      output[i] = i <= 1 ? full[i] : sentinel;
+    }
+    job.from = 1;
+    job.from_excluded = true;
+    ASSERT_TRUE(job.Run());
+    const bool updated[7] = {true, true, false, true, false, true, false};
+    ExpectLodOutputEq(output, full, sentinel, updated, num_joints);
+    job.from = Skeleton::kNoParent;
+    job.from_excluded = false;
+  }
+
+  {  // j2 is in j4 subtree range [2, 5), but its subtree ends further with j3.
+    for (int i = 0; i < num_joints; ++i) {
+      output[i] = i <= 1 ? full[i] : sentinel;
+    }
+    const int subtrees[] = {2, 3};
+    job.subtrees = subtrees;
+    ASSERT_TRUE(job.Run());
+    const bool updated[7] = {true, true, true, true, true, true, false};
+    ExpectLodOutputEq(output, full, sentinel, updated, num_joints);
+  }
+
+  {  // j4 isn't a descendant of j1, but it's in j1 subtree range [1, 6).
+    for (int i = 0; i < num_joints; ++i) {
+      output[i] = i == 0 ? full[i] : sentinel;
+    }
+    const int subtrees[] = {1, 2};
+    job.subtrees = subtrees;
+    ASSERT_TRUE(job.Run());
+    const bool updated[7] = {true, true, true, true, true, true, false};
+    ExpectLodOutputEq(output, full, sentinel, updated, num_joints);
+    job.subtrees = {};
+  }
+
+  {  // Same as j1 hierarchy, using a scratch buffer instead of the stack.
+    for (int i = 0; i < num_joints; ++i) {
+      output[i] = i == 0 ? full[i] : sentinel;
+    }
+    uint8_t scratch[1];
+    job.scratch = scratch;
+    job.from = 1;
+    ASSERT_TRUE(job.Run());
+    const bool updated[7] = {true, true, false, true, false, true, false};
+    ExpectLodOutputEq(output, full, sentinel, updated, num_joints);
+    job.scratch = {};
+    job.from = Skeleton::kNoParent;
+  }
+}
+
+TEST(LodsScratch, LocalToModel) {
+  // A root with kMaxStackJoints children, the last one being part of a finer
+  // LOD.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(LocalToModelJob::kMaxStackJoints);
+  for (size_t i = 0; i < root.children.size(); ++i) {
+    root.children[i].name = "child";
+  }
+  root.children.back().lod = 1;
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_lods(), 2);
+  const int num_joints = skeleton->num_joints();
+  ASSERT_GT(num_joints, LocalToModelJob::kMaxStackJoints);
+
+  ozz::vector<ozz::math::SoaTransform> input(
+      (num_joints + 3) / 4, ozz::math::SoaTransform::identity());
+  ozz::vector<ozz::math::Float4x4> output(num_joints);
+  ozz::vector<uint8_t> scratch((num_joints + 7) / 8);
+
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = make_span(input);
+  job.output = make_span(output);
+
+  // Full updates don't need a bitset.
+  EXPECT_TRUE(job.Run());
+
+  // Partial updates need a scratch buffer.
+  const int subtrees[] = {1};
+  job.subtrees = subtrees;
+  EXPECT_FALSE(job.Validate());
+  job.scratch = {scratch.data(), scratch.size() - 1};
+  EXPECT_FALSE(job.Validate());
+  job.scratch = make_span(scratch);
+  EXPECT_TRUE(job.Run());
+  job.subtrees = {};
+
+  job.scratch = {};
+  job.from = 0;
+  EXPECT_FALSE(job.Validate());
+  job.scratch = make_span(scratch);
+  EXPECT_TRUE(job.Run());
+
+  // "from" outside of "to" range updates nothing, so it doesn't need a bitset.
+  job.scratch = {};
+  job.to = 0;
+  job.from = 1;
+  EXPECT_TRUE(job.Run());
+}
@@ -0,0 +1,237 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_graph.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::PoseGraph;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "child";
+  raw_skeleton.roots[0].children[0].transform.translation =
+      ozz::math::Float3::y_axis();
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds an animation with a constant root translation along x, and a unit
+// child translation along y.
+ozz::unique_ptr<Animation> BuildAnimation(int _num_tracks, float _x) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(_x, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  const RawAnimation::TranslationKey child_key = {0.f,
+                                                  ozz::math::Float3::y_axis()};
+  raw_animation.tracks[1].translations.push_back(child_key);
+  return AnimationBuilder()(raw_animation);
+}
+}  // namespace
+
+TEST(Build, PoseGraph) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  ozz::unique_ptr<Animation> animation = BuildAnimation(2, 1.f);
+  ASSERT_TRUE(animation);
+  ozz::unique_ptr<Animation> invalid_animation = BuildAnimation(3, 1.f);
+  ASSERT_TRUE(invalid_animation);
+
+  {  // Invalid blending nodes.
+    PoseGraph graph;
+    EXPECT_EQ(graph.AddBlendingNode({}, {}), -1);
+    const int inputs[] = {0};
+    EXPECT_EQ(graph.AddBlendingNode(inputs, {}), -1);
+    EXPECT_EQ(graph.AddSamplingNode(*animation), 0);
+    EXPECT_EQ(graph.AddBlendingNode(inputs, {}), 1);
+    const int invalid_inputs[] = {0, 2};
+    EXPECT_EQ(graph.AddBlendingNode(invalid_inputs, {}), -1);
+    EXPECT_EQ(graph.AddBlendingNode({}, invalid_inputs), -1);
+    EXPECT_EQ(graph.num_nodes(), 2);
+  }
+
+  {  // Invalid compilation.
+    PoseGraph graph;
+    EXPECT_FALSE(graph.Compile(*skeleton, 0));
+    EXPECT_EQ(graph.AddSamplingNode(*animation), 0);
+    EXPECT_FALSE(graph.Compile(*skeleton, 1));
+    EXPECT_FALSE(graph.Compile(*skeleton, -1));
+    EXPECT_FALSE(graph.compiled());
+    EXPECT_FALSE(graph.Evaluate({}, {}));
+  }
+
+  {  // Animation doesn't match skeleton.
+    PoseGraph graph;
+    EXPECT_EQ(graph.AddSamplingNode(*invalid_animation), 0);
+    EXPECT_FALSE(graph.Compile(*skeleton, 0));
+  }
+
+  {  // Can't modify compiled graph.
+    PoseGraph graph;
+    EXPECT_EQ(graph.AddSamplingNode(*animation), 0);
+    EXPECT_TRUE(graph.Compile(*skeleton, 0));
+    EXPECT_TRUE(graph.compiled());
+    EXPECT_FALSE(graph.Compile(*skeleton, 0));
+    EXPECT_EQ(graph.AddSamplingNode(*animation), -1);
+    const int inputs[] = {0};
+    EXPECT_EQ(graph.AddBlendingNode(inputs, {}), -1);
+  }
+
+  {  // Parameters.
+    PoseGraph graph;
+    EXPECT_EQ(graph.AddSamplingNode(*animation), 0);
+    const int inputs[] = {0};
+    EXPECT_EQ(graph.AddBlendingNode(inputs, inputs), 1);
+    EXPECT_TRUE(graph.SetRatio(0, .5f));
+    EXPECT_FALSE(graph.SetRatio(1, .5f));
+    EXPECT_FALSE(graph.SetRatio(2, .5f));
+    EXPECT_FALSE(graph.SetWeight(0, 0, 1.f));
+    EXPECT_TRUE(graph.SetWeight(1, 0, 1.f));
+    EXPECT_TRUE(graph.SetWeight(1, 1, 1.f));
+    EXPECT_FALSE(graph.SetWeight(1, 2, 1.f));
+    EXPECT_FALSE(graph.SetWeight(1, -1, 1.f));
+    EXPECT_FALSE(graph.SetJointWeights(0, 0, {}));
+    EXPECT_TRUE(graph.SetJointWeights(1, 0, {}));
+    EXPECT_FALSE(graph.SetJointWeights(1, 2, {}));
+  }
+}
+
+TEST(Evaluate, PoseGraph) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  ozz::unique_ptr<Animation> animations[4];
+  for (int i = 0; i < 4; ++i) {
+    animations[i] = BuildAnimation(2, static_cast<float>(i + 1));
+    ASSERT_TRUE(animations[i]);
+  }
+
+  // Chain of blends: ((s0, s1), s2), s3.
+  PoseGraph graph;
+  int samplers[4];
+  for (int i = 0; i < 4; ++i) {
+    samplers[i] = graph.AddSamplingNode(*animations[i]);
+  }
+  const int b0_inputs[] = {samplers[0], samplers[1]};
+  const int b0 = graph.AddBlendingNode(b0_inputs, {});
+  const int b1_inputs[] = {b0, samplers[2]};
+  const int b1 = graph.AddBlendingNode(b1_inputs, {});
+  const int b2_inputs[] = {b1, samplers[3]};
+  const int b2 = graph.AddBlendingNode(b2_inputs, {});
+
+  // Unused node isn't evaluated.
+  graph.AddSamplingNode(*animations[0]);
+
+  ASSERT_TRUE(graph.Compile(*skeleton, b2));
+
+  // 7 nodes are evaluated, but at most 3 buffers are alive at once.
+  EXPECT_EQ(graph.num_buffers(), 3);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(graph.SetWeight(b0 + i, 0, .5f));
+    EXPECT_TRUE(graph.SetWeight(b0 + i, 1, .5f));
+  }
+
+  ozz::math::SoaTransform locals[1];
+  ozz::math::Float4x4 models[2];
+
+  // Output buffers too small.
+  EXPECT_FALSE(graph.Evaluate({locals, static_cast<size_t>(0)}, {models, 1}));
+
+  // Local space only.
+  ASSERT_TRUE(graph.Evaluate(locals, {}));
+  // (((1 + 2) / 2 + 3) / 2 + 4) / 2 = 3.125
+  EXPECT_SOAFLOAT3_EQ_EST(locals[0].translation, 3.125f, 0.f, 0.f, 0.f, 0.f,
+                          1.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Model space only.
+  ASSERT_TRUE(graph.Evaluate({}, models));
+  EXPECT_FLOAT4x4_EQ(models[0], 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 3.125f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(models[1], 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 3.125f, 1.f, 0.f, 1.f);
+
+  // Changes weights.
+  EXPECT_TRUE(graph.SetWeight(b2, 0, 0.f));
+  ASSERT_TRUE(graph.Evaluate(locals, models));
+  EXPECT_SOAFLOAT3_EQ_EST(locals[0].translation, 4.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_FLOAT4x4_EQ(models[1], 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 4.f, 1.f, 0.f, 1.f);
+}
+
+TEST(SharedInput, PoseGraph) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  ozz::unique_ptr<Animation> a0 = BuildAnimation(2, 2.f);
+  ozz::unique_ptr<Animation> a1 = BuildAnimation(2, 1.f);
+  ASSERT_TRUE(a0 && a1);
+
+  // s0 is used by two nodes, and as an additive input.
+  PoseGraph graph;
+  const int s0 = graph.AddSamplingNode(*a0);
+  const int s1 = graph.AddSamplingNode(*a1);
+  const int b0_inputs[] = {s0, s1};
+  const int b0 = graph.AddBlendingNode(b0_inputs, {});
+  const int b1_inputs[] = {b0};
+  const int b1_additives[] = {s0};
+  const int b1 = graph.AddBlendingNode(b1_inputs, b1_additives);
+  ASSERT_TRUE(graph.Compile(*skeleton, b1));
+  EXPECT_EQ(graph.num_buffers(), 3);
+
+  EXPECT_TRUE(graph.SetWeight(b0, 0, 1.f));
+  EXPECT_TRUE(graph.SetWeight(b0, 1, 1.f));
+  EXPECT_TRUE(graph.SetWeight(b1, 0, 1.f));
+  EXPECT_TRUE(graph.SetWeight(b1, 1, 1.f));
+
+  ozz::math::SoaTransform locals[1];
+  ASSERT_TRUE(graph.Evaluate(locals, {}));
+  // Root x is (2 + 1) / 2 + 2 = 3.5, child y is 1 + 1 = 2.
+  EXPECT_SOAFLOAT3_EQ_EST(locals[0].translation, 3.5f, 0.f, 0.f, 0.f, 0.f,
+                          2.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+}
@@ -0,0 +1,222 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/root_motion_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/track_builder.h"
+
+#include "ozz/animation/runtime/track.h"
+
+using ozz::animation::Float3Track;
+using ozz::animation::QuaternionTrack;
+using ozz::animation::RootMotionJob;
+using ozz::animation::offline::RawFloat3Track;
+using ozz::animation::offline::RawQuaternionTrack;
+using ozz::animation::offline::RawTrackInterpolation;
+using ozz::animation::offline::TrackBuilder;
+
+TEST(JobValidity, RootMotionJob) {
+  TrackBuilder builder;
+  RawFloat3Track raw_position;
+  ozz::unique_ptr<Float3Track> position(builder(raw_position));
+  ASSERT_TRUE(position);
+  RawQuaternionTrack raw_rotation;
+  ozz::unique_ptr<QuaternionTrack> rotation(builder(raw_rotation));
+  ASSERT_TRUE(rotation);
+
+  {  // Empty/default job
+    RootMotionJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No output
+    RootMotionJob job;
+    job.position = position.get();
+    job.rotation = rotation.get();
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No track
+    ozz::math::Transform delta;
+    RootMotionJob job;
+    job.delta = &delta;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Position only
+    ozz::math::Transform delta;
+    RootMotionJob job;
+    job.position = position.get();
+    job.delta = &delta;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Rotation only
+    ozz::math::Transform delta;
+    RootMotionJob job;
+    job.rotation = rotation.get();
+    job.delta = &delta;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Position, RootMotionJob) {
+  TrackBuilder builder;
+  RawFloat3Track raw_position;
+  const RawFloat3Track::Keyframe key0 = {RawTrackInterpolation::kLinear, 0.f,
+                                         ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_position.keyframes.push_back(key0);
+  const RawFloat3Track::Keyframe key1 = {RawTrackInterpolation::kLinear, 1.f,
+                                         ozz::math::Float3(5.f, 0.f, 2.f)};
+  raw_position.keyframes.push_back(key1);
+  ozz::unique_ptr<Float3Track> position(builder(raw_position));
+  ASSERT_TRUE(position);
+
+  ozz::math::Transform delta;
+  RootMotionJob job;
+  job.position = position.get();
+  job.delta = &delta;
+
+  // Within a cycle.
+  job.from = .25f;
+  job.to = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 2.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(delta.rotation, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT3_EQ(delta.scale, 1.f, 1.f, 1.f);
+
+  // Backward.
+  job.from = .75f;
+  job.to = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, -2.f, 0.f, -1.f);
+
+  // Full cycle.
+  job.from = 0.f;
+  job.to = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 4.f, 0.f, 2.f);
+
+  // Crossing loop end.
+  job.from = .75f;
+  job.to = 1.25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 2.f, 0.f, 1.f);
+
+  // Many cycles.
+  job.from = .5f;
+  job.to = 3.5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 12.f, 0.f, 6.f);
+
+  // Many cycles backward.
+  job.from = 1.5f;
+  job.to = -1.5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, -12.f, 0.f, -6.f);
+
+  // No loop clamps.
+  job.loop = false;
+  job.from = .75f;
+  job.to = 3.25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 1.f, 0.f, .5f);
+}
+
+TEST(PositionRotation, RootMotionJob) {
+  TrackBuilder builder;
+
+  // Moves forward (z) by 1 while turning 90 degrees around y.
+  RawFloat3Track raw_position;
+  const RawFloat3Track::Keyframe pkey0 = {RawTrackInterpolation::kLinear, 0.f,
+                                          ozz::math::Float3::zero()};
+  raw_position.keyframes.push_back(pkey0);
+  const RawFloat3Track::Keyframe pkey1 = {RawTrackInterpolation::kLinear, 1.f,
+                                          ozz::math::Float3(0.f, 0.f, 1.f)};
+  raw_position.keyframes.push_back(pkey1);
+  ozz::unique_ptr<Float3Track> position(builder(raw_position));
+  ASSERT_TRUE(position);
+
+  RawQuaternionTrack raw_rotation;
+  const RawQuaternionTrack::Keyframe rkey0 = {
+      RawTrackInterpolation::kLinear, 0.f, ozz::math::Quaternion::identity()};
+  raw_rotation.keyframes.push_back(rkey0);
+  const RawQuaternionTrack::Keyframe rkey1 = {
+      RawTrackInterpolation::kLinear, 1.f,
+      ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                           ozz::math::kPi_2)};
+  raw_rotation.keyframes.push_back(rkey1);
+  ozz::unique_ptr<QuaternionTrack> rotation(builder(raw_rotation));
+  ASSERT_TRUE(rotation);
+
+  ozz::math::Transform delta;
+  RootMotionJob job;
+  job.position = position.get();
+  job.rotation = rotation.get();
+  job.delta = &delta;
+
+  // One cycle.
+  job.from = 0.f;
+  job.to = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(delta.rotation, 0.f, .7071067f, 0.f, .7071067f);
+
+  // Two cycles, second cycle is turned by 90 degrees, moving along x.
+  job.from = 0.f;
+  job.to = 2.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 1.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(delta.rotation, 0.f, 1.f, 0.f, 0.f);
+
+  // Delta is expressed in "from" space.
+  job.from = 1.f;
+  job.to = 2.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(delta.rotation, 0.f, .7071067f, 0.f, .7071067f);
+
+  // Backward cycle.
+  job.from = 1.f;
+  job.to = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 1.f, 0.f, 0.f);
+  EXPECT_QUATERNION_EQ(delta.rotation, 0.f, -.7071067f, 0.f, .7071067f);
+}
@@ -30,6 +30,8 @@
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/unique_ptr.h"
@@ -655,3 +657,113 @@ TEST(CacheResize, SamplingJob) {
   context.Resize(1);
   EXPECT_FALSE(job.Validate());
 }
+
+TEST(MaxTracks, SamplingJob) {
+  // Tracks above 1024 are addressed by rotation keys 13 bits track index.
+  const int num_tracks = ozz::animation::Skeleton::kMaxJoints;
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(num_tracks);
+
+  // Key values are the index of the track in this array, plus one.
+  const int tracks[] = {0, 1023, 1024, num_tracks - 1};
+  for (int i = 0; i < 4; ++i) {
+    const int track = tracks[i];
+    const float f = static_cast<float>(i + 1);
+    const RawAnimation::TranslationKey translation = {
+        0.f, ozz::math::Float3(f, 0.f, 0.f)};
+    raw_animation.tracks[track].translations.push_back(translation);
+    const RawAnimation::RotationKey rotation = {
+        0.f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+    raw_animation.tracks[track].rotations.push_back(rotation);
+    const RawAnimation::ScaleKey scale = {0.f,
+                                          ozz::math::Float3(2.f, 2.f, f)};
+    raw_animation.tracks[track].scales.push_back(scale);
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_EQ(animation->num_tracks(), num_tracks);
+
+  SamplingJob::Context context(num_tracks);
+  ozz::vector<ozz::math::SoaTransform> output(
+      static_cast<size_t>(animation->num_soa_tracks()));
+
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.ratio = .5f;
+  job.output = ozz::make_span(output);
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < 4; ++i) {
+    const ozz::math::SoaTransform& soa = output[tracks[i] / 4];
+    const int lane = tracks[i] & 3;
+    float values[4];
+    ozz::math::StorePtrU(soa.translation.x, values);
+    EXPECT_FLOAT_EQ(values[lane], static_cast<float>(i + 1));
+    ozz::math::StorePtrU(soa.rotation.y, values);
+    EXPECT_FLOAT_EQ(values[lane], 1.f);
+    ozz::math::StorePtrU(soa.scale.z, values);
+    EXPECT_FLOAT_EQ(values[lane], static_cast<float>(i + 1));
+  }
+
+  // Other tracks are identity.
+  const ozz::math::SoaTransform& soa = output[1000 / 4];
+  EXPECT_SOAFLOAT3_EQ(soa.translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(Lod, SamplingJob) {
+  // 8 tracks, which translation x goes from 0 to track index + 1 in [0, .4],
+  // and stays still afterward.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);
+  for (int i = 0; i < 8; ++i) {
+    const float f = static_cast<float>(i + 1);
+    const RawAnimation::TranslationKey keys[] = {
+        {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+        {.4f, ozz::math::Float3(f, 0.f, 0.f)},
+        {1.f, ozz::math::Float3(f, 0.f, 0.f)}};
+    raw_animation.tracks[i].translations.assign(keys, keys + 3);
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(8);
+  ozz::math::SoaTransform output[2];
+  const ozz::math::SoaTransform sentinel = {
+      ozz::math::SoaFloat3::Load(ozz::math::simd_float4::Load1(-1.f),
+                                 ozz::math::simd_float4::zero(),
+                                 ozz::math::simd_float4::zero()),
+      ozz::math::SoaQuaternion::identity(), ozz::math::SoaFloat3::one()};
+  output[1] = sentinel;
+
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = ozz::make_span(output).first(1);
+
+  // Samples the first soa track only, moving all tracks keyframes cursor.
+  job.ratio = 0.f;
+  ASSERT_TRUE(job.Run());
+  job.ratio = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 2.f, 3.f, 4.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, -1.f, -1.f, -1.f, -1.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Samples all tracks at the same ratio. Second soa track keyframes must be
+  // decompressed, even though the cursor didn't move.
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 2.f, 3.f, 4.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 5.f, 6.f, 7.f, 8.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+}
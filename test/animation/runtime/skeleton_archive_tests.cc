@@ -29,6 +29,7 @@
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -77,6 +78,7 @@ TEST(Filled, SkeletonSerialize) {
     root.children.resize(2);
     root.children[0].name = "j0";
     root.children[1].name = "j1";
+    root.children[1].lod = 1;
 
     EXPECT_TRUE(raw_skeleton.Validate());
     EXPECT_EQ(raw_skeleton.num_joints(), 3);
@@ -106,6 +108,27 @@ TEST(Filled, SkeletonSerialize) {
     for (int i = 0; i < i_skeleton.num_joints(); ++i) {
       EXPECT_EQ(i_skeleton.joint_parents()[i], o_skeleton->joint_parents()[i]);
       EXPECT_STREQ(i_skeleton.joint_names()[i], o_skeleton->joint_names()[i]);
+      EXPECT_EQ(i_skeleton.joint_depths()[i], o_skeleton->joint_depths()[i]);
+      EXPECT_EQ(i_skeleton.joint_subtree_ends()[i],
+                o_skeleton->joint_subtree_ends()[i]);
+      EXPECT_EQ(i_skeleton.joint_first_children()[i],
+                o_skeleton->joint_first_children()[i]);
+      EXPECT_EQ(i_skeleton.joint_next_siblings()[i],
+                o_skeleton->joint_next_siblings()[i]);
+      EXPECT_EQ(i_skeleton.joint_name_hashes()[i],
+                o_skeleton->joint_name_hashes()[i]);
+    }
+    ASSERT_EQ(i_skeleton.joint_name_table().size(),
+              o_skeleton->joint_name_table().size());
+    for (size_t i = 0; i < i_skeleton.joint_name_table().size(); ++i) {
+      EXPECT_EQ(i_skeleton.joint_name_table()[i],
+                o_skeleton->joint_name_table()[i]);
+    }
+    EXPECT_EQ(FindJoint(i_skeleton, "j1"), 2);
+    ASSERT_EQ(i_skeleton.num_lods(), 2);
+    for (int i = 0; i < i_skeleton.num_lods(); ++i) {
+      EXPECT_EQ(i_skeleton.lod_num_joints()[i],
+                o_skeleton->lod_num_joints()[i]);
     }
     for (int i = 0; i < (i_skeleton.num_joints() + 3) / 4; ++i) {
       EXPECT_TRUE(
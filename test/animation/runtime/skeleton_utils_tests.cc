@@ -26,6 +26,7 @@
 //----------------------------------------------------------------------------//
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 
 #include "gtest/gtest.h"
@@ -33,6 +34,7 @@
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/gtest_helper.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/memory/unique_ptr.h"
@@ -435,4 +437,210 @@ TEST(Name, SkeletonUtils) {
 
   EXPECT_TRUE(FindJoint(*skeleton, "aj0") < 0);
   EXPECT_TRUE(FindJoint(*skeleton, "j0a") < 0);
-}
\ No newline at end of file
+}
+
+TEST(NameTable, SkeletonUtils) {
+  SkeletonBuilder builder;
+
+  {  // Empty skeleton.
+    RawSkeleton raw_skeleton;
+    ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+    ASSERT_TRUE(skeleton);
+    EXPECT_EQ(skeleton->joint_name_table().size(), 0u);
+    EXPECT_TRUE(FindJoint(*skeleton, "j0") < 0);
+  }
+
+  // Builds enough joints to have hash collisions modulo the table size. Last
+  // joint name is the same as the first one.
+  const int num_joints = 300;
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(num_joints);
+  for (int i = 0; i < num_joints - 1; ++i) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "joint%d", i);
+    raw_skeleton.roots[i].name = name;
+  }
+  raw_skeleton.roots[num_joints - 1].name = "joint0";
+
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  EXPECT_GE(skeleton->joint_name_table().size(), 2u * num_joints);
+
+  for (int i = 0; i < num_joints - 1; ++i) {
+    const char* name = skeleton->joint_names()[i];
+    const uint32_t hash = ozz::animation::HashJointName(name);
+    EXPECT_EQ(skeleton->joint_name_hashes()[i], hash);
+    EXPECT_EQ(FindJoint(*skeleton, name), i);
+    EXPECT_EQ(FindJoint(*skeleton, name, hash), i);
+  }
+
+  // The first joint with a name is found.
+  EXPECT_EQ(FindJoint(*skeleton, "joint0"), 0);
+
+  EXPECT_TRUE(FindJoint(*skeleton, "joint300") < 0);
+  EXPECT_TRUE(FindJoint(*skeleton, "") < 0);
+}
+TEST(SubtreeMask, SkeletonUtils) {
+  SkeletonBuilder builder;
+
+  // 6 joints: r0 -> (j0 -> j1, j2 -> (j3, j4))
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& r = raw_skeleton.roots[0];
+  r.name = "r0";
+  r.children.resize(2);
+  r.children[0].name = "j0";
+  r.children[0].children.resize(1);
+  r.children[0].children[0].name = "j1";
+  r.children[1].name = "j2";
+  r.children[1].children.resize(2);
+  r.children[1].children[0].name = "j3";
+  r.children[1].children[1].name = "j4";
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  uint16_t soa_indices[2];
+  ozz::math::SimdFloat4 joint_weights[2];
+
+  // Invalid root.
+  EXPECT_EQ(ComputeSubtreeMask(*skeleton, -1, 1.f, soa_indices, joint_weights),
+            0u);
+  EXPECT_EQ(ComputeSubtreeMask(*skeleton, 6, 1.f, soa_indices, joint_weights),
+            0u);
+
+  // Output too small.
+  EXPECT_EQ(ComputeSubtreeMask(*skeleton, 0, 1.f, {soa_indices, 1},
+                               joint_weights),
+            0u);
+  EXPECT_EQ(ComputeSubtreeMask(*skeleton, 0, 1.f, soa_indices,
+                               {joint_weights, 1}),
+            0u);
+
+  // Whole skeleton.
+  ASSERT_EQ(ComputeSubtreeMask(*skeleton, 0, 1.f, soa_indices, joint_weights),
+            2u);
+  EXPECT_EQ(soa_indices[0], 0);
+  EXPECT_EQ(soa_indices[1], 1);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[0], 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[1], 1.f, 1.f, 0.f, 0.f);
+
+  // j0 subtree.
+  const int j0 = FindJoint(*skeleton, "j0");
+  ASSERT_EQ(ComputeSubtreeMask(*skeleton, j0, .5f, soa_indices, joint_weights),
+            1u);
+  EXPECT_EQ(soa_indices[0], 0);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[0], 0.f, .5f, .5f, 0.f);
+
+  // j2 subtree, crosses soa boundary.
+  const int j2 = FindJoint(*skeleton, "j2");
+  ASSERT_EQ(ComputeSubtreeMask(*skeleton, j2, 1.f, soa_indices, joint_weights),
+            2u);
+  EXPECT_EQ(soa_indices[0], 0);
+  EXPECT_EQ(soa_indices[1], 1);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[0], 0.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[1], 1.f, 1.f, 0.f, 0.f);
+
+  // Leaf.
+  const int j4 = FindJoint(*skeleton, "j4");
+  ASSERT_EQ(ComputeSubtreeMask(*skeleton, j4, 1.f, soa_indices, joint_weights),
+            1u);
+  EXPECT_EQ(soa_indices[0], 1);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[0], 0.f, 1.f, 0.f, 0.f);
+}
+
+namespace {
+struct JointCollector {
+  void operator()(int _current, int) { joints.push_back(_current); }
+  ozz::vector<int> joints;
+};
+}  // namespace
+
+TEST(Lods, SkeletonUtils) {
+  SkeletonBuilder builder;
+
+  // 7 joints, with LODs in brackets: j0[0] -> (j1[0] -> j2[1] -> j3[2],
+  // j4[0] -> j5[1]), j6[2].
+  // Skeleton order is j0, j1, j4, j2, j5, j3, j6.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.name = "j0";
+  j0.children.resize(2);
+  j0.children[0].name = "j1";
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].name = "j2";
+  j0.children[0].children[0].lod = 1;
+  j0.children[0].children[0].children.resize(1);
+  j0.children[0].children[0].children[0].name = "j3";
+  j0.children[0].children[0].children[0].lod = 2;
+  j0.children[1].name = "j4";
+  j0.children[1].children.resize(1);
+  j0.children[1].children[0].name = "j5";
+  j0.children[1].children[0].lod = 1;
+  raw_skeleton.roots[1].name = "j6";
+  raw_skeleton.roots[1].lod = 2;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_lods(), 3);
+
+  const int j1 = FindJoint(*skeleton, "j1");
+  const int j2 = FindJoint(*skeleton, "j2");
+  const int j3 = FindJoint(*skeleton, "j3");
+  const int j4 = FindJoint(*skeleton, "j4");
+  const int j5 = FindJoint(*skeleton, "j5");
+  const int j6 = FindJoint(*skeleton, "j6");
+
+  // j4 is within j1 subtree range, but isn't a descendant.
+  EXPECT_TRUE(IsInSubtree(*skeleton, j1, j1));
+  EXPECT_TRUE(IsInSubtree(*skeleton, j1, j2));
+  EXPECT_TRUE(IsInSubtree(*skeleton, j1, j3));
+  EXPECT_FALSE(IsInSubtree(*skeleton, j1, j4));
+  EXPECT_FALSE(IsInSubtree(*skeleton, j1, j5));
+  EXPECT_TRUE(IsInSubtree(*skeleton, 0, j5));
+  EXPECT_FALSE(IsInSubtree(*skeleton, 0, j6));
+
+  EXPECT_FALSE(IsLeaf(*skeleton, j1));
+  EXPECT_FALSE(IsLeaf(*skeleton, j4));
+  EXPECT_TRUE(IsLeaf(*skeleton, j5));
+
+  // Iterates descendants only.
+  const JointCollector from_j1 =
+      IterateJointsDF(*skeleton, JointCollector(), j1);
+  ASSERT_EQ(from_j1.joints.size(), 3u);
+  EXPECT_EQ(from_j1.joints[0], j1);
+  EXPECT_EQ(from_j1.joints[1], j2);
+  EXPECT_EQ(from_j1.joints[2], j3);
+
+  const JointCollector from_j4 =
+      IterateJointsDF(*skeleton, JointCollector(), j4);
+  ASSERT_EQ(from_j4.joints.size(), 2u);
+  EXPECT_EQ(from_j4.joints[0], j4);
+  EXPECT_EQ(from_j4.joints[1], j5);
+
+  // Whole hierarchy is iterated depth-first, not in skeleton order.
+  const JointCollector all = IterateJointsDF(*skeleton, JointCollector());
+  const int expected[] = {0, j1, j2, j3, j4, j5, j6};
+  ASSERT_EQ(all.joints.size(), 7u);
+  for (size_t i = 0; i < all.joints.size(); ++i) {
+    EXPECT_EQ(all.joints[i], expected[i]);
+  }
+
+  // Subtree mask only weights descendants.
+  uint16_t soa_indices[2];
+  ozz::math::SimdFloat4 joint_weights[2];
+  ASSERT_EQ(ComputeSubtreeMask(*skeleton, j1, 1.f, soa_indices, joint_weights),
+            2u);
+  EXPECT_EQ(soa_indices[0], 0);
+  EXPECT_EQ(soa_indices[1], 1);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[0], 0.f, 1.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[1], 0.f, 1.f, 0.f, 0.f);
+
+  // j4 subtree range [2, 5) doesn't contain j2.
+  ASSERT_EQ(ComputeSubtreeMask(*skeleton, j4, .5f, soa_indices, joint_weights),
+            2u);
+  EXPECT_EQ(soa_indices[0], 0);
+  EXPECT_EQ(soa_indices[1], 1);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[0], 0.f, 0.f, .5f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(joint_weights[1], .5f, 0.f, 0.f, 0.f);
+}
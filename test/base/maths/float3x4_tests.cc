@@ -0,0 +1,115 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/base/maths/float3x4.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::math::Float3x4;
+using ozz::math::Float4x4;
+using ozz::math::SimdFloat4;
+
+namespace {
+// Affine matrices used by all tests.
+Float4x4 BuildAffine0() {
+  return Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(1.f, -2.f, 3.f, 0.f),
+      ozz::math::simd_float4::Load(.5f, .5f, .5f, .5f),
+      ozz::math::simd_float4::Load(2.f, 1.f, -3.f, 1.f));
+}
+
+Float4x4 BuildAffine1() {
+  return Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(-4.f, 5.f, 6.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .70710677f),
+      ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 1.f));
+}
+}  // namespace
+
+TEST(Float3x4Constant, ozz_simd_math) {
+  const Float3x4 identity = Float3x4::identity();
+  EXPECT_FLOAT4x4_EQ(ToFloat4x4(identity), 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                     0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+}
+
+TEST(Float3x4Conversion, ozz_simd_math) {
+  const Float4x4 m0 = {{ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 0.f),
+                        ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 0.f),
+                        ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 0.f),
+                        ozz::math::simd_float4::Load(12.f, 13.f, 14.f, 1.f)}};
+  const Float3x4 m0_3x4 = Float3x4::FromFloat4x4(m0);
+  EXPECT_SIMDFLOAT_EQ(m0_3x4.rows[0], 0.f, 4.f, 8.f, 12.f);
+  EXPECT_SIMDFLOAT_EQ(m0_3x4.rows[1], 1.f, 5.f, 9.f, 13.f);
+  EXPECT_SIMDFLOAT_EQ(m0_3x4.rows[2], 2.f, 6.f, 10.f, 14.f);
+
+  EXPECT_FLOAT4x4_EQ(ToFloat4x4(m0_3x4), 0.f, 1.f, 2.f, 0.f, 4.f, 5.f, 6.f,
+                     0.f, 8.f, 9.f, 10.f, 0.f, 12.f, 13.f, 14.f, 1.f);
+}
+
+TEST(Float3x4Arithmetic, ozz_simd_math) {
+  const Float4x4 m0 = BuildAffine0();
+  const Float4x4 m1 = BuildAffine1();
+  const Float3x4 m0_3x4 = Float3x4::FromFloat4x4(m0);
+  const Float3x4 m1_3x4 = Float3x4::FromFloat4x4(m1);
+  const SimdFloat4 v = ozz::math::simd_float4::Load(-1.f, 2.f, -3.f, 46.f);
+
+  const SimdFloat4 point = TransformPoint(m0, ozz::math::SetW(v, ozz::math::simd_float4::one()));
+  EXPECT_SIMDFLOAT3_EQ_EST(TransformPoint(m0_3x4, v),
+                           ozz::math::GetX(point), ozz::math::GetY(point),
+                           ozz::math::GetZ(point));
+
+  const SimdFloat4 vector = TransformVector(m0, ozz::math::SetW(v, ozz::math::simd_float4::zero()));
+  EXPECT_SIMDFLOAT3_EQ_EST(TransformVector(m0_3x4, v),
+                           ozz::math::GetX(vector), ozz::math::GetY(vector),
+                           ozz::math::GetZ(vector));
+
+  const Float4x4 mul = m0 * m1;
+  const Float4x4 mul_3x4 = ToFloat4x4(m0_3x4 * m1_3x4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_SIMDFLOAT_EQ_EST(mul_3x4.cols[i], ozz::math::GetX(mul.cols[i]),
+                            ozz::math::GetY(mul.cols[i]),
+                            ozz::math::GetZ(mul.cols[i]),
+                            ozz::math::GetW(mul.cols[i]));
+  }
+
+  const SimdFloat4 two = ozz::math::simd_float4::Load1(2.f);
+  const Float4x4 scaled = ToFloat4x4(ColumnMultiply(m0_3x4, two));
+  const Float4x4 added = ToFloat4x4(m0_3x4 + m0_3x4);
+  const Float4x4 expected = ColumnMultiply(m0, two);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_SIMDFLOAT_EQ_EST(scaled.cols[i], ozz::math::GetX(expected.cols[i]),
+                            ozz::math::GetY(expected.cols[i]),
+                            ozz::math::GetZ(expected.cols[i]), 0.f);
+    EXPECT_SIMDFLOAT_EQ_EST(added.cols[i], ozz::math::GetX(expected.cols[i]),
+                            ozz::math::GetY(expected.cols[i]),
+                            ozz::math::GetZ(expected.cols[i]), 0.f);
+  }
+  EXPECT_SIMDFLOAT_EQ_EST(scaled.cols[3], ozz::math::GetX(expected.cols[3]),
+                          ozz::math::GetY(expected.cols[3]),
+                          ozz::math::GetZ(expected.cols[3]), 1.f);
+}
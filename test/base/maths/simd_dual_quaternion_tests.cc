@@ -0,0 +1,98 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/base/maths/simd_dual_quaternion.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::math::Float4x4;
+using ozz::math::SimdDualQuaternion;
+using ozz::math::SimdFloat4;
+using ozz::math::SimdQuaternion;
+
+namespace {
+// Rigid transformations used by all tests.
+const SimdQuaternion kRotation0 = {
+    ozz::math::simd_float4::Load(.5f, .5f, .5f, .5f)};
+const SimdQuaternion kRotation1 = {
+    ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .70710677f)};
+
+Float4x4 BuildRigid(const SimdQuaternion& _rotation, SimdFloat4 _translation) {
+  return Float4x4::FromAffine(_translation, _rotation.xyzw,
+                              ozz::math::simd_float4::one());
+}
+}  // namespace
+
+TEST(DualQuaternionConstant, ozz_simd_math) {
+  const SimdDualQuaternion identity = SimdDualQuaternion::identity();
+  EXPECT_SIMDFLOAT_EQ(identity.real.xyzw, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(identity.dual.xyzw, 0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(DualQuaternionTransform, ozz_simd_math) {
+  const SimdFloat4 t0 = ozz::math::simd_float4::Load(1.f, -2.f, 3.f, 46.f);
+  const SimdDualQuaternion dq =
+      SimdDualQuaternion::FromRotationTranslation(kRotation0, t0);
+  EXPECT_SIMDFLOAT_EQ(dq.real.xyzw, .5f, .5f, .5f, .5f);
+  EXPECT_SIMDFLOAT3_EQ(GetTranslation(dq), 1.f, -2.f, 3.f);
+
+  const Float4x4 m = BuildRigid(kRotation0, t0);
+  const SimdFloat4 p = ozz::math::simd_float4::Load(4.f, 5.f, -6.f, 1.f);
+  const SimdFloat4 mp = TransformPoint(m, p);
+  EXPECT_SIMDFLOAT3_EQ(TransformPoint(dq, p), ozz::math::GetX(mp),
+                       ozz::math::GetY(mp), ozz::math::GetZ(mp));
+  const SimdFloat4 mv = TransformVector(m, p);
+  EXPECT_SIMDFLOAT3_EQ(TransformVector(dq, p), ozz::math::GetX(mv),
+                       ozz::math::GetY(mv), ozz::math::GetZ(mv));
+}
+
+TEST(DualQuaternionArithmetic, ozz_simd_math) {
+  const SimdFloat4 t0 = ozz::math::simd_float4::Load(1.f, -2.f, 3.f, 0.f);
+  const SimdFloat4 t1 = ozz::math::simd_float4::Load(-4.f, 5.f, 6.f, 0.f);
+  const SimdDualQuaternion dq0 =
+      SimdDualQuaternion::FromRotationTranslation(kRotation0, t0);
+  const SimdDualQuaternion dq1 =
+      SimdDualQuaternion::FromRotationTranslation(kRotation1, t1);
+
+  // Concatenation matches matrices multiplication.
+  const SimdDualQuaternion mul = dq0 * dq1;
+  const Float4x4 m = BuildRigid(kRotation0, t0) * BuildRigid(kRotation1, t1);
+  const SimdFloat4 p = ozz::math::simd_float4::Load(4.f, 5.f, -6.f, 1.f);
+  const SimdFloat4 mp = TransformPoint(m, p);
+  EXPECT_SIMDFLOAT3_EQ(TransformPoint(mul, p), ozz::math::GetX(mp),
+                       ozz::math::GetY(mp), ozz::math::GetZ(mp));
+  EXPECT_SIMDFLOAT3_EQ(GetTranslation(mul), ozz::math::GetX(m.cols[3]),
+                       ozz::math::GetY(m.cols[3]), ozz::math::GetZ(m.cols[3]));
+
+  // Blending the same dual quaternion leaves it unchanged once normalized.
+  const SimdDualQuaternion blend =
+      Normalize(dq0 * ozz::math::simd_float4::Load1(.25f) +
+                dq0 * ozz::math::simd_float4::Load1(.5f));
+  EXPECT_SIMDFLOAT_EQ(blend.real.xyzw, .5f, .5f, .5f, .5f);
+  EXPECT_SIMDFLOAT3_EQ(GetTranslation(blend), 1.f, -2.f, 3.f);
+}
@@ -0,0 +1,437 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_dual_quaternion.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::geometry::DualQuaternionSkinningJob;
+
+TEST(JobValidity, DualQuaternionSkinningJob) {
+  ozz::math::SimdDualQuaternion dqs[2];
+  ozz::math::Float4x4 scales[2];
+  uint16_t joint_indices[8];
+  float joint_weights[6];
+  float in_positions[6];
+  float in_normals[6];
+  float in_tangents[6];
+  float out_positions[6];
+  float out_normals[6];
+  float out_tangents[6];
+
+  {  // Default is invalid.
+    DualQuaternionSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job with 0 vertex.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 0;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid job with 0 influence.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 0;
+    job.influences_count = 0;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 1};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid job without dual quaternions.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job with scale matrices.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_scale_matrices = scales;
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Invalid job with not enough scale matrices.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_scale_matrices = {scales, 1};
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid job with not enough indices.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 2;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 3};
+    job.joint_indices_stride = sizeof(uint16_t) * 2;
+    job.joint_weights = joint_weights;
+    job.joint_weights_stride = sizeof(float) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid job with not enough weights.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 3;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 6};
+    job.joint_indices_stride = sizeof(uint16_t) * 3;
+    job.joint_weights = {joint_weights, 3};
+    job.joint_weights_stride = sizeof(float) * 2;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid job with not enough output positions.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = {out_positions, 5};
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid job with tangents but no normals.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_tangents = in_tangents;
+    job.in_tangents_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    job.out_tangents = out_tangents;
+    job.out_tangents_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid job with normals but no output normals.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job with positions, normals and tangents.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = {joint_indices, 2};
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.in_tangents = in_tangents;
+    job.in_tangents_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    job.out_tangents = out_tangents;
+    job.out_tangents_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+namespace {
+// Rotation of 90 degrees around z axis, and translation.
+ozz::math::SimdDualQuaternion TestDualQuaternion() {
+  const ozz::math::SimdQuaternion rotation =
+      ozz::math::SimdQuaternion::FromAxisAngle(
+          ozz::math::simd_float4::z_axis(),
+          ozz::math::simd_float4::Load1(ozz::math::kPi_2));
+  return ozz::math::SimdDualQuaternion::FromRotationTranslation(
+      rotation, ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f));
+}
+}  // namespace
+
+TEST(Rigid, DualQuaternionSkinningJob) {
+  // Every joint has the same transformation, so whatever the weights, output
+  // must be the rigid transformation of the input.
+  const ozz::math::SimdDualQuaternion dq = TestDualQuaternion();
+  const ozz::math::SimdDualQuaternion dqs[4] = {dq, dq, dq, dq};
+
+  // Vertices are interleaved, with 6 influences at most.
+  struct Vertex {
+    float position[3];
+    float normal[3];
+    float tangent[3];
+    uint16_t indices[6];
+    float weights[5];
+  };
+  const int kVertices = 3;
+  Vertex in[kVertices];
+  Vertex out[kVertices];
+  for (int i = 0; i < kVertices; ++i) {
+    Vertex& v = in[i];
+    v.position[0] = 1.f + i;
+    v.position[1] = 0.f;
+    v.position[2] = -1.f;
+    v.normal[0] = 0.f;
+    v.normal[1] = 1.f;
+    v.normal[2] = 0.f;
+    v.tangent[0] = 1.f;
+    v.tangent[1] = 0.f;
+    v.tangent[2] = 0.f;
+    for (int j = 0; j < 6; ++j) {
+      v.indices[j] = static_cast<uint16_t>((i + j) % 4);
+    }
+    for (int j = 0; j < 5; ++j) {
+      v.weights[j] = .1f + .05f * j;
+    }
+  }
+
+  for (int inf = 1; inf <= 6; ++inf) {
+    for (int vectors = 0; vectors <= 2; ++vectors) {
+      memset(out, 0, sizeof(out));
+
+      DualQuaternionSkinningJob job;
+      job.vertex_count = kVertices;
+      job.influences_count = inf;
+      job.joint_dual_quaternions = dqs;
+
+      // Buffers are sized to the exact number of bytes read or written.
+      const size_t tail = sizeof(Vertex) * (kVertices - 1);
+      job.joint_indices = {in[0].indices,
+                           (tail + sizeof(uint16_t) * inf) / sizeof(uint16_t)};
+      job.joint_indices_stride = sizeof(Vertex);
+      job.joint_weights = {in[0].weights,
+                           (tail + sizeof(float) * (inf - 1)) / sizeof(float)};
+      job.joint_weights_stride = sizeof(Vertex);
+      job.in_positions = {in[0].position, tail / sizeof(float) + 3};
+      job.in_positions_stride = sizeof(Vertex);
+      job.out_positions = {out[0].position, tail / sizeof(float) + 3};
+      job.out_positions_stride = sizeof(Vertex);
+      if (vectors > 0) {
+        job.in_normals = {in[0].normal, tail / sizeof(float) + 3};
+        job.in_normals_stride = sizeof(Vertex);
+        job.out_normals = {out[0].normal, tail / sizeof(float) + 3};
+        job.out_normals_stride = sizeof(Vertex);
+      }
+      if (vectors > 1) {
+        job.in_tangents = {in[0].tangent, tail / sizeof(float) + 3};
+        job.in_tangents_stride = sizeof(Vertex);
+        job.out_tangents = {out[0].tangent, tail / sizeof(float) + 3};
+        job.out_tangents_stride = sizeof(Vertex);
+      }
+      ASSERT_TRUE(job.Run());
+
+      for (int i = 0; i < kVertices; ++i) {
+        // Rotated by 90 degrees around z, and translated.
+        EXPECT_NEAR(out[i].position[0], 1.f, 1e-5f);
+        EXPECT_NEAR(out[i].position[1], 3.f + i, 1e-5f);
+        EXPECT_NEAR(out[i].position[2], 2.f, 1e-5f);
+        if (vectors > 0) {
+          EXPECT_NEAR(out[i].normal[0], -1.f, 1e-5f);
+          EXPECT_NEAR(out[i].normal[1], 0.f, 1e-5f);
+          EXPECT_NEAR(out[i].normal[2], 0.f, 1e-5f);
+        } else {
+          EXPECT_EQ(out[i].normal[0], 0.f);
+        }
+        if (vectors > 1) {
+          EXPECT_NEAR(out[i].tangent[0], 0.f, 1e-5f);
+          EXPECT_NEAR(out[i].tangent[1], 1.f, 1e-5f);
+          EXPECT_NEAR(out[i].tangent[2], 0.f, 1e-5f);
+        } else {
+          EXPECT_EQ(out[i].tangent[1], 0.f);
+        }
+      }
+    }
+  }
+}
+
+TEST(Blend, DualQuaternionSkinningJob) {
+  // Joints are rotated by +/-45 degrees around z axis.
+  const ozz::math::SimdQuaternion rotations[2] = {
+      ozz::math::SimdQuaternion::FromAxisAngle(
+          ozz::math::simd_float4::z_axis(),
+          ozz::math::simd_float4::Load1(ozz::math::kPi_4)),
+      ozz::math::SimdQuaternion::FromAxisAngle(
+          ozz::math::simd_float4::z_axis(),
+          ozz::math::simd_float4::Load1(-ozz::math::kPi_4))};
+  ozz::math::SimdDualQuaternion dqs[3] = {
+      ozz::math::SimdDualQuaternion::FromRotationTranslation(
+          rotations[0], ozz::math::simd_float4::zero()),
+      ozz::math::SimdDualQuaternion::FromRotationTranslation(
+          rotations[1], ozz::math::simd_float4::zero()),
+      ozz::math::SimdDualQuaternion()};
+  // Third joint is the antipodal representation of the second one.
+  dqs[2].real.xyzw = -dqs[1].real.xyzw;
+  dqs[2].dual.xyzw = -dqs[1].dual.xyzw;
+
+  const uint16_t joint_indices[4] = {0, 1, 0, 2};
+  const float joint_weights[2] = {.5f, .5f};
+  const float in_positions[6] = {2.f, 0.f, 0.f, 2.f, 0.f, 0.f};
+  const float in_normals[6] = {1.f, 0.f, 0.f, 1.f, 0.f, 0.f};
+  float out_positions[6] = {0.f};
+  float out_normals[6] = {0.f};
+
+  DualQuaternionSkinningJob job;
+  job.vertex_count = 2;
+  job.influences_count = 2;
+  job.joint_dual_quaternions = dqs;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  // Blended rotation is identity. Unlike linear blending, which would collapse
+  // the vertex to 2 * cos(45), the vertex distance to the joint is preserved.
+  // This must also be true when the second joint is in the opposite
+  // hemisphere.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_NEAR(out_positions[i * 3 + 0], 2.f, 1e-5f);
+    EXPECT_NEAR(out_positions[i * 3 + 1], 0.f, 1e-5f);
+    EXPECT_NEAR(out_positions[i * 3 + 2], 0.f, 1e-5f);
+    EXPECT_NEAR(out_normals[i * 3 + 0], 1.f, 1e-5f);
+    EXPECT_NEAR(out_normals[i * 3 + 1], 0.f, 1e-5f);
+    EXPECT_NEAR(out_normals[i * 3 + 2], 0.f, 1e-5f);
+  }
+}
+
+TEST(Scale, DualQuaternionSkinningJob) {
+  const ozz::math::SimdDualQuaternion dqs[2] = {TestDualQuaternion(),
+                                                TestDualQuaternion()};
+  const ozz::math::Float4x4 scales[2] = {
+      ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 1.f)),
+      ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(4.f, 4.f, 4.f, 1.f))};
+
+  const uint16_t joint_indices[3] = {0, 0, 1};
+  const float joint_weights[2] = {.75f, .5f};
+  const float in_positions[3] = {1.f, 0.f, -1.f};
+  const float in_normals[3] = {0.f, 1.f, 0.f};
+  float out_positions[3] = {0.f};
+  float out_normals[3] = {0.f};
+
+  DualQuaternionSkinningJob job;
+  job.vertex_count = 1;
+  job.influences_count = 3;
+  job.joint_dual_quaternions = dqs;
+  job.joint_scale_matrices = scales;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 3;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float) * 2;
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  // Blended scale is (.75 + .5) * 2 + (1 - .75 - .5) * 4 = 1.5, applied before
+  // the rotation by 90 degrees around z and translation.
+  EXPECT_NEAR(out_positions[0], 1.f, 1e-5f);
+  EXPECT_NEAR(out_positions[1], 3.5f, 1e-5f);
+  EXPECT_NEAR(out_positions[2], 1.5f, 1e-5f);
+  EXPECT_NEAR(out_normals[0], -1.5f, 1e-5f);
+  EXPECT_NEAR(out_normals[1], 0.f, 1e-5f);
+  EXPECT_NEAR(out_normals[2], 0.f, 1e-5f);
+}
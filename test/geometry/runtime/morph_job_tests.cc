@@ -0,0 +1,383 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::MorphJob;
+
+TEST(JobValidity, MorphJob) {
+  float in_positions[9] = {0.f};
+  float in_normals[9] = {0.f};
+  float out_positions[9];
+  float out_normals[9];
+  const uint16_t indices[2] = {0, 2};
+  const int16_t position_deltas[6] = {0};
+  const int8_t normal_deltas[6] = {0};
+
+  MorphJob valid;
+  valid.vertex_count = 3;
+  valid.in_positions = in_positions;
+  valid.in_positions_stride = sizeof(float) * 3;
+  valid.out_positions = out_positions;
+  valid.out_positions_stride = sizeof(float) * 3;
+
+  {  // Default is invalid.
+    MorphJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid without target.
+    MorphJob job = valid;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Valid without vertex.
+    MorphJob job = valid;
+    job.vertex_count = 0;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid negative vertex count.
+    MorphJob job = valid;
+    job.vertex_count = -1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid negative min weight.
+    MorphJob job = valid;
+    job.min_weight = -1.f;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid input positions.
+    MorphJob job = valid;
+    job.in_positions = {in_positions, 8};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid output positions.
+    MorphJob job = valid;
+    job.out_positions = {};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid normals without output.
+    MorphJob job = valid;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid normals.
+    MorphJob job = valid;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Valid target.
+    MorphJob::Target target;
+    target.indices = indices;
+    target.position_deltas = position_deltas;
+    MorphJob job = valid;
+    job.targets = {&target, 1};
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid target index.
+    MorphJob::Target target;
+    target.indices = indices;
+    target.position_deltas = position_deltas;
+    MorphJob job = valid;
+    job.vertex_count = 2;
+    job.targets = {&target, 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid unsorted target indices.
+    const uint16_t unsorted[2] = {2, 1};
+    MorphJob::Target target;
+    target.indices = unsorted;
+    target.position_deltas = position_deltas;
+    MorphJob job = valid;
+    job.targets = {&target, 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid out of range target index, while the last index is in range.
+    const uint16_t unsorted[2] = {5, 1};
+    MorphJob::Target target;
+    target.indices = unsorted;
+    target.position_deltas = position_deltas;
+    MorphJob job = valid;
+    job.targets = {&target, 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid in place positions.
+    MorphJob job = valid;
+    job.out_positions = in_positions;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid in place positions with different strides.
+    MorphJob job = valid;
+    job.vertex_count = 2;
+    job.out_positions = in_positions;
+    job.out_positions_stride = sizeof(float) * 6;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid in place normals with different strides.
+    MorphJob job = valid;
+    job.vertex_count = 2;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_normals = in_normals;
+    job.out_normals_stride = sizeof(float) * 6;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid target position deltas.
+    MorphJob::Target target;
+    target.indices = indices;
+    target.position_deltas = {position_deltas, 5};
+    MorphJob job = valid;
+    job.targets = {&target, 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid target normal deltas.
+    MorphJob::Target target;
+    target.indices = indices;
+    target.position_deltas = position_deltas;
+    target.normal_deltas = {normal_deltas, 5};
+    MorphJob job = valid;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    job.targets = {&target, 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Target normal deltas are ignored without job normals.
+    MorphJob::Target target;
+    target.indices = indices;
+    target.position_deltas = position_deltas;
+    target.normal_deltas = {normal_deltas, 5};
+    MorphJob job = valid;
+    job.targets = {&target, 1};
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+namespace {
+// Interleaved vertex, used to test strided buffers.
+struct MorphVertex {
+  float position[3];
+  float normal[3];
+  float uv[2];
+};
+}  // namespace
+
+TEST(JobResult, MorphJob) {
+  const int kVertexCount = 5;
+  MorphVertex in[kVertexCount];
+  for (int i = 0; i < kVertexCount; ++i) {
+    const float f = static_cast<float>(i);
+    const MorphVertex v = {{f, 1.f, -f}, {0.f, 1.f, 0.f}, {0.f, 0.f}};
+    in[i] = v;
+  }
+
+  // First target moves vertices 1 and 3, second one vertices 0, 3 and 4.
+  const uint16_t indices0[2] = {1, 3};
+  const int16_t position_deltas0[6] = {100, 0, -200, 0, 300, 0};
+  const int8_t normal_deltas0[6] = {10, -10, 0, 0, 0, 20};
+  const uint16_t indices1[3] = {0, 3, 4};
+  const int16_t position_deltas1[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+  MorphJob::Target targets[3];
+  targets[0].indices = indices0;
+  targets[0].position_deltas = position_deltas0;
+  targets[0].position_scale = .01f;
+  targets[0].normal_deltas = normal_deltas0;
+  targets[0].normal_scale = .1f;
+  targets[1].indices = indices1;
+  targets[1].position_deltas = position_deltas1;
+  targets[1].position_scale = 1.f;
+  // Third target has no deltas.
+
+  MorphVertex out[kVertexCount] = {};
+  MorphJob job;
+  job.vertex_count = kVertexCount;
+  job.targets = targets;
+  job.in_positions = {in[0].position, kVertexCount * 8 - 5};
+  job.in_positions_stride = sizeof(MorphVertex);
+  job.in_normals = {in[0].normal, kVertexCount * 8 - 5};
+  job.in_normals_stride = sizeof(MorphVertex);
+  job.out_positions = {out[0].position, kVertexCount * 8 - 5};
+  job.out_positions_stride = sizeof(MorphVertex);
+  job.out_normals = {out[0].normal, kVertexCount * 8 - 5};
+  job.out_normals_stride = sizeof(MorphVertex);
+
+  {  // Zero weights, vertices are copied.
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < kVertexCount; ++i) {
+      EXPECT_FLOAT_EQ(out[i].position[0], static_cast<float>(i));
+      EXPECT_FLOAT_EQ(out[i].position[1], 1.f);
+      EXPECT_FLOAT_EQ(out[i].position[2], -static_cast<float>(i));
+      EXPECT_FLOAT_EQ(out[i].normal[0], 0.f);
+      EXPECT_FLOAT_EQ(out[i].normal[1], 1.f);
+      EXPECT_FLOAT_EQ(out[i].normal[2], 0.f);
+      EXPECT_FLOAT_EQ(out[i].uv[0], 0.f);
+    }
+  }
+
+  {  // Weighted targets.
+    targets[0].weight = .5f;
+    targets[1].weight = -2.f;
+    targets[2].weight = 1.f;
+    ASSERT_TRUE(job.Run());
+
+    EXPECT_FLOAT_EQ(out[0].position[0], 0.f - 2.f);
+    EXPECT_FLOAT_EQ(out[0].position[1], 1.f - 4.f);
+    EXPECT_FLOAT_EQ(out[0].position[2], 0.f - 6.f);
+    EXPECT_FLOAT_EQ(out[0].normal[1], 1.f);
+
+    EXPECT_FLOAT_EQ(out[1].position[0], 1.f + .5f);
+    EXPECT_FLOAT_EQ(out[1].position[1], 1.f);
+    EXPECT_FLOAT_EQ(out[1].position[2], -1.f - 1.f);
+    EXPECT_FLOAT_EQ(out[1].normal[0], .5f);
+    EXPECT_FLOAT_EQ(out[1].normal[1], 1.f - .5f);
+    EXPECT_FLOAT_EQ(out[1].normal[2], 0.f);
+
+    EXPECT_FLOAT_EQ(out[2].position[0], 2.f);
+    EXPECT_FLOAT_EQ(out[2].position[1], 1.f);
+    EXPECT_FLOAT_EQ(out[2].position[2], -2.f);
+
+    EXPECT_FLOAT_EQ(out[3].position[0], 3.f - 8.f);
+    EXPECT_FLOAT_EQ(out[3].position[1], 1.f + 1.5f - 10.f);
+    EXPECT_FLOAT_EQ(out[3].position[2], -3.f - 12.f);
+    EXPECT_FLOAT_EQ(out[3].normal[0], 0.f);
+    EXPECT_FLOAT_EQ(out[3].normal[1], 1.f);
+    EXPECT_FLOAT_EQ(out[3].normal[2], 1.f);
+
+    EXPECT_FLOAT_EQ(out[4].position[0], 4.f - 14.f);
+    EXPECT_FLOAT_EQ(out[4].position[1], 1.f - 16.f);
+    EXPECT_FLOAT_EQ(out[4].position[2], -4.f - 18.f);
+    EXPECT_FLOAT_EQ(out[4].uv[0], 0.f);
+  }
+
+  {  // Targets under min weight are skipped.
+    job.min_weight = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT_EQ(out[1].position[0], 1.f);
+    EXPECT_FLOAT_EQ(out[1].normal[0], 0.f);
+    EXPECT_FLOAT_EQ(out[3].position[1], 1.f - 10.f);
+    EXPECT_FLOAT_EQ(out[4].position[0], 4.f - 14.f);
+  }
+}
+
+TEST(InPlace, MorphJob) {
+  float positions[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  const uint16_t indices[1] = {1};
+  const int16_t position_deltas[3] = {10, 20, 30};
+
+  MorphJob::Target target;
+  target.weight = .1f;
+  target.indices = indices;
+  target.position_deltas = position_deltas;
+
+  MorphJob job;
+  job.vertex_count = 2;
+  job.targets = {&target, 1};
+  job.in_positions = positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_FLOAT_EQ(positions[0], 1.f);
+  EXPECT_FLOAT_EQ(positions[1], 2.f);
+  EXPECT_FLOAT_EQ(positions[2], 3.f);
+  EXPECT_FLOAT_EQ(positions[3], 5.f);
+  EXPECT_FLOAT_EQ(positions[4], 7.f);
+  EXPECT_FLOAT_EQ(positions[5], 9.f);
+}
+
+TEST(Skinning, MorphJob) {
+  // Morphed vertices are used as skinning job input.
+  const float in_positions[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  const uint16_t indices[1] = {0};
+  const int16_t position_deltas[3] = {1, 1, 1};
+
+  MorphJob::Target target;
+  target.weight = 1.f;
+  target.indices = indices;
+  target.position_deltas = position_deltas;
+
+  float morphed[6];
+  MorphJob morph;
+  morph.vertex_count = 2;
+  morph.targets = {&target, 1};
+  morph.in_positions = in_positions;
+  morph.in_positions_stride = sizeof(float) * 3;
+  morph.out_positions = morphed;
+  morph.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(morph.Run());
+
+  const ozz::math::Float4x4 matrices[1] = {ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(10.f, 20.f, 30.f, 0.f))};
+  const uint16_t joint_indices[2] = {0, 0};
+  float out_positions[6];
+  ozz::geometry::SkinningJob skinning;
+  skinning.vertex_count = 2;
+  skinning.influences_count = 1;
+  skinning.joint_matrices = matrices;
+  skinning.joint_indices = joint_indices;
+  skinning.joint_indices_stride = sizeof(uint16_t);
+  skinning.in_positions = morphed;
+  skinning.in_positions_stride = morph.out_positions_stride;
+  skinning.out_positions = out_positions;
+  skinning.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(skinning.Run());
+
+  EXPECT_FLOAT_EQ(out_positions[0], 12.f);
+  EXPECT_FLOAT_EQ(out_positions[1], 23.f);
+  EXPECT_FLOAT_EQ(out_positions[2], 34.f);
+  EXPECT_FLOAT_EQ(out_positions[3], 14.f);
+  EXPECT_FLOAT_EQ(out_positions[4], 25.f);
+  EXPECT_FLOAT_EQ(out_positions[5], 36.f);
+}
@@ -0,0 +1,440 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/float3x4.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::geometry::ParallelSkinningJob;
+using ozz::geometry::SkinningJob;
+
+TEST(RangeAlignment, ParallelSkinningJob) {
+  float buffer[12];
+  SkinningJob job;
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 1);
+
+  job.out_positions = buffer;
+  job.out_positions_stride = sizeof(float) * 3;
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 16);
+
+  job.out_positions_stride = sizeof(float) * 12;
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 4);
+
+  job.out_positions_stride = 64;
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 1);
+
+  job.out_normals = buffer;
+  job.out_normals_stride = sizeof(float) * 8;
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 2);
+
+  job.out_tangents = buffer;
+  job.out_tangents_stride = sizeof(float) * 3;
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 16);
+
+  // Half outputs.
+  uint16_t half_buffer[12];
+  job.out_tangents = {};
+  job.out_half_tangents = half_buffer;
+  job.out_tangents_stride = sizeof(uint16_t) * 3;
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 32);
+
+  // Half outputs ranges are offset.
+  job.vertex_count = 4;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals_stride = sizeof(float) * 3;
+  const SkinningJob range = ozz::geometry::GetSkinningJobRange(job, 2, 2);
+  EXPECT_EQ(range.vertex_count, 2);
+  EXPECT_EQ(range.out_positions.begin(), buffer + 6);
+  EXPECT_EQ(range.out_half_tangents.begin(), half_buffer + 6);
+  EXPECT_EQ(range.out_half_tangents.end(), half_buffer + 12);
+}
+
+namespace {
+// Skinning data of a mesh whose vertices have 3 influences.
+struct TestMesh {
+  enum { kInfluences = 3, kJoints = 5 };
+
+  explicit TestMesh(int _vertex_count)
+      : indices(_vertex_count * kInfluences),
+        weights(_vertex_count * (kInfluences - 1)),
+        positions(_vertex_count * 3),
+        normals(_vertex_count * 3),
+        tangents(_vertex_count * 3) {
+    for (int i = 0; i < kJoints; ++i) {
+      const float f = static_cast<float>(i);
+      matrices[i] = ozz::math::Float4x4::FromAffine(
+          ozz::math::simd_float4::Load(f, -f, 2.f * f, 0.f),
+          ozz::math::NormalizeEst4(
+              ozz::math::simd_float4::Load(f, 1.f, -f, 2.f)),
+          ozz::math::simd_float4::Load(1.f + f * .1f, 1.f, 1.f, 0.f));
+    }
+    for (int i = 0; i < _vertex_count; ++i) {
+      for (int j = 0; j < kInfluences; ++j) {
+        indices[i * kInfluences + j] =
+            static_cast<uint16_t>((i + j * 2) % kJoints);
+      }
+      weights[i * 2 + 0] = (i % 7) / 14.f;
+      weights[i * 2 + 1] = (i % 3) / 6.f;
+      for (int j = 0; j < 3; ++j) {
+        positions[i * 3 + j] = (i * (j + 1)) % 113 * .1f - 5.f;
+        normals[i * 3 + j] = (i + j) % 5 * .2f;
+        tangents[i * 3 + j] = (i * j) % 7 * .1f;
+      }
+    }
+  }
+
+  // Fills _job inputs, outputs being written to _out which has 9 floats per
+  // vertex (interleaved position, normal, tangent).
+  SkinningJob Job(float* _out) const {
+    const int vertex_count = static_cast<int>(positions.size() / 3);
+    SkinningJob job;
+    job.vertex_count = vertex_count;
+    job.influences_count = kInfluences;
+    job.joint_matrices = matrices;
+    job.joint_indices = make_span(indices);
+    job.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+    job.joint_weights = make_span(weights);
+    job.joint_weights_stride = sizeof(float) * (kInfluences - 1);
+    job.in_positions = make_span(positions);
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = make_span(normals);
+    job.in_normals_stride = sizeof(float) * 3;
+    job.in_tangents = make_span(tangents);
+    job.in_tangents_stride = sizeof(float) * 3;
+    const size_t size = vertex_count * 9 - 6;
+    job.out_positions = {_out, size};
+    job.out_positions_stride = sizeof(float) * 9;
+    job.out_normals = {_out + 3, size};
+    job.out_normals_stride = sizeof(float) * 9;
+    job.out_tangents = {_out + 6, size};
+    job.out_tangents_stride = sizeof(float) * 9;
+    return job;
+  }
+
+  ozz::math::Float4x4 matrices[kJoints];
+  ozz::vector<uint16_t> indices;
+  ozz::vector<float> weights;
+  ozz::vector<float> positions;
+  ozz::vector<float> normals;
+  ozz::vector<float> tangents;
+};
+
+// Runs tasks sequentially, from last to first, recording the number of calls.
+class ReverseExecutor : public ozz::geometry::SkinningTaskExecutor {
+ public:
+  ReverseExecutor() : calls(0), tasks(0) {}
+  virtual void ParallelFor(int _count, Task _task, void* _context) {
+    ++calls;
+    tasks += _count;
+    for (int i = _count - 1; i >= 0; --i) {
+      _task(_context, i);
+    }
+  }
+  int calls;
+  int tasks;
+};
+}  // namespace
+
+TEST(Partition, ParallelSkinningJob) {
+  const int kVertexCount = 1003;
+  const TestMesh mesh(kVertexCount);
+  ozz::vector<float> out(kVertexCount * 9);
+  const SkinningJob job = mesh.Job(out.data());
+
+  // 9 floats stride requires 16 vertices alignment.
+  EXPECT_EQ(ozz::geometry::GetSkinningRangeAlignment(job), 16);
+
+  SkinningJob ranges[8];
+  EXPECT_EQ(ozz::geometry::PartitionSkinningJob(
+                job, 1, ozz::span<SkinningJob>(ranges, size_t(0))),
+            0);
+
+  {  // Limited by the number of ranges.
+    EXPECT_EQ(ozz::geometry::PartitionSkinningJob(job, 100, ranges), 8);
+    const float* expected = out.data();
+    int vertices = 0;
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_TRUE(ranges[i].Validate());
+      EXPECT_EQ(ranges[i].out_positions.begin(), expected);
+      if (i != 7) {
+        EXPECT_EQ(ranges[i].vertex_count % 16, 0);
+        EXPECT_GE(ranges[i].vertex_count, 100);
+      }
+      expected += ranges[i].vertex_count * 9;
+      vertices += ranges[i].vertex_count;
+    }
+    EXPECT_EQ(vertices, kVertexCount);
+  }
+
+  {  // Limited by the minimum number of vertices.
+    EXPECT_EQ(ozz::geometry::PartitionSkinningJob(job, 300, ranges), 3);
+    EXPECT_GE(ranges[0].vertex_count, 300);
+    EXPECT_GE(ranges[1].vertex_count, 300);
+    EXPECT_EQ(ranges[0].vertex_count + ranges[1].vertex_count +
+                  ranges[2].vertex_count,
+              kVertexCount);
+  }
+
+  {  // Single range.
+    EXPECT_EQ(ozz::geometry::PartitionSkinningJob(job, 2000, ranges), 1);
+    EXPECT_EQ(ranges[0].vertex_count, kVertexCount);
+  }
+
+  {  // Ranges don't use the vertex scratch buffer, as they can run
+     // concurrently.
+    ozz::vector<ozz::math::SimdFloat4> scratch(
+        SkinningJob::kVertexScratchSize);
+    SkinningJob scratch_job = job;
+    scratch_job.vertex_scratch = make_span(scratch);
+    EXPECT_EQ(ozz::geometry::PartitionSkinningJob(scratch_job, 300, ranges),
+              3);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(ranges[i].vertex_scratch.empty());
+    }
+  }
+
+  {  // Empty job.
+    SkinningJob empty = job;
+    empty.vertex_count = 0;
+    EXPECT_EQ(ozz::geometry::PartitionSkinningJob(empty, 1, ranges), 0);
+  }
+}
+
+TEST(JobValidity, ParallelSkinningJob) {
+  const TestMesh mesh(10);
+  float out[90];
+
+  {  // Default is invalid.
+    ParallelSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid.
+    ParallelSkinningJob job;
+    job.job = mesh.Job(out);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid max tasks.
+    ParallelSkinningJob job;
+    job.job = mesh.Job(out);
+    job.max_tasks = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid min task vertices.
+    ParallelSkinningJob job;
+    job.job = mesh.Job(out);
+    job.min_task_vertices = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid skinning job.
+    ParallelSkinningJob job;
+    job.job = mesh.Job(out);
+    job.job.out_positions = {out, 10};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid without vertex.
+    ParallelSkinningJob job;
+    job.job = mesh.Job(out);
+    job.job.vertex_count = 0;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(JobResult, ParallelSkinningJob) {
+  const int kVertexCount = 5001;
+  const TestMesh mesh(kVertexCount);
+
+  ozz::vector<float> reference(kVertexCount * 9, 0.f);
+  ASSERT_TRUE(mesh.Job(reference.data()).Run());
+
+  // Number of tasks is also limited by the minimum number of vertices per
+  // task: 5001 vertices are 313 ranges of 16 vertices, 7 of them per task.
+  const int max_tasks[] = {1, 2, 3, 8, 64};
+  const int expected_tasks[] = {0, 2, 3, 8, 44};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(max_tasks); ++i) {
+    ozz::vector<float> out(kVertexCount * 9, 0.f);
+    ReverseExecutor executor;
+    ParallelSkinningJob job;
+    job.job = mesh.Job(out.data());
+    job.executor = &executor;
+    job.max_tasks = max_tasks[i];
+    job.min_task_vertices = 100;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(executor.calls, max_tasks[i] > 1 ? 1 : 0);
+    EXPECT_EQ(executor.tasks, expected_tasks[i]);
+
+    // Outputs are bitwise identical.
+    EXPECT_EQ(
+        std::memcmp(out.data(), reference.data(), sizeof(float) * out.size()),
+        0);
+  }
+
+  {  // Without executor.
+    ozz::vector<float> out(kVertexCount * 9, 0.f);
+    ParallelSkinningJob job;
+    job.job = mesh.Job(out.data());
+    job.min_task_vertices = 100;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(
+        std::memcmp(out.data(), reference.data(), sizeof(float) * out.size()),
+        0);
+  }
+}
+
+TEST(QuantizedResult, ParallelSkinningJob) {
+  const int kVertexCount = 777;
+  const TestMesh mesh(kVertexCount);
+  ozz::vector<int16_t> positions(kVertexCount * 3);
+  ozz::vector<uint8_t> weights(kVertexCount * 2);
+  for (int i = 0; i < kVertexCount * 3; ++i) {
+    positions[i] = static_cast<int16_t>(i * 37 % 20000 - 10000);
+  }
+  for (int i = 0; i < kVertexCount * 2; ++i) {
+    weights[i] = static_cast<uint8_t>(i * 13 % 127);
+  }
+
+  ozz::vector<float> reference(kVertexCount * 9, 0.f);
+  SkinningJob ref_job = mesh.Job(reference.data());
+  ref_job.in_positions = {};
+  ref_job.in_quantized_positions = make_span(positions);
+  ref_job.in_positions_stride = sizeof(int16_t) * 3;
+  ref_job.positions_scale = ozz::math::Float3(.001f, .002f, .003f);
+  ref_job.joint_weights = {};
+  ref_job.joint_quantized_weights = make_span(weights);
+  ref_job.joint_weights_stride = sizeof(uint8_t) * 2;
+  ASSERT_TRUE(ref_job.Run());
+
+  ozz::vector<float> out(kVertexCount * 9, 0.f);
+  ReverseExecutor executor;
+  ParallelSkinningJob job;
+  job.job = ref_job;
+  job.job.out_positions = {out.data(), ref_job.out_positions.size()};
+  job.job.out_normals = {out.data() + 3, ref_job.out_normals.size()};
+  job.job.out_tangents = {out.data() + 6, ref_job.out_tangents.size()};
+  job.executor = &executor;
+  job.min_task_vertices = 50;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(executor.tasks, 8);
+  EXPECT_EQ(
+      std::memcmp(out.data(), reference.data(), sizeof(float) * out.size()), 0);
+
+  // Vertex scratch buffer is only used by tasks run by the calling thread.
+  ozz::vector<ozz::math::SimdFloat4> scratch(SkinningJob::kVertexScratchSize);
+  job.job.vertex_scratch = make_span(scratch);
+  for (int with_executor = 0; with_executor < 2; ++with_executor) {
+    std::fill(out.begin(), out.end(), 0.f);
+    job.executor = with_executor ? &executor : nullptr;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(out.data(), reference.data(),
+                          sizeof(float) * out.size()),
+              0);
+  }
+}
+
+namespace {
+// Runs tasks sequentially, after having overwritten skeleton matrices. Results
+// are only correct if skinning matrices were computed before dispatching
+// tasks.
+class ClobberingExecutor : public ozz::geometry::SkinningTaskExecutor {
+ public:
+  explicit ClobberingExecutor(ozz::span<ozz::math::Float4x4> _models)
+      : models(_models) {}
+  virtual void ParallelFor(int _count, Task _task, void* _context) {
+    for (ozz::math::Float4x4& model : models) {
+      model = ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(46.f, 46.f, 46.f, 0.f));
+    }
+    for (int i = 0; i < _count; ++i) {
+      _task(_context, i);
+    }
+  }
+  ozz::span<ozz::math::Float4x4> models;
+};
+}  // namespace
+
+TEST(RemappedResult, ParallelSkinningJob) {
+  const int kVertexCount = 777;
+  const TestMesh mesh(kVertexCount);
+
+  // Skeleton model-space matrices, remapped to mesh joints.
+  const int kSkeletonJoints = 7;
+  const uint16_t remaps[TestMesh::kJoints] = {6, 2, 4, 0, 5};
+  ozz::math::Float4x4 inverse_binds[TestMesh::kJoints];
+  for (int i = 0; i < TestMesh::kJoints; ++i) {
+    inverse_binds[i] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(static_cast<float>(i), 1.f, -2.f, 0.f));
+  }
+  ozz::math::Float4x4 skeleton_models[kSkeletonJoints];
+  for (int i = 0; i < kSkeletonJoints; ++i) {
+    skeleton_models[i] = mesh.matrices[i % TestMesh::kJoints];
+  }
+
+  ozz::vector<float> reference(kVertexCount * 9, 0.f);
+  SkinningJob ref_job = mesh.Job(reference.data());
+  ref_job.joint_matrices = skeleton_models;
+  ref_job.joint_remaps = remaps;
+  ref_job.joint_inverse_bind_matrices = inverse_binds;
+  ASSERT_TRUE(ref_job.Run());
+
+  ozz::math::Float4x4 models[kSkeletonJoints];
+  ozz::math::Float3x4 scratch[TestMesh::kJoints];
+  for (int s = 0; s < 2; ++s) {
+    // Skeleton matrices are restored, as executor overwrites them.
+    for (int i = 0; i < kSkeletonJoints; ++i) {
+      models[i] = skeleton_models[i];
+    }
+
+    ozz::vector<float> out(kVertexCount * 9, 0.f);
+    ClobberingExecutor executor(models);
+    ParallelSkinningJob job;
+    job.job = ref_job;
+    job.job.joint_matrices = models;
+    job.job.out_positions = {out.data(), ref_job.out_positions.size()};
+    job.job.out_normals = {out.data() + 3, ref_job.out_normals.size()};
+    job.job.out_tangents = {out.data() + 6, ref_job.out_tangents.size()};
+    if (s == 1) {
+      job.job.remap_scratch = scratch;
+    }
+    job.executor = &executor;
+    job.min_task_vertices = 50;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(out.data(), reference.data(),
+                          sizeof(float) * out.size()),
+              0);
+  }
+}
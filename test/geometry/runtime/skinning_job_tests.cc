@@ -25,9 +25,13 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cmath>
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/log.h"
+#include "ozz/base/maths/float3x4.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/geometry/runtime/skinning_job.h"
@@ -1198,3 +1202,855 @@ TEST(Benchmark, SkinningJob) {
     }
   }
 }
+
+TEST(AffineMatrices, SkinningJob) {
+  const int kVertexCount = 7;
+  const int kMaxInfluences = 6;
+  const int kJointCount = 5;
+
+  // Prepares 4x4 and 3x4 palettes, with non uniform scales.
+  ozz::math::Float4x4 matrices[kJointCount];
+  ozz::math::Float3x4 affine_matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(f, -f, 2.f * f, 0.f),
+        ozz::math::NormalizeEst4(
+            ozz::math::simd_float4::Load(f, 1.f, -f, 2.f)),
+        ozz::math::simd_float4::Load(1.f + f, 1.f, 2.f - f * .1f, 0.f));
+    affine_matrices[i] = ozz::math::Float3x4::FromFloat4x4(matrices[i]);
+  }
+
+  // Prepares vertices.
+  uint16_t joint_indices[kVertexCount * kMaxInfluences];
+  float joint_weights[kVertexCount * kMaxInfluences];
+  float in_positions[kVertexCount * 3];
+  float in_normals[kVertexCount * 3];
+  float in_tangents[kVertexCount * 3];
+  for (int i = 0; i < kVertexCount * kMaxInfluences; ++i) {
+    joint_indices[i] = static_cast<uint16_t>((i * 3) % kJointCount);
+    joint_weights[i] = .1f + (i % 3) * .05f;
+  }
+  for (int i = 0; i < kVertexCount * 3; ++i) {
+    in_positions[i] = i * .5f - 3.f;
+    in_normals[i] = i % 2 ? .6f : -.8f;
+    in_tangents[i] = i % 3 ? .8f : .6f;
+  }
+
+  for (int influences = 1; influences <= kMaxInfluences; ++influences) {
+    for (int variant = 0; variant < 4; ++variant) {
+      float out_positions[2][kVertexCount * 3];
+      float out_normals[2][kVertexCount * 3];
+      float out_tangents[2][kVertexCount * 3];
+      for (int affine = 0; affine < 2; ++affine) {
+        SkinningJob job;
+        job.vertex_count = kVertexCount;
+        job.influences_count = influences;
+        if (affine) {
+          job.joint_affine_matrices = affine_matrices;
+        } else {
+          job.joint_matrices = matrices;
+        }
+        job.joint_indices = joint_indices;
+        job.joint_indices_stride = sizeof(uint16_t) * kMaxInfluences;
+        job.joint_weights = joint_weights;
+        job.joint_weights_stride = sizeof(float) * kMaxInfluences;
+        job.in_positions = in_positions;
+        job.in_positions_stride = sizeof(float) * 3;
+        job.out_positions = out_positions[affine];
+        job.out_positions_stride = sizeof(float) * 3;
+        if (variant > 0) {  // Normals
+          job.in_normals = in_normals;
+          job.in_normals_stride = sizeof(float) * 3;
+          job.out_normals = out_normals[affine];
+          job.out_normals_stride = sizeof(float) * 3;
+        }
+        if (variant > 1) {  // Tangents
+          job.in_tangents = in_tangents;
+          job.in_tangents_stride = sizeof(float) * 3;
+          job.out_tangents = out_tangents[affine];
+          job.out_tangents_stride = sizeof(float) * 3;
+        }
+        if (variant > 2) {  // Inverse transpose
+          job.joint_inverse_transpose_matrices = matrices;
+        }
+        EXPECT_TRUE(job.Run());
+      }
+
+      for (int i = 0; i < kVertexCount * 3; ++i) {
+        EXPECT_NEAR(out_positions[0][i], out_positions[1][i], 1e-4f);
+        if (variant > 0) {
+          EXPECT_NEAR(out_normals[0][i], out_normals[1][i], 1e-4f);
+        }
+        if (variant > 1) {
+          EXPECT_NEAR(out_tangents[0][i], out_tangents[1][i], 1e-4f);
+        }
+      }
+    }
+  }
+
+  {  // Both palettes is invalid.
+    float out_positions[kVertexCount * 3];
+    SkinningJob job;
+    job.vertex_count = kVertexCount;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_affine_matrices = affine_matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * kMaxInfluences;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    job.joint_matrices = {};
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(VertexCount, SkinningJob) {
+  // Vertices can be processed by groups, odd and even vertex counts must
+  // output the same as skinning vertices one by one.
+  const int kMaxVertexCount = 6;
+  const int kInfluences = 3;
+  const int kJointCount = 4;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(f, -f, 2.f * f, 0.f),
+        ozz::math::NormalizeEst4(
+            ozz::math::simd_float4::Load(f, 1.f, -f, 2.f)),
+        ozz::math::simd_float4::Load(1.f + f, 1.f, 2.f - f * .1f, 0.f));
+  }
+
+  uint16_t joint_indices[kMaxVertexCount * kInfluences];
+  float joint_weights[kMaxVertexCount * (kInfluences - 1)];
+  float in_positions[kMaxVertexCount * 3];
+  float in_normals[kMaxVertexCount * 3];
+  for (int i = 0; i < kMaxVertexCount * kInfluences; ++i) {
+    joint_indices[i] = static_cast<uint16_t>((i * 3) % kJointCount);
+  }
+  for (int i = 0; i < kMaxVertexCount * (kInfluences - 1); ++i) {
+    joint_weights[i] = .1f + (i % 3) * .2f;
+  }
+  for (int i = 0; i < kMaxVertexCount * 3; ++i) {
+    in_positions[i] = i * .5f - 3.f;
+    in_normals[i] = i % 2 ? .6f : -.8f;
+  }
+
+  for (int count = 1; count <= kMaxVertexCount; ++count) {
+    // Buffers are sized to the exact number of vertices, so that reading past
+    // the last vertex can be detected by memory checkers.
+    ozz::vector<float> out_positions(count * 3);
+    ozz::vector<float> out_normals(count * 3);
+
+    SkinningJob job;
+    job.vertex_count = count;
+    job.influences_count = kInfluences;
+    job.joint_matrices = matrices;
+    job.joint_indices = {joint_indices, static_cast<size_t>(count) * 3};
+    job.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+    job.joint_weights = {joint_weights, static_cast<size_t>(count) * 2};
+    job.joint_weights_stride = sizeof(float) * (kInfluences - 1);
+    job.in_positions = {in_positions, static_cast<size_t>(count) * 3};
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = {in_normals, static_cast<size_t>(count) * 3};
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_positions = make_span(out_positions);
+    job.out_positions_stride = sizeof(float) * 3;
+    job.out_normals = make_span(out_normals);
+    job.out_normals_stride = sizeof(float) * 3;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < count; ++i) {
+      const uint16_t* indices = joint_indices + i * kInfluences;
+      const float* weights = joint_weights + i * (kInfluences - 1);
+      const float w2 = 1.f - (weights[0] + weights[1]);
+      const ozz::math::Float4x4 blended =
+          ozz::math::ColumnMultiply(matrices[indices[0]],
+                                    ozz::math::simd_float4::Load1(weights[0])) +
+          ozz::math::ColumnMultiply(matrices[indices[1]],
+                                    ozz::math::simd_float4::Load1(weights[1])) +
+          ozz::math::ColumnMultiply(matrices[indices[2]],
+                                    ozz::math::simd_float4::Load1(w2));
+      const ozz::math::SimdFloat4 p = TransformPoint(
+          blended, ozz::math::simd_float4::Load3PtrU(in_positions + i * 3));
+      const ozz::math::SimdFloat4 n = TransformVector(
+          blended, ozz::math::simd_float4::Load3PtrU(in_normals + i * 3));
+      EXPECT_NEAR(out_positions[i * 3 + 0], ozz::math::GetX(p), 1e-4f);
+      EXPECT_NEAR(out_positions[i * 3 + 1], ozz::math::GetY(p), 1e-4f);
+      EXPECT_NEAR(out_positions[i * 3 + 2], ozz::math::GetZ(p), 1e-4f);
+      EXPECT_NEAR(out_normals[i * 3 + 0], ozz::math::GetX(n), 1e-4f);
+      EXPECT_NEAR(out_normals[i * 3 + 1], ozz::math::GetY(n), 1e-4f);
+      EXPECT_NEAR(out_normals[i * 3 + 2], ozz::math::GetZ(n), 1e-4f);
+    }
+  }
+}
+
+TEST(QuantizedValidity, SkinningJob) {
+  ozz::math::Float4x4 matrices[2];
+  uint16_t joint_indices[6];
+  float joint_weights[4];
+  uint8_t joint_quantized_weights[4];
+  float in_positions[6];
+  int16_t in_quantized_positions[6];
+  float in_normals[6];
+  int8_t in_quantized_normals[6];
+  int8_t in_quantized_tangents[6];
+  float out_positions[6];
+  float out_normals[6];
+  float out_tangents[6];
+
+  // Valid job with 2 vertices and quantized positions.
+  SkinningJob valid;
+  valid.vertex_count = 2;
+  valid.influences_count = 2;
+  valid.joint_matrices = matrices;
+  valid.joint_indices = joint_indices;
+  valid.joint_indices_stride = sizeof(uint16_t) * 2;
+  valid.joint_weights = joint_weights;
+  valid.joint_weights_stride = sizeof(float);
+  valid.in_quantized_positions = in_quantized_positions;
+  valid.in_positions_stride = sizeof(int16_t) * 3;
+  valid.out_positions = out_positions;
+  valid.out_positions_stride = sizeof(float) * 3;
+  EXPECT_TRUE(valid.Validate());
+
+  {  // Float and quantized positions can't be used together.
+    SkinningJob job = valid;
+    job.in_positions = in_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Quantized positions buffer too small.
+    SkinningJob job = valid;
+    job.in_quantized_positions = {in_quantized_positions, 5};
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Quantized weights.
+    SkinningJob job = valid;
+    job.joint_weights = {};
+    job.joint_quantized_weights = joint_quantized_weights;
+    job.joint_weights_stride = sizeof(uint8_t);
+    EXPECT_TRUE(job.Validate());
+
+    // Buffer too small.
+    job.joint_weights_stride = sizeof(uint8_t) * 4;
+    EXPECT_FALSE(job.Validate());
+    job.joint_weights_stride = sizeof(uint8_t);
+
+    // Float and quantized weights can't be used together.
+    job.joint_weights = joint_weights;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Too many influences for quantized weights.
+    ozz::vector<uint16_t> indices(SkinningJob::kMaxQuantizedInfluences + 1);
+    ozz::vector<uint8_t> weights(SkinningJob::kMaxQuantizedInfluences);
+    SkinningJob job = valid;
+    job.vertex_count = 1;
+    job.influences_count = SkinningJob::kMaxQuantizedInfluences;
+    job.joint_indices = make_span(indices);
+    job.joint_weights = {};
+    job.joint_quantized_weights = make_span(weights);
+    EXPECT_TRUE(job.Validate());
+    job.influences_count = SkinningJob::kMaxQuantizedInfluences + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Quantized normals and tangents.
+    SkinningJob job = valid;
+    job.in_quantized_normals = in_quantized_normals;
+    job.in_normals_stride = sizeof(int8_t) * 3;
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    // Float and quantized normals can't be used together.
+    job.in_normals = in_normals;
+    EXPECT_FALSE(job.Validate());
+    job.in_normals = {};
+
+    job.in_quantized_tangents = in_quantized_tangents;
+    job.in_tangents_stride = sizeof(int8_t) * 3;
+    EXPECT_FALSE(job.Validate());  // No output tangents.
+    job.out_tangents = out_tangents;
+    job.out_tangents_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    // Snorm8 encoding requires 3 components per vector.
+    job.in_quantized_tangents = {in_quantized_tangents, 5};
+    EXPECT_FALSE(job.Validate());
+
+    // Octahedral encoding requires 2 components per vector.
+    job.quantized_vectors_encoding = SkinningJob::kOctahedral8;
+    job.in_normals_stride = sizeof(int8_t) * 2;
+    job.in_tangents_stride = sizeof(int8_t) * 2;
+    job.in_quantized_normals = {in_quantized_normals, 4};
+    job.in_quantized_tangents = {in_quantized_tangents, 4};
+    EXPECT_TRUE(job.Validate());
+    job.in_quantized_tangents = {in_quantized_tangents, 3};
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Quantized tangents require normals.
+    SkinningJob job = valid;
+    job.in_quantized_tangents = in_quantized_tangents;
+    job.in_tangents_stride = sizeof(int8_t) * 3;
+    job.out_tangents = out_tangents;
+    job.out_tangents_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+namespace {
+int8_t EncodeSnorm8(float _value) {
+  return static_cast<int8_t>(std::floor(_value * 127.f + .5f));
+}
+
+// Encodes unit vector _v using octahedral mapping.
+void EncodeOctahedral8(const ozz::math::Float3& _v, int8_t* _out) {
+  const float l1 = std::abs(_v.x) + std::abs(_v.y) + std::abs(_v.z);
+  float x = _v.x / l1;
+  float y = _v.y / l1;
+  if (_v.z < 0.f) {
+    const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+    y = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+    x = fx;
+  }
+  _out[0] = EncodeSnorm8(x);
+  _out[1] = EncodeSnorm8(y);
+}
+}  // namespace
+
+TEST(Quantized, SkinningJob) {
+  // Enough vertices to be decoded in multiple batches.
+  const int kVertexCount = 300;
+  const int kInfluences = 3;
+  const int kJointCount = 4;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(f, -f, 2.f * f, 0.f),
+        ozz::math::NormalizeEst4(
+            ozz::math::simd_float4::Load(f, 1.f, -f, 2.f)),
+        ozz::math::simd_float4::Load(1.f + f * .1f, 1.f, 1.f - f * .1f, 0.f));
+  }
+
+  // Interleaved quantized vertices.
+  struct QuantizedVertex {
+    int16_t position[3];
+    int8_t normal[3];
+    int8_t tangent[3];
+    uint8_t weights[kInfluences - 1];
+  };
+  QuantizedVertex quantized[kVertexCount];
+
+  // Float vertices, used as a reference.
+  uint16_t joint_indices[kVertexCount * kInfluences];
+  float joint_weights[kVertexCount * (kInfluences - 1)];
+  float positions[kVertexCount * 3];
+  ozz::math::Float3 normals[kVertexCount];
+  ozz::math::Float3 tangents[kVertexCount];
+
+  const ozz::math::Float3 scale(.01f, .02f, .005f);
+  const ozz::math::Float3 offset(-1.f, 2.f, .5f);
+
+  for (int i = 0; i < kVertexCount; ++i) {
+    QuantizedVertex& vertex = quantized[i];
+    for (int j = 0; j < kInfluences; ++j) {
+      joint_indices[i * kInfluences + j] =
+          static_cast<uint16_t>((i + j) % kJointCount);
+    }
+    for (int j = 0; j < kInfluences - 1; ++j) {
+      vertex.weights[j] = static_cast<uint8_t>((i * 7 + j * 50) % 120);
+      joint_weights[i * (kInfluences - 1) + j] = vertex.weights[j] / 255.f;
+    }
+    vertex.position[0] = static_cast<int16_t>(i * 97 - 15000);
+    vertex.position[1] = static_cast<int16_t>(20000 - i * 131);
+    vertex.position[2] = static_cast<int16_t>((i * 1031) % 32767);
+    positions[i * 3 + 0] = vertex.position[0] * scale.x + offset.x;
+    positions[i * 3 + 1] = vertex.position[1] * scale.y + offset.y;
+    positions[i * 3 + 2] = vertex.position[2] * scale.z + offset.z;
+
+    const float a = i * .1f;
+    normals[i] = Normalize(
+        ozz::math::Float3(std::cos(a), std::sin(a * 3.f), std::sin(a) - .5f));
+    tangents[i] = Normalize(
+        ozz::math::Float3(std::sin(a * 2.f), -.3f, std::cos(a * 5.f)));
+  }
+
+  // Reference output.
+  float out_positions[kVertexCount * 3];
+  float out_normals[kVertexCount * 3];
+  float out_tangents[kVertexCount * 3];
+  SkinningJob reference;
+  reference.vertex_count = kVertexCount;
+  reference.influences_count = kInfluences;
+  reference.joint_matrices = matrices;
+  reference.joint_indices = joint_indices;
+  reference.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+  reference.joint_weights = joint_weights;
+  reference.joint_weights_stride = sizeof(float) * (kInfluences - 1);
+  reference.in_positions = positions;
+  reference.in_positions_stride = sizeof(float) * 3;
+  reference.in_normals = {&normals[0].x, &normals[kVertexCount].x};
+  reference.in_normals_stride = sizeof(ozz::math::Float3);
+  reference.in_tangents = {&tangents[0].x, &tangents[kVertexCount].x};
+  reference.in_tangents_stride = sizeof(ozz::math::Float3);
+  reference.out_positions = out_positions;
+  reference.out_positions_stride = sizeof(float) * 3;
+  reference.out_normals = out_normals;
+  reference.out_normals_stride = sizeof(float) * 3;
+  reference.out_tangents = out_tangents;
+  reference.out_tangents_stride = sizeof(float) * 3;
+  ASSERT_TRUE(reference.Run());
+
+  const SkinningJob::VectorEncoding encodings[] = {SkinningJob::kSnorm8,
+                                                   SkinningJob::kOctahedral8};
+  for (size_t e = 0; e < OZZ_ARRAY_SIZE(encodings); ++e) {
+    for (int i = 0; i < kVertexCount; ++i) {
+      QuantizedVertex& vertex = quantized[i];
+      if (encodings[e] == SkinningJob::kSnorm8) {
+        vertex.normal[0] = EncodeSnorm8(normals[i].x);
+        vertex.normal[1] = EncodeSnorm8(normals[i].y);
+        vertex.normal[2] = EncodeSnorm8(normals[i].z);
+        vertex.tangent[0] = EncodeSnorm8(tangents[i].x);
+        vertex.tangent[1] = EncodeSnorm8(tangents[i].y);
+        vertex.tangent[2] = EncodeSnorm8(tangents[i].z);
+      } else {
+        EncodeOctahedral8(normals[i], vertex.normal);
+        EncodeOctahedral8(tangents[i], vertex.tangent);
+      }
+    }
+
+    float out_q_positions[kVertexCount * 3];
+    float out_q_normals[kVertexCount * 3];
+    float out_q_tangents[kVertexCount * 3];
+    SkinningJob job = reference;
+    job.joint_weights = {};
+    job.joint_quantized_weights = {quantized[0].weights,
+                                   quantized[kVertexCount].weights};
+    job.joint_weights_stride = sizeof(QuantizedVertex);
+    job.in_positions = {};
+    job.in_quantized_positions = {quantized[0].position,
+                                  quantized[kVertexCount].position};
+    job.in_positions_stride = sizeof(QuantizedVertex);
+    job.positions_scale = scale;
+    job.positions_offset = offset;
+    job.in_normals = {};
+    job.in_quantized_normals = {quantized[0].normal,
+                                quantized[kVertexCount].normal};
+    job.in_normals_stride = sizeof(QuantizedVertex);
+    job.in_tangents = {};
+    job.in_quantized_tangents = {quantized[0].tangent,
+                                 quantized[kVertexCount].tangent};
+    job.in_tangents_stride = sizeof(QuantizedVertex);
+    job.quantized_vectors_encoding = encodings[e];
+    job.out_positions = out_q_positions;
+    job.out_normals = out_q_normals;
+    job.out_tangents = out_q_tangents;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kVertexCount * 3; ++i) {
+      EXPECT_NEAR(out_q_positions[i], out_positions[i], 1e-3f);
+      EXPECT_NEAR(out_q_normals[i], out_normals[i], 3e-2f);
+      EXPECT_NEAR(out_q_tangents[i], out_tangents[i], 3e-2f);
+    }
+
+    {  // Decoding to a vertex scratch buffer gives the same outputs.
+      ozz::vector<ozz::math::SimdFloat4> scratch(
+          SkinningJob::kVertexScratchSize);
+      float out_s_positions[kVertexCount * 3];
+      float out_s_normals[kVertexCount * 3];
+      float out_s_tangents[kVertexCount * 3];
+      SkinningJob scratch_job = job;
+      scratch_job.vertex_scratch = make_span(scratch);
+      scratch_job.out_positions = out_s_positions;
+      scratch_job.out_normals = out_s_normals;
+      scratch_job.out_tangents = out_s_tangents;
+      ASSERT_TRUE(scratch_job.Run());
+      EXPECT_EQ(std::memcmp(out_s_positions, out_q_positions,
+                            sizeof(out_s_positions)),
+                0);
+      EXPECT_EQ(
+          std::memcmp(out_s_normals, out_q_normals, sizeof(out_s_normals)),
+          0);
+      EXPECT_EQ(
+          std::memcmp(out_s_tangents, out_q_tangents, sizeof(out_s_tangents)),
+          0);
+    }
+
+    // Mixes float and quantized inputs.
+    job.in_quantized_positions = {};
+    job.in_positions = positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_quantized_tangents = {};
+    job.in_tangents = reference.in_tangents;
+    job.in_tangents_stride = reference.in_tangents_stride;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kVertexCount * 3; ++i) {
+      EXPECT_NEAR(out_q_positions[i], out_positions[i], 1e-4f);
+      EXPECT_NEAR(out_q_normals[i], out_normals[i], 3e-2f);
+      EXPECT_NEAR(out_q_tangents[i], out_tangents[i], 1e-5f);
+    }
+  }
+}
+
+TEST(RemapValidity, SkinningJob) {
+  ozz::math::Float4x4 models[4];
+  ozz::math::Float3x4 affine_models[4];
+  ozz::math::Float4x4 inverse_binds[SkinningJob::kMaxStackRemappedJoints + 1];
+  ozz::math::Float3x4 scratch[SkinningJob::kMaxStackRemappedJoints + 1];
+  uint16_t remaps[SkinningJob::kMaxStackRemappedJoints + 1] = {0, 3, 1};
+  uint16_t joint_indices[2] = {0, 2};
+  float in_positions[6];
+  float out_positions[6];
+
+  SkinningJob valid;
+  valid.vertex_count = 2;
+  valid.influences_count = 1;
+  valid.joint_matrices = models;
+  valid.joint_remaps = {remaps, 3};
+  valid.joint_inverse_bind_matrices = {inverse_binds, 3};
+  valid.joint_indices = joint_indices;
+  valid.joint_indices_stride = sizeof(uint16_t);
+  valid.in_positions = in_positions;
+  valid.in_positions_stride = sizeof(float) * 3;
+  valid.out_positions = out_positions;
+  valid.out_positions_stride = sizeof(float) * 3;
+
+  {  // Valid job.
+    SkinningJob job = valid;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Valid job with affine model-space matrices.
+    SkinningJob job = valid;
+    job.joint_matrices = {};
+    job.joint_affine_matrices = affine_models;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Invalid remap index.
+    SkinningJob job = valid;
+    job.joint_matrices = {models, 3};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid remap index with affine model-space matrices.
+    SkinningJob job = valid;
+    job.joint_matrices = {};
+    job.joint_affine_matrices = {affine_models, 3};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Missing inverse bind matrices.
+    SkinningJob job = valid;
+    job.joint_inverse_bind_matrices = {};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Not enough inverse bind matrices.
+    SkinningJob job = valid;
+    job.joint_inverse_bind_matrices = {inverse_binds, 2};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Too many remapped joints for the stack buffer.
+    SkinningJob job = valid;
+    job.joint_remaps = remaps;
+    job.joint_inverse_bind_matrices = inverse_binds;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Scratch buffer for more remapped joints than the stack buffer.
+    SkinningJob job = valid;
+    job.joint_remaps = remaps;
+    job.joint_inverse_bind_matrices = inverse_binds;
+    job.remap_scratch = scratch;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Scratch buffer too small.
+    SkinningJob job = valid;
+    job.remap_scratch = {scratch, 2};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Scratch buffer.
+    SkinningJob job = valid;
+    job.remap_scratch = {scratch, 3};
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Remap, SkinningJob) {
+  const int kJointCount = 9;
+  const int kRemapCount = 4;
+  const int kVertexCount = 7;
+  const int kInfluences = 2;
+
+  // Model-space matrices of the skeleton.
+  ozz::math::Float4x4 models[kJointCount];
+  ozz::math::Float3x4 affine_models[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    models[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(f, 1.f - f, .5f * f, 0.f),
+        ozz::math::NormalizeEst4(
+            ozz::math::simd_float4::Load(1.f, f, 2.f, 3.f)),
+        ozz::math::simd_float4::Load(1.f, 1.f + f * .1f, 1.f, 0.f));
+    affine_models[i] = ozz::math::Float3x4::FromFloat4x4(models[i]);
+  }
+
+  // Mesh remapping and inverse bind-poses.
+  const uint16_t remaps[kRemapCount] = {1, 4, 5, 8};
+  ozz::math::Float4x4 inverse_binds[kRemapCount];
+  ozz::math::Float4x4 skinning_matrices[kRemapCount];
+  for (int i = 0; i < kRemapCount; ++i) {
+    inverse_binds[i] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(-1.f, static_cast<float>(i), 2.f, 0.f));
+    skinning_matrices[i] = models[remaps[i]] * inverse_binds[i];
+  }
+
+  uint16_t joint_indices[kVertexCount * kInfluences];
+  float joint_weights[kVertexCount];
+  float in_positions[kVertexCount * 3];
+  float in_normals[kVertexCount * 3];
+  for (int i = 0; i < kVertexCount; ++i) {
+    joint_indices[i * 2 + 0] = static_cast<uint16_t>(i % kRemapCount);
+    joint_indices[i * 2 + 1] = static_cast<uint16_t>((i + 3) % kRemapCount);
+    joint_weights[i] = i / 10.f;
+    for (int j = 0; j < 3; ++j) {
+      in_positions[i * 3 + j] = static_cast<float>(i - j);
+      in_normals[i * 3 + j] = j == i % 3 ? 1.f : 0.f;
+    }
+  }
+
+  // Reference, using the compact skinning matrices palette.
+  float expected_positions[kVertexCount * 3];
+  float expected_normals[kVertexCount * 3];
+  SkinningJob reference;
+  reference.vertex_count = kVertexCount;
+  reference.influences_count = kInfluences;
+  reference.joint_matrices = skinning_matrices;
+  reference.joint_indices = joint_indices;
+  reference.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+  reference.joint_weights = joint_weights;
+  reference.joint_weights_stride = sizeof(float);
+  reference.in_positions = in_positions;
+  reference.in_positions_stride = sizeof(float) * 3;
+  reference.in_normals = in_normals;
+  reference.in_normals_stride = sizeof(float) * 3;
+  reference.out_positions = expected_positions;
+  reference.out_positions_stride = sizeof(float) * 3;
+  reference.out_normals = expected_normals;
+  reference.out_normals_stride = sizeof(float) * 3;
+  ASSERT_TRUE(reference.Run());
+
+  ozz::math::Float3x4 scratch[kRemapCount];
+  for (int affine = 0; affine < 2; ++affine) {
+    for (int use_scratch = 0; use_scratch < 2; ++use_scratch) {
+      float out_positions[kVertexCount * 3] = {0.f};
+      float out_normals[kVertexCount * 3] = {0.f};
+      SkinningJob job = reference;
+      if (affine) {
+        job.joint_matrices = {};
+        job.joint_affine_matrices = affine_models;
+      } else {
+        job.joint_matrices = models;
+      }
+      job.joint_remaps = remaps;
+      job.joint_inverse_bind_matrices = inverse_binds;
+      if (use_scratch) {
+        job.remap_scratch = scratch;
+      }
+      job.out_positions = out_positions;
+      job.out_normals = out_normals;
+      ASSERT_TRUE(job.Run());
+
+      for (int i = 0; i < kVertexCount * 3; ++i) {
+        EXPECT_NEAR(out_positions[i], expected_positions[i], 1e-4f);
+        EXPECT_NEAR(out_normals[i], expected_normals[i], 1e-5f);
+      }
+    }
+  }
+}
+
+TEST(HalfOutputsValidity, SkinningJob) {
+  ozz::math::Float4x4 matrices[1];
+  uint16_t joint_indices[2] = {0, 0};
+  float in_positions[6];
+  float in_normals[6];
+  float out_positions[6];
+  uint16_t out_half_positions[6];
+  uint16_t out_half_normals[6];
+
+  SkinningJob valid;
+  valid.vertex_count = 2;
+  valid.influences_count = 1;
+  valid.joint_matrices = matrices;
+  valid.joint_indices = joint_indices;
+  valid.joint_indices_stride = sizeof(uint16_t);
+  valid.in_positions = in_positions;
+  valid.in_positions_stride = sizeof(float) * 3;
+  valid.out_half_positions = out_half_positions;
+  valid.out_positions_stride = sizeof(uint16_t) * 3;
+
+  {  // Valid job.
+    SkinningJob job = valid;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Invalid float and half outputs.
+    SkinningJob job = valid;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid half output size.
+    SkinningJob job = valid;
+    job.out_half_positions = {out_half_positions, 5};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid half normals.
+    SkinningJob job = valid;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_half_normals = out_half_normals;
+    job.out_normals_stride = sizeof(uint16_t) * 3;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Invalid missing normals output.
+    SkinningJob job = valid;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Vertex scratch buffer.
+    ozz::vector<ozz::math::SimdFloat4> scratch(SkinningJob::kVertexScratchSize);
+    SkinningJob job = valid;
+    job.vertex_scratch = make_span(scratch);
+    EXPECT_TRUE(job.Validate());
+    job.vertex_scratch = {scratch.data(), scratch.size() - 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+}
+
+TEST(BufferedOutputs, SkinningJob) {
+  // Enough vertices to be written in multiple batches.
+  const int kVertexCount = 601;
+  const int kInfluences = 2;
+  const int kJointCount = 3;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(f, 2.f * f, -f, 0.f),
+        ozz::math::NormalizeEst4(
+            ozz::math::simd_float4::Load(1.f, -f, f, 1.f)),
+        ozz::math::simd_float4::one());
+  }
+
+  ozz::vector<uint16_t> joint_indices(kVertexCount * kInfluences);
+  ozz::vector<float> joint_weights(kVertexCount);
+  ozz::vector<float> in_positions(kVertexCount * 3);
+  ozz::vector<float> in_normals(kVertexCount * 3);
+  ozz::vector<float> in_tangents(kVertexCount * 3);
+  for (int i = 0; i < kVertexCount; ++i) {
+    joint_indices[i * 2 + 0] = static_cast<uint16_t>(i % kJointCount);
+    joint_indices[i * 2 + 1] = static_cast<uint16_t>((i + 1) % kJointCount);
+    joint_weights[i] = (i % 11) / 10.f;
+    for (int j = 0; j < 3; ++j) {
+      in_positions[i * 3 + j] = ((i * (j + 3)) % 97) * .1f - 4.f;
+      in_normals[i * 3 + j] = j == i % 3 ? 1.f : 0.f;
+      in_tangents[i * 3 + j] = j == (i + 1) % 3 ? 1.f : 0.f;
+    }
+  }
+
+  // Reference, using float outputs and regular stores.
+  ozz::vector<float> expected(kVertexCount * 9);
+  SkinningJob reference;
+  reference.vertex_count = kVertexCount;
+  reference.influences_count = kInfluences;
+  reference.joint_matrices = matrices;
+  reference.joint_indices = make_span(joint_indices);
+  reference.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+  reference.joint_weights = make_span(joint_weights);
+  reference.joint_weights_stride = sizeof(float);
+  reference.in_positions = make_span(in_positions);
+  reference.in_positions_stride = sizeof(float) * 3;
+  reference.in_normals = make_span(in_normals);
+  reference.in_normals_stride = sizeof(float) * 3;
+  reference.in_tangents = make_span(in_tangents);
+  reference.in_tangents_stride = sizeof(float) * 3;
+  reference.out_positions = {expected.data(), kVertexCount * 3};
+  reference.out_positions_stride = sizeof(float) * 3;
+  reference.out_normals = {expected.data() + kVertexCount * 3,
+                           kVertexCount * 3};
+  reference.out_normals_stride = sizeof(float) * 3;
+  reference.out_tangents = {expected.data() + kVertexCount * 6,
+                            kVertexCount * 3};
+  reference.out_tangents_stride = sizeof(float) * 3;
+  ASSERT_TRUE(reference.Run());
+
+  // Interleaved vertex, with float positions and half normals and tangents.
+  struct Vertex {
+    float position[3];
+    uint16_t normal[3];
+    uint16_t tangent[3];
+    uint16_t padding[2];
+  };
+
+  ozz::vector<ozz::math::SimdFloat4> scratch(SkinningJob::kVertexScratchSize);
+  for (int variant = 0; variant < 4; ++variant) {
+    // Half outputs are buffered to a vertex scratch buffer or to the stack.
+    const bool half = (variant & 1) != 0;
+    ozz::vector<Vertex> vertices(kVertexCount);
+    ozz::vector<float> out(kVertexCount * 9, 0.f);
+    SkinningJob job = reference;
+    if (variant & 2) {
+      job.vertex_scratch = make_span(scratch);
+    }
+    if (half) {
+      job.out_positions = {vertices[0].position,
+                           kVertexCount * sizeof(Vertex) / sizeof(float)};
+      job.out_positions_stride = sizeof(Vertex);
+      job.out_normals = {};
+      job.out_half_normals = {
+          vertices[0].normal,
+          (kVertexCount - 1) * sizeof(Vertex) / sizeof(uint16_t) + 3};
+      job.out_normals_stride = sizeof(Vertex);
+      job.out_tangents = {};
+      job.out_half_tangents = {
+          vertices[0].tangent,
+          (kVertexCount - 1) * sizeof(Vertex) / sizeof(uint16_t) + 3};
+      job.out_tangents_stride = sizeof(Vertex);
+    } else {
+      job.out_positions = {out.data(), kVertexCount * 3};
+      job.out_normals = {out.data() + kVertexCount * 3, kVertexCount * 3};
+      job.out_tangents = {out.data() + kVertexCount * 6, kVertexCount * 3};
+    }
+    ASSERT_TRUE(job.Run());
+
+    if (half) {
+      for (int i = 0; i < kVertexCount; ++i) {
+        const Vertex& v = vertices[i];
+        for (int j = 0; j < 3; ++j) {
+          EXPECT_EQ(v.position[j], expected[i * 3 + j]);
+          EXPECT_NEAR(ozz::math::HalfToFloat(v.normal[j]),
+                      expected[kVertexCount * 3 + i * 3 + j], 1e-3f);
+          EXPECT_NEAR(ozz::math::HalfToFloat(v.tangent[j]),
+                      expected[kVertexCount * 6 + i * 3 + j], 1e-3f);
+        }
+      }
+    } else {
+      // Float outputs are identical.
+      EXPECT_EQ(std::memcmp(out.data(), expected.data(),
+                            sizeof(float) * out.size()),
+                0);
+    }
+  }
+}